@@ -9,7 +9,7 @@
 // AE:  We need to set this path with a parameter.
 #include "../inrflow/node.h"
 //#include "../node.h"
-#include "routelist.h"
+#include "../inrflow/path_list.h"
 
 #ifdef DEBUG
 #include "../inrflow/globals.h"
@@ -35,7 +35,7 @@ static long ports;		///< The total number of links
 static long *src; ///< The coordinates for the current
 static long *dst; ///< The coordinates for the destination
 
-static route_t *last_route;
+static struct path_t last_route; ///< route built by init_routing and consumed by route
 
 static char* network_token="ficonn";
 static char* routing_token="tor";
@@ -86,6 +86,7 @@ long init_topo_ficonn(long np, long* par)
 
 	src=malloc(param_k*sizeof(long));
 	dst=malloc(param_k*sizeof(long));
+	init_path(&last_route, 2*two_pow[param_k+1]);
 
 	return 1; // return status, not used here.
 }
@@ -95,7 +96,7 @@ long init_topo_ficonn(long np, long* par)
 **/
 void finish_topo_ficonn()
 {
-
+	free_path(&last_route);
 }
 
 /**
@@ -228,20 +229,18 @@ tuple_t connection_ficonn(long node, long port)
 }
 
 /**
-* Simple oblivious Routing (TOR).
+* Simple oblivious Routing (TOR). Appends the ports from src to dst to last_route.
 */
-route_t* TOrouting (long src, long dst)
+void TOrouting (long src, long dst)
 {
 	long lvl;
-	route_t *aux, *aux2, *res;
 	long sc,dc; // cluster (ficonn) the source and destination belong to.
 	long pren, postn; // ids of the nodes connecting the two ficonns
 
 #ifdef DEBUG
 	if(src==dst) {
-		printf("should not be trying to route a packet that is at its destination (curr: %ld, dst: %ld)!\n", current, destination);
-		aux=emptylist(); // empty set
-		return aux; // just in case, let's abort the routing
+		printf("should not be trying to route a packet that is at its destination (curr: %ld, dst: %ld)!\n", src, dst);
+		return; // just in case, let's abort the routing
 	}
 #endif// DEBUG
 
@@ -249,8 +248,11 @@ route_t* TOrouting (long src, long dst)
 		if(src/fic_size[lvl-1]!=dst/fic_size[lvl-1])
 			break;
 
-	if(lvl==0)	// Easy, just traverse the switch;
-		return concat_nn(0, dst%param_n); // port 0 goes to the switch
+	if(lvl==0) {	// Easy, just traverse the switch;
+		path_enqueue(&last_route, 0); // port 0 goes to the switch
+		path_enqueue(&last_route, dst%param_n);
+		return;
+	}
 
 	sc=(src%fic_size[lvl])/fic_size[lvl-1];
 	dc=(dst%fic_size[lvl])/fic_size[lvl-1];
@@ -270,21 +272,11 @@ route_t* TOrouting (long src, long dst)
 	postn = ((dst/fic_size[lvl-1])*fic_size[lvl-1]) // same as above
 	        + (sc*two_pow[lvl])+two_pow[lvl-1]-1;
 
-	aux=newlist(1);
-	res=aux;
-
-	if (pren!=src) {
-		res=concat_ll(TOrouting(src,pren),aux);
-		free(aux);
-		aux=res;
-	}
-	if (postn!=dst) {
-		aux2=TOrouting(postn,dst);
-		res=concat_ll(aux,aux2);
-		free(aux2);
-	}
-
-	return res;
+	if (pren!=src)
+		TOrouting(src,pren);
+	path_enqueue(&last_route, 1);
+	if (postn!=dst)
+		TOrouting(postn,dst);
 }
 
 /**
@@ -302,14 +294,14 @@ long get_n_paths_routing_ficonn(long src, long dst){
 */
 long init_routing_ficonn(long src, long dst)
 {
-	last_route=TOrouting(src,dst);
+	TOrouting(src,dst);
 
 	return 0;
 }
 
 void finish_route_ficonn()
 {
-	if (last_route->first!=NULL) {
+	if (!path_is_null(&last_route)) {
 #ifdef DEBUG
 		if(n_failures==0){
 		printf("ERROR: there are still some hops in the route.\n");
@@ -317,12 +309,8 @@ void finish_route_ficonn()
 	}
 #endif // DEBUG
 
-		while (last_route->first!=NULL){
-			get_next(last_route);
-		}
+		empty_path(&last_route);
 	}
-
-    free(last_route);
 }
 
 /**
@@ -338,7 +326,7 @@ long route_ficonn(long current, long destination)
 		return -1; // just in case, let's abort the routing
 	}
 #endif // DEBUG
-	if ((p=get_next(last_route))!=-1)
+	if ((p=path_dequeue(&last_route))!=-1)
 		return p;
 	else {
 #ifdef DEBUG
@@ -104,7 +104,6 @@ topo=hcnbcn_4_5_3_1_1 routing=hcnbcn-newbdim_1
 * and u,v are given with 'Buv'[node].hcn, .u, and .v, respectively.
 *
 * TODO:
-* - reimplement list_t with an array for speed?
 * - avoid proxying on the most conjested links; rather, proxy on the least congested links.
 *   + new data suggests that we won't solve the problem even if we do so, because the most
 * congested links are not the follower links anyway.
@@ -199,7 +198,7 @@ static const char* hist_docs[4]={
 
 ///< Throughout this file, route list data is the port number, so just a long,
 ///and not a struct
-static list_t route_list; ///< list that proxy_routing will append to on the top level
+static struct path_t route_path; ///< route buffer that proxy_routing will append to on the top level
 static long link[2]; ///<store the output of get_link
 
 static long **hcnlabels; ///< coordinate labels for copies of HCN(a,h)
@@ -249,10 +248,10 @@ static long switch_of(long node);
 
 //routing
 static long comm_suff(long a, long b,long lvl);
-static tuple_t append_to_route(list_t * r_list, long node, long port, long lvl, bool_t dry_run);
-static tuple_t fdimrouting(list_t * r_list, long src, long dst, long lvl, bool_t dry_run);
-static tuple_t newfdimrouting_rec(list_t * r_list, long src, long dst, bool_t dry_run);
-static tuple_t newfdimrouting(list_t * r_list, long src, long dst, bool_t dry_run);
+static tuple_t append_to_route(struct path_t * r_list, long node, long port, long lvl, bool_t dry_run);
+static tuple_t fdimrouting(struct path_t * r_list, long src, long dst, long lvl, bool_t dry_run);
+static tuple_t newfdimrouting_rec(struct path_t * r_list, long src, long dst, bool_t dry_run);
+static tuple_t newfdimrouting(struct path_t * r_list, long src, long dst, bool_t dry_run);
 static tuple_t bdimrouting(long src, long dst, long dry_run);
 static tuple_t newbdimrouting(long src, long dst, long dry_run);
 
@@ -374,7 +373,7 @@ long init_topo_hcnbcn(long np, long* par){
 	RAz=malloc(param_a*sizeof(long));
 	dstb=malloc((param_h+1)*sizeof(long));
 	best_u_array=malloc(scopies*sizeof(long));
-	list_initialize(&route_list,sizeof(long));
+	init_path(&route_path,8*(param_h+2));
 	init_hist_array(&level_links_usage_not_hist,param_h+2);
 	init_hist_array(&bdim_hist,bdim_max_hops);
 	init_hist_array(&nproxy_hist, scopies+1);
@@ -406,6 +405,7 @@ void finish_topo_hcnbcn(){
 	finish_hist_array(&bdim_hist);
 	finish_hist_array(&nproxy_hist);
 	finish_hist_array(&succ_nproxy_hist);
+	free_path(&route_path);
 }
 
 long get_servers_hcnbcn(){
@@ -602,7 +602,7 @@ long get_n_paths_routing_hcnbcn(long src, long dst){
 long init_routing_hcnbcn(long src, long dst){
 	switch (routing) {
 		case HCNBCN_FDIM:
-		fdimrouting(&route_list,src,dst,param_h,FALSE);
+		fdimrouting(&route_path,src,dst,param_h,FALSE);
 		break;
 		case HCNBCN_NEWFDIM:
 			init_ra(RAj,param_a);
@@ -612,7 +612,7 @@ long init_routing_hcnbcn(long src, long dst){
 			init_ra(RAz,param_a);
 			shuffle_array(RAz,param_a);
 
-			newfdimrouting(&route_list,src,dst,FALSE);
+			newfdimrouting(&route_path,src,dst,FALSE);
 		break;
 		case HCNBCN_BDIM:
 		bdimrouting(src,dst,FALSE);
@@ -628,17 +628,13 @@ long init_routing_hcnbcn(long src, long dst){
 }
 
 void finish_route_hcnbcn(){
-	list_destroy(&route_list);
+	empty_path(&route_path);
 }
 
 long route_hcnbcn(long current, long destination){
 	/* if(!is_leader(src) || !is_leader(dst)) return -1; */
-	long *this_port, res;
-	if(!list_empty(&route_list)){
-		list_head(&route_list,(void*)&this_port);
-		res=*this_port;
-		list_rem_head(&route_list);
-		return res;
+	if(!path_is_null(&route_path)){
+		return path_dequeue(&route_path);
 	}else{
 		#ifdef DEBUG
 		if(!are_there_failures()){
@@ -1280,16 +1276,16 @@ static long comm_suff(long a, long b,long lvl){
 *
 * If not a dry run append the next (node) to r_list and update histograms.
 *
-* @param r_list a list_t of longs (or NULL)
+* @param r_list a route buffer (or NULL)
 * @param node current node
 * @param port from 'node' to next node
 * @param dry_run TRUE iff we do not append to r_list
 * @return tuple_t <next node,load (if not dry_run)>
 */
-static tuple_t append_to_route(list_t * r_list, long node, long port, long lvl, bool_t dry_run){
+static tuple_t append_to_route(struct path_t * r_list, long node, long port, long lvl, bool_t dry_run){
 	tuple_t res;
 	if(!dry_run){
-		list_append(r_list,&port);
+		path_enqueue(r_list,port);
 		//count all links
 		update_hist_array(lvl, &level_links_usage_not_hist,param_h+2);
 	}
@@ -1310,7 +1306,7 @@ static tuple_t append_to_route(list_t * r_list, long node, long port, long lvl,
 * @param dry_run TRUE iff this is dry run
 * @return tuple_t <hop-length, flows in bottleneck link>
 */
-static tuple_t fdimrouting(list_t * r_list, long src, long dst, long lvl, bool_t dry_run){
+static tuple_t fdimrouting(struct path_t * r_list, long src, long dst, long lvl, bool_t dry_run){
 	tuple_t l1_route_and_bottleneck,l2_route_and_bottleneck;
 	tuple_t res;
 	long m;
@@ -1387,7 +1383,7 @@ static tuple_t fdimrouting(list_t * r_list, long src, long dst, long lvl, bool_t
 * @param dry_run TRUE iff this is dry run
 * @return tuple_t <hop-length, flows in bottleneck link>
 */
-static tuple_t newfdimrouting_rec(list_t * r_list, long src, long dst, bool_t dry_run){
+static tuple_t newfdimrouting_rec(struct path_t * r_list, long src, long dst, bool_t dry_run){
 	tuple_t res;
 	long m,i;
 	long bottleneck2,bottleneck;
@@ -1484,7 +1480,7 @@ static tuple_t newfdimrouting_rec(list_t * r_list, long src, long dst, bool_t dr
 * @param dry_run TRUE iff this is dry run
 * @return tuple_t <hop-length, flows in bottleneck link>
 */
-static tuple_t newfdimrouting(list_t *r_list, long src, long dst, bool_t dry_run){
+static tuple_t newfdimrouting(struct path_t *r_list, long src, long dst, bool_t dry_run){
 	tuple_t res;
 	tuple_t next_node_and_flows,l;
 	long i,j,src_leader=-1,dst_leader=-1,this_res,best_res=-1,best_src=-1,best_dst=-1;
@@ -1508,7 +1504,7 @@ static tuple_t newfdimrouting(list_t *r_list, long src, long dst, bool_t dry_run
 
 	/* if((src_leader==dst_leader && src_leader>-1) || src_leader==dst || src==dst_leader){ */
 	if(switch_of(src)==switch_of(dst)){
-		return fdimrouting(&route_list,src,dst,param_h,dry_run);
+		return fdimrouting(&route_path,src,dst,param_h,dry_run);
 	}
 
 	if(!is_leader(src)){
@@ -1559,11 +1555,11 @@ static tuple_t newfdimrouting(list_t *r_list, long src, long dst, bool_t dry_run
 	if (!is_leader(src)) {
 		best_res++;
 		if(!dry_run){
-			next_node_and_flows=append_to_route(&route_list,src,0,0,FALSE);
+			next_node_and_flows=append_to_route(&route_path,src,0,0,FALSE);
 			if(next_node_and_flows.port > res.port){//check if this is bottleneck so far
 				res.port=next_node_and_flows.port;
 			}
-			next_node_and_flows=append_to_route(&route_list,
+			next_node_and_flows=append_to_route(&route_path,
                                                 next_node_and_flows.node,
                                                 get_coord(best_src,0),0,FALSE);
 			if(next_node_and_flows.port > res.port){
@@ -1571,7 +1567,7 @@ static tuple_t newfdimrouting(list_t *r_list, long src, long dst, bool_t dry_run
 			}
 		}
 	}
-	l=newfdimrouting_rec(&route_list,best_src,best_dst,dry_run);
+	l=newfdimrouting_rec(&route_path,best_src,best_dst,dry_run);
 	best_res+=l.node;
 	if(!dry_run && l.port > res.port){
 		res.port = l.port;
@@ -1579,11 +1575,11 @@ static tuple_t newfdimrouting(list_t *r_list, long src, long dst, bool_t dry_run
 	if (!is_leader(dst)) {
 		best_res++;
 		if(!dry_run){
-			next_node_and_flows=append_to_route(&route_list,best_dst,0,0,FALSE);
+			next_node_and_flows=append_to_route(&route_path,best_dst,0,0,FALSE);
 			if(next_node_and_flows.port > res.port){//check if this is bottleneck so far
 				res.port=next_node_and_flows.port;
 			}
-			next_node_and_flows=append_to_route(&route_list,
+			next_node_and_flows=append_to_route(&route_path,
                                                 next_node_and_flows.node,
                                                 get_coord(dst,0),0,FALSE);
 			if(next_node_and_flows.port > res.port){
@@ -1619,15 +1615,15 @@ static tuple_t bdimrouting(long src, long dst, long dry_run){
 	long  bottleneck;
 	long test_l1,test_l2,a,b,dst_u,src_u;
 	if ((src_u=get_u_index(src))==(dst_u=get_u_index(dst))) {
-		return fdimrouting(&route_list,src,dst,param_h,dry_run);
+		return fdimrouting(&route_path,src,dst,param_h,dry_run);
 	} else {
 		get_link_bcn(src_u,dst_u,get_v_index(src));
 		a=link[0];
 		b=link[1];
-		l1_route_and_bottleneck=fdimrouting(&route_list,src,a,param_h,dry_run);
+		l1_route_and_bottleneck=fdimrouting(&route_path,src,a,param_h,dry_run);
 		test_l1=l1_route_and_bottleneck.node;
-	  bottleneck=append_to_route(&route_list,a,1,param_h+1,dry_run).port;
-		l2_route_and_bottleneck=fdimrouting(&route_list,b,dst,param_h,dry_run);
+	  bottleneck=append_to_route(&route_path,a,1,param_h+1,dry_run).port;
+		l2_route_and_bottleneck=fdimrouting(&route_path,b,dst,param_h,dry_run);
 		test_l2=l2_route_and_bottleneck.node;
 		#ifdef DEBUG
 		if(get_v_index(src)!=get_v_index(a)) {
@@ -1669,14 +1665,14 @@ static tuple_t newbdimrouting(long src, long dst, long dry_run){
 			init_ra(RAz,param_a);
 			shuffle_array(RAz,param_a);
 	if ((src_u=get_u_index(src))==(dst_u=get_u_index(dst))) {
-		best_l=newfdimrouting(&route_list,src,dst,dry_run).node;
+		best_l=newfdimrouting(&route_path,src,dst,dry_run).node;
 		if(!dry_run){
 			bdim_l=bdimrouting(src, dst, TRUE).node;
 			update_hist_array(bdim_l, &bdim_hist, bdim_max_hops);
 		#ifdef DEBUG
 		if(best_l>bdim_l){
 			printf("newbidimrouting bigger than bdimrouting src %ld dst %ld\n",src,dst );
-			list_destroy(&route_list);
+			empty_path(&route_path);
 			newbdimrouting(src,dst,FALSE).node;
 			exit(-1);
 		}
@@ -1736,9 +1732,9 @@ static tuple_t newbdimrouting(long src, long dst, long dry_run){
 				get_link_bcn(src_u,dst_u,get_v_index(src));
 				a=link[0];
 				b=link[1];
-				best_l=1+newfdimrouting(&route_list,src,a,dry_run).node;
-				append_to_route(&route_list,a,1,param_h+1,dry_run);
-				best_l+=newfdimrouting(&route_list,b,dst,dry_run).node;
+				best_l=1+newfdimrouting(&route_path,src,a,dry_run).node;
+				append_to_route(&route_path,a,1,param_h+1,dry_run);
+				best_l+=newfdimrouting(&route_path,b,dst,dry_run).node;
 			}else{
 				l=2;
 				get_link_bcn(get_u_index(src),best_u,get_v_index(src));
@@ -1747,11 +1743,11 @@ static tuple_t newbdimrouting(long src, long dst, long dry_run){
 				get_link_bcn(best_u,get_u_index(dst),get_v_index(dst));
 				y=link[0];
 				yy=link[1];
-				l+=newfdimrouting(&route_list,src,x,dry_run).node;
-				append_to_route(&route_list,x,1,param_h+1,dry_run);
-				l+=newfdimrouting(&route_list,xx,y,dry_run).node;
-				append_to_route(&route_list,y,1,param_h+1,dry_run);
-				l+=newfdimrouting(&route_list,yy,dst,dry_run).node;
+				l+=newfdimrouting(&route_path,src,x,dry_run).node;
+				append_to_route(&route_path,x,1,param_h+1,dry_run);
+				l+=newfdimrouting(&route_path,xx,y,dry_run).node;
+				append_to_route(&route_path,y,1,param_h+1,dry_run);
+				l+=newfdimrouting(&route_path,yy,dst,dry_run).node;
 #ifdef DEBUG
 				if (l!=best_l) {
 					printf("newBdimrouting wrong size\n");
@@ -1762,7 +1758,7 @@ static tuple_t newbdimrouting(long src, long dst, long dry_run){
 #ifdef DEBUG
 			if(best_l>bdim_l){
 				printf("newbidimrouting bigger than bdimrouting src %ld dst %ld\n",src,dst );
-				list_destroy(&route_list);
+				empty_path(&route_path);
 				newbdimrouting(src,dst,FALSE).node;
 				exit(-1);
 			}
@@ -1804,14 +1800,14 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 			shuffle_array(RAz,param_a);
 
 	if ((src_u=get_u_index(src))==(dst_u=get_u_index(dst))) {
-		res=newfdimrouting(&route_list,src,dst,dry_run);
+		res=newfdimrouting(&route_path,src,dst,dry_run);
 		if(!dry_run){
 			bdim_l=bdimrouting(src, dst, TRUE).node;
 			update_hist_array(bdim_l, &bdim_hist, bdim_max_hops);
 #ifdef DEBUG
 			if(res.node>bdim_l){
 				printf("newbidimrouting bigger than bdimrouting src %ld dst %ld\n",src,dst );
-				list_destroy(&route_list);
+				empty_path(&route_path);
 				newbdimrouting(src,dst,FALSE);
 				exit(-1);
 			}
@@ -1885,9 +1881,9 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 				get_link_bcn(src_u,dst_u,get_v_index(src));
 				a=link[0];
 				b=link[1];
-				l2_route_and_flows=newfdimrouting(&route_list,src,a,FALSE);
-				bottleneck=append_to_route(&route_list,a,1,param_h+1,FALSE).port;
-				l1_route_and_flows=newfdimrouting(&route_list,b,dst,FALSE);
+				l2_route_and_flows=newfdimrouting(&route_path,src,a,FALSE);
+				bottleneck=append_to_route(&route_path,a,1,param_h+1,FALSE).port;
+				l1_route_and_flows=newfdimrouting(&route_path,b,dst,FALSE);
 				l=1+l1_route_and_flows.node+l2_route_and_flows.node;
 				res.port=bottleneck=max(l1_route_and_flows.port,max(l2_route_and_flows.port,bottleneck));
 				//skip to return at end
@@ -1900,9 +1896,9 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 					get_link_bcn(src_u,dst_u,get_v_index(src));
 					a=link[0];
 					b=link[1];
-					l2_route_and_flows=newfdimrouting(&route_list,src,a,FALSE);
-					bottleneck=append_to_route(&route_list,a,1,param_h+1,FALSE).port;
-					l1_route_and_flows=newfdimrouting(&route_list,b,dst,FALSE);
+					l2_route_and_flows=newfdimrouting(&route_path,src,a,FALSE);
+					bottleneck=append_to_route(&route_path,a,1,param_h+1,FALSE).port;
+					l1_route_and_flows=newfdimrouting(&route_path,b,dst,FALSE);
 					//we don't care about the length yet, but this is how we would compute it
 					//best_l=1+l1_route_and_flows.node+l2_route_and_flows.node;
 					dim_bottleneck=max(l1_route_and_flows.port,max(l2_route_and_flows.port,bottleneck));
@@ -1911,7 +1907,7 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 				for (i=((best_l==no_proxy_l)?1:0); i<n_bests; i++) {
 					//We are now building paths to check bottlenecks.  Obviously this could be optimised
 					//by not created the memory, but instead we just destroy the path each time
-					list_destroy(&route_list);
+					empty_path(&route_path);
 					best_u=best_u_array[i];
 					get_link_bcn(get_u_index(src),best_u,get_v_index(src));
 					x=link[0];
@@ -1919,11 +1915,11 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 					get_link_bcn(best_u,get_u_index(dst),get_v_index(dst));
 					y=link[0];
 					yy=link[1];
-					l_route_and_flows=newfdimrouting(&route_list,src,x,FALSE);
-					bottleneck=append_to_route(&route_list,x,1,param_h+1,FALSE).port;
-					l1_route_and_flows=newfdimrouting(&route_list,xx,y,FALSE);
-					bottleneck2=append_to_route(&route_list,y,1,param_h+1,FALSE).port;
-					l2_route_and_flows=newfdimrouting(&route_list,yy,dst,FALSE);
+					l_route_and_flows=newfdimrouting(&route_path,src,x,FALSE);
+					bottleneck=append_to_route(&route_path,x,1,param_h+1,FALSE).port;
+					l1_route_and_flows=newfdimrouting(&route_path,xx,y,FALSE);
+					bottleneck2=append_to_route(&route_path,y,1,param_h+1,FALSE).port;
+					l2_route_and_flows=newfdimrouting(&route_path,yy,dst,FALSE);
 					//not interested in path length (we already know what it is)
 					//l=2+l_route_and_flows.node+l1_route_and_flows.node+l2_route_and_flows.node;
 					bottleneck=max(l_route_and_flows.port,
@@ -1939,7 +1935,7 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 				if (a_con_le_b(best_bottleneck,dim_bottleneck)) {
 					//do proxy, even if they are equal and "connected"
 					//destroy path first
-					list_destroy(&route_list);
+					empty_path(&route_path);
 					best_u=best_b_u;
 					get_link_bcn(get_u_index(src),best_u,get_v_index(src));
 					x=link[0];
@@ -1947,11 +1943,11 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 					get_link_bcn(best_u,get_u_index(dst),get_v_index(dst));
 					y=link[0];
 					yy=link[1];
-					l_route_and_flows=newfdimrouting(&route_list,src,x,FALSE);
-					bottleneck=append_to_route(&route_list,x,1,param_h+1,FALSE).port;
-					l1_route_and_flows=newfdimrouting(&route_list,xx,y,FALSE);
-					bottleneck2=append_to_route(&route_list,y,1,param_h+1,FALSE).port;
-					l2_route_and_flows=newfdimrouting(&route_list,yy,dst,FALSE);
+					l_route_and_flows=newfdimrouting(&route_path,src,x,FALSE);
+					bottleneck=append_to_route(&route_path,x,1,param_h+1,FALSE).port;
+					l1_route_and_flows=newfdimrouting(&route_path,xx,y,FALSE);
+					bottleneck2=append_to_route(&route_path,y,1,param_h+1,FALSE).port;
+					l2_route_and_flows=newfdimrouting(&route_path,yy,dst,FALSE);
 
 					//we already know what the path length and bottleneck are
 #ifdef DEBUG
@@ -1964,13 +1960,13 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 					res.port=best_bottleneck;
 				}else{
 					//do dim
-					list_destroy(&route_list);
+					empty_path(&route_path);
 					get_link_bcn(src_u,dst_u,get_v_index(src));
 					a=link[0];
 					b=link[1];
-					l2_route_and_flows=newfdimrouting(&route_list,src,a,FALSE);
-					bottleneck=append_to_route(&route_list,a,1,param_h+1,FALSE).port;
-					l1_route_and_flows=newfdimrouting(&route_list,b,dst,FALSE);
+					l2_route_and_flows=newfdimrouting(&route_path,src,a,FALSE);
+					bottleneck=append_to_route(&route_path,a,1,param_h+1,FALSE).port;
+					l1_route_and_flows=newfdimrouting(&route_path,b,dst,FALSE);
 					l=1+l1_route_and_flows.node+l2_route_and_flows.node;
 					bottleneck=max(l1_route_and_flows.port,max(l2_route_and_flows.port,bottleneck));
 					//res.node=best_l;//done earlier
@@ -1994,7 +1990,7 @@ static tuple_t newbdimrouting_TAR_DISABLED(long src, long dst, long dry_run){
 #ifdef DEBUG
 		if(res.node>bdim_l){
 			printf("newbidimrouting bigger than bdimrouting src %ld dst %ld\n",src,dst );
-			list_destroy(&route_list);
+			empty_path(&route_path);
 			newbdimrouting(src,dst,FALSE);
 			exit(-1);
 		}
@@ -3,6 +3,8 @@
 #include "scheduling.h"
 #include "literal.h"
 #include "globals.h"
+#include "core_index.h"
+#include "profiler.h"
 #include "../jellyfish/allocation_jellyfish.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -12,58 +14,45 @@ long allocate_application(application *app){
     
     long alloc =0;
 
+    PROF_START(PROF_ALLOCATION);
     alloc = allocate_application_tasks(app);
     if(alloc == 1 && app->size_storage > 0){
         alloc = allocate_application_storage(app);
    }
+    PROF_END(PROF_ALLOCATION);
     return(alloc);
 }
 
 long allocate_application_tasks(application *app){
 
-    long i, j, k;
+    long i, k;
     long allocated =0;
     long *cores = NULL;
-    long *cores_aux = NULL;
-    long local_core;
 
     cores = malloc(sizeof(long) * app->size_tasks);
     switch(app->allocation){
         case SEQUENTIAL_ALLOC:
-            i=0;
-            k = 0;
+            // the first free cores, found with the free-core bitset
             if(sched_info->free_cores >=  app->size_tasks){
-                while(!allocated && i < sched_info->total_servers){
-                    j = 0;
-                    while(!allocated && j < server_cores){
-                        if(sched_info->servers[i].cores[j] == -1){
-                            cores[k++] = (i * server_cores) + j;
-                            if(k == app->size_tasks){
-                                allocated = 1;
-                            }
-                        }
-                        j++;
-                    } 
-                    i++;
-                } 
+                k = -1;
+                for(i = 0; i < app->size_tasks; i++){
+                    k = core_index_next(k + 1);
+                    cores[i] = k;
+                }
+                allocated = 1;
             }
             break;
         case RANDOM_ALLOC:
+            // uniformly random free cores: select the k-th free core and take it so it
+            // is not selected again. They are given back so assign_active_cores takes them.
             if(sched_info->free_cores >=  app->size_tasks){
-                cores_aux = calloc(sched_info->total_cores, sizeof(long));
-                i = 0;
-                j = rand() % sched_info->total_servers;
-                k = rand() % server_cores;
-                while(i < app->size_tasks){
-                    local_core = (j * server_cores) + k;
-                    if(sched_info->servers[j].cores[k] == -1 && cores_aux[local_core] == 0){
-                        cores_aux[local_core] = 1;
-                        cores[i++] = local_core;
-                    }
-                    j = rand() % sched_info->total_servers;
-                    k = rand() % server_cores;
+                for(i = 0; i < app->size_tasks; i++){
+                    cores[i] = core_index_select(rand() % core_index.nfree);
+                    core_index_take(cores[i]);
+                }
+                for(i = 0; i < app->size_tasks; i++){
+                    core_index_release(cores[i]);
                 }
-                free(cores_aux);
                 allocated = 1;
             }
             break;
@@ -192,6 +181,7 @@ void assign_active_cores(application *app, long *cores){
         local_server = cores[i] / server_cores;
         local_core = cores[i] % server_cores;
         sched_info->servers[local_server].cores[local_core] = app->info.id;
+        core_index_take(cores[i]);
         for(j = 0; j < server_cores; j++){
             if(sched_info->servers[local_server].cores[j] == app->info.id){
                 app->num_servers++;
@@ -241,6 +231,7 @@ void assign_inactive_cores(application *app, long *cores_inactive, long n_cores_
             local_server = cores_inactive[i] / server_cores;
             local_core = cores_inactive[i] % server_cores;
             sched_info->servers[local_server].cores[local_core] = app->info.id;
+            core_index_take(cores_inactive[i]);
             sched_info->servers[local_server].free_cores--;
             sched_info->servers[local_server].busy_cores++;
         }
@@ -266,6 +257,7 @@ void release_active_cores(application *app){
         local_server = app->cores_active[i] / server_cores;
         local_core = app->cores_active[i] % server_cores;
         sched_info->servers[local_server].cores[local_core] = -1;
+        core_index_release(app->cores_active[i]);
         sched_info->servers[local_server].free_cores++;
         sched_info->servers[local_server].busy_cores--;
         if(sched_info->servers[local_server].cont == 1){
@@ -289,6 +281,7 @@ void release_inactive_cores(application *app){
             local_server = app->cores_inactive[i] / server_cores;
             local_core = app->cores_inactive[i] % server_cores;
             sched_info->servers[local_server].cores[local_core] = -1;
+            core_index_release(app->cores_inactive[i]);
             sched_info->servers[local_server].free_cores++;
             sched_info->servers[local_server].busy_cores--;
         }
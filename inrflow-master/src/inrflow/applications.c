@@ -17,7 +17,7 @@ char applications_file[200];
 
 void init_running_application(application *next_app){
 
-    long i;
+    long i, n;
     long n_events;
     node_list *node;
 
@@ -45,6 +45,7 @@ void init_running_application(application *next_app){
     list_head_node(&workload, (void*)&node);
     next_app->node = node;
     next_app->info.start_time = sched_info->makespan;
+    next_app->start_makespan = sched_info->makespan;
     next_app->info.size_tasks = next_app->size_tasks;
     metrics.applications.avg_size_tasks += next_app->size_tasks;
     next_app->info.size_storage = next_app->size_storage;
@@ -56,6 +57,14 @@ void init_running_application(application *next_app){
     metrics.scheduling.avg_total_time +=  (next_app->info.start_time -  next_app->info.arrive_time);
     metrics.scheduling.avg_waiting_time +=  (next_app->info.start_time -  next_app->info.arrive_time);
     list_rem_head_append(&workload, &running_applications);
+    if(next_app->info.id >= sched_info->running_apps_size){
+        n = sched_info->running_apps_size;
+        sched_info->running_apps_size = max(2 * n, next_app->info.id + 1);
+        sched_info->running_apps = realloc(sched_info->running_apps, sched_info->running_apps_size * sizeof(long));
+        for(; n < sched_info->running_apps_size; n++){
+            sched_info->running_apps[n] = 0;
+        }
+    }
     sched_info->running_apps[next_app->info.id] = 1;
 
 	if(verbose >= 1){
@@ -72,6 +81,7 @@ void init_running_application(application *next_app){
 void finish_application(application *app){
 
     long i;
+    double wait, run, slowdown;
     if(verbose >= 1){
 		if (app->pattern==FILE_PATTERN){ // if this application is a trace print the trace name
 			printf("Application %ld (from file %s) finishes at makespan %f\n",app->info.id, app->pattern_file, sched_info->makespan);
@@ -83,6 +93,14 @@ void finish_application(application *app){
     }
     sched_info->running_apps[app->info.id] = 0;
     metrics.applications.n_apps++;
+    wait = app->start_makespan - app->info.arrive_time;
+    run = sched_info->makespan - app->start_makespan;
+    slowdown = (run > 0) ? (wait + run) / run : 1.0;
+    metrics.scheduling.sum_slowdown += slowdown;
+    if(wait > metrics.scheduling.max_wait)
+        metrics.scheduling.max_wait = wait;
+    if(slowdown > metrics.scheduling.max_slowdown)
+        metrics.scheduling.max_slowdown = slowdown;
     app->info.end_time = sched_info->makespan;
     app->info.runtime = (app->info.end_time - app->info.start_time);
     metrics.scheduling.avg_total_time += (app->info.end_time - app->info.start_time);
@@ -106,13 +124,14 @@ void finish_application(application *app){
     free(app->task_events_occurred);
     release_mapping(app);
     release_application(app);
+    remove_profile_app(app->info.id);
     list_rem_node(&running_applications, app->node);
     sched_info->stopped = 0;
 }
 
 long is_running(long app_id){
 
-    return(sched_info->running_apps[app_id]);
+    return(app_id < sched_info->running_apps_size && sched_info->running_apps[app_id]);
 }
 
 
@@ -50,6 +50,9 @@ typedef struct application{
     long *cores_inactive;
     long num_servers;
     long finished_storage_flows;
+    double estimate;        ///< runtime estimate from the workload file (0 if unknown), used by backfilling
+    double start_makespan;  ///< makespan when the application started
+    long backfilled;        ///< 1 if the application was started ahead of an older one
     node_list *node;
     list_t **task_events;
     list_t **task_events_occurred;
@@ -70,23 +73,31 @@ typedef enum event_t {
 typedef struct route_t{
     int node;
     short port;
-    struct node_list *n_l;
+    int slot;	///< slot of the flow in the flows of the port.
+    float speed;	///< speed of the flow in this hop, for the parallel bandwidth solver.
 } route_t;
 
+/**
+ * State of a flow in flight: a send that started. Flows live in the flow table of the dynamic
+ * engine (dynamic_engine.h), and the send events refer to them by index. Their speeds and types
+ * are in arrays of their own there (flow_speed and flow_type), read by the bandwidth kernels.
+ */
 typedef struct dflow_t{
     long start_time;
     long injection_time;
     int path_number;
-    float speed;
     int san_link;
     int max_flows;
     int n_max_flows; //remove
     int min_flows;
     int n_min_flows;
-    int type;
     int type_id;
-    int allocated;
-    list_t *path;
+    route_t *path;	///< hops of the route, when electric.
+    int path_length;	///< number of hops of the route.
+    int max_path_length;	///< number of allocated hops in path.
+    struct photonic_path_t *lightpath;	///< hops of the circuit, when photonic.
+    long lightpath_length;	///< number of hops of the circuit.
+    long max_lightpath_length;	///< number of allocated hops in lightpath.
     
 }dflow_t;
 
@@ -95,20 +106,21 @@ typedef struct dflow_t{
  *
  * It contains all the needed atributes for distinguish it:
  * type (S/R/C), the second node id (destination/source), a task id,
- * the length in packets, and the packets sent/arrived.
+ * the length in packets, and the packets sent/arrived. Events are kept small, as whole traces
+ * of them are pending: the state of a send in flight is in its flow.
  */
 typedef struct event {
     event_t type;   ///< Type of the event (Reception / Sent / Computation).
-    int id;
+    int id;                 ///< Tag of the message.
     int pid;               ///< The other node (processor id).
     int pid2;               ///< The other node (processor id).
     long length;    ///< Length of the message in packets. Number of cycles in computation.
     long count;             ///< The number of packets sent/arrived. Number of elapsed cycles when running.
-    struct dflow_t dflow;
     struct application *app;
-    long total_subflows;
-    long subflows_aux;
+    int total_subflows;     ///< Subflows a message is split into.
+    int subflows_aux;       ///< Subflow of a send, or subflows arrived for a reception.
     int type_flow; ///< 0: comms, 1: storage
+    int flow;               ///< Flow of a send in flight in the flow table, -1 until it starts.
 } event;
 
 void init_running_application(application *next_app);
@@ -0,0 +1,162 @@
+/**
+ * @file
+ * @brief Index of the free cores used by the allocation policies.
+ *
+ * All the operations are O(log(cores)) or, when looking for the next free core, proportional
+ * to the number of words skipped, so allocating does not degrade as the machine fills up.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "globals.h"
+#include "core_index.h"
+
+core_index_t core_index;   ///< the free cores of the machine
+
+static void fenwick_add(long core, long delta)
+{
+    long i;
+
+    for (i = core + 1; i <= core_index.ncores; i += i & (-i))
+        core_index.fenwick[i] += delta;
+}
+
+/**
+ * Initialises the index with all the cores free. Servers of switch-centric topologies are
+ * attached to the switch their first port is connected to.
+ */
+void init_core_index(long nservers, long cores_per_server)
+{
+    long i, c, node, neighbour;
+
+    core_index.ncores = nservers * cores_per_server;
+    core_index.cores_per_server = cores_per_server;
+    core_index.nwords = (core_index.ncores + 63) / 64;
+    core_index.nfree = core_index.ncores;
+    core_index.free_bits = malloc(core_index.nwords * sizeof(uint64_t));
+    for (i = 0; i < core_index.nwords; i++)
+        core_index.free_bits[i] = ~(uint64_t)0;
+    if (core_index.ncores % 64 != 0)
+        core_index.free_bits[core_index.nwords - 1] = ((uint64_t)1 << (core_index.ncores % 64)) - 1;
+
+    // every core is free: build the tree in linear time
+    core_index.fenwick = calloc(core_index.ncores + 1, sizeof(long));
+    for (c = 1; c <= core_index.ncores; c++) {
+        core_index.fenwick[c] += 1;
+        if (c + (c & (-c)) <= core_index.ncores)
+            core_index.fenwick[c + (c & (-c))] += core_index.fenwick[c];
+    }
+    core_index.fenwick_top = 1;
+    while (core_index.fenwick_top * 2 <= core_index.ncores)
+        core_index.fenwick_top *= 2;
+
+    core_index.nswitches = get_switches();
+    core_index.switch_free = calloc(core_index.nswitches + 1, sizeof(long));
+    core_index.server_switch = malloc(nservers * sizeof(long));
+    for (i = 0; i < nservers; i++) {
+        core_index.server_switch[i] = -1;
+        node = get_server_i(i);
+        if (network[node].nports > 0) {
+            neighbour = network[node].port[0].neighbour.node;
+            if (neighbour != -1 && !is_server(neighbour)) {
+                core_index.server_switch[i] = node_to_switch(neighbour);
+                core_index.switch_free[core_index.server_switch[i]] += cores_per_server;
+            }
+        }
+    }
+}
+
+void finish_core_index()
+{
+    free(core_index.free_bits);
+    free(core_index.fenwick);
+    free(core_index.switch_free);
+    free(core_index.server_switch);
+}
+
+/**
+ * Marks a free core as busy.
+ */
+void core_index_take(long core)
+{
+    long sw;
+
+    if (!(core_index.free_bits[core >> 6] & ((uint64_t)1 << (core & 63)))) {
+        printf("Taking core %ld, which is not free.\n", core);
+        exit(-1);
+    }
+    core_index.free_bits[core >> 6] &= ~((uint64_t)1 << (core & 63));
+    fenwick_add(core, -1);
+    core_index.nfree--;
+    sw = core_index.server_switch[core / core_index.cores_per_server];
+    if (sw != -1)
+        core_index.switch_free[sw]--;
+}
+
+/**
+ * Marks a busy core as free.
+ */
+void core_index_release(long core)
+{
+    long sw;
+
+    if (core_index.free_bits[core >> 6] & ((uint64_t)1 << (core & 63))) {
+        printf("Releasing core %ld, which is already free.\n", core);
+        exit(-1);
+    }
+    core_index.free_bits[core >> 6] |= (uint64_t)1 << (core & 63);
+    fenwick_add(core, 1);
+    core_index.nfree++;
+    sw = core_index.server_switch[core / core_index.cores_per_server];
+    if (sw != -1)
+        core_index.switch_free[sw]++;
+}
+
+/**
+ * @return the first free core with identifier not smaller than core, -1 if there is none.
+ */
+long core_index_next(long core)
+{
+    long w;
+    uint64_t bits;
+
+    if (core >= core_index.ncores)
+        return -1;
+    w = core >> 6;
+    bits = core_index.free_bits[w] & (~(uint64_t)0 << (core & 63));
+    while (bits == 0) {
+        if (++w == core_index.nwords)
+            return -1;
+        bits = core_index.free_bits[w];
+    }
+    return (w << 6) + __builtin_ctzll(bits);
+}
+
+/**
+ * @return the k-th (starting from 0) free core, -1 if there are not so many free cores.
+ */
+long core_index_select(long k)
+{
+    long pos = 0, step;
+
+    if (k < 0 || k >= core_index.nfree)
+        return -1;
+    k++;
+    for (step = core_index.fenwick_top; step > 0; step >>= 1) {
+        if (pos + step <= core_index.ncores && core_index.fenwick[pos + step] < k) {
+            pos += step;
+            k -= core_index.fenwick[pos];
+        }
+    }
+    return pos; // pos is the 0-based core (1-based pos + 1)
+}
+
+/**
+ * @return the number of free cores in the servers attached to a switch.
+ */
+long core_index_switch_free(long switch_id)
+{
+    if (switch_id < 0 || switch_id >= core_index.nswitches)
+        return 0;
+    return core_index.switch_free[switch_id];
+}
@@ -0,0 +1,43 @@
+/**
+ * @file
+ * @brief Index of the free cores used by the allocation policies.
+ *
+ * Keeps a bitset of free cores (to find the next free core with find-first-set), a Fenwick
+ * tree over the same bits (to select the k-th free core, i.e., uniform random selection) and
+ * the number of free cores attached to every switch.
+ */
+#ifndef _core_index
+#define _core_index
+
+#include <stdint.h>
+
+typedef struct core_index_t {
+    long ncores;        ///< total number of cores
+    long cores_per_server;
+    long nwords;        ///< number of words of the bitset
+    long nfree;         ///< number of free cores
+    long fenwick_top;   ///< highest power of two not larger than ncores
+    uint64_t *free_bits;///< bit c is set if core c is free
+    long *fenwick;      ///< Fenwick tree of free cores, 1-based
+    long nswitches;     ///< number of switches
+    long *switch_free;  ///< free cores in the servers attached to each switch
+    long *server_switch;///< switch each server is attached to (-1 if none)
+} core_index_t;
+
+extern core_index_t core_index;
+
+void init_core_index(long nservers, long cores_per_server);
+
+void finish_core_index();
+
+void core_index_take(long core);
+
+void core_index_release(long core);
+
+long core_index_next(long core);
+
+long core_index_select(long k);
+
+long core_index_switch_free(long switch_id);
+
+#endif
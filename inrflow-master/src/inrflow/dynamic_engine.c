@@ -5,6 +5,7 @@
 #include "list.h"
 #include "metrics.h"
 #include "globals.h"
+#include "profiler.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
@@ -20,7 +21,9 @@ extern long ports;	///< The total number of ports in the topology
 list_t workload;
 list_t list_cpus;
 list_t list_flows;
-long dmetrics_step;
+long dmetrics_step;         ///< Sampling interval of the dynamic metrics being filled, from 1.
+static double dmetrics_bw;  ///< Bandwidth used along the interval, integrated over time.
+static double dmetrics_util;///< Utilization of the links in use along the interval, integrated over time.
 float agg_bw;
 long steps;
 long injected_flows;
@@ -33,6 +36,20 @@ float total_link_bw;
 traffic_priority_t  traffic_priority;
 int traffic_priority_nparams;
 int *traffic_priority_params;
+double coalesce_window;     ///< Events finishing within this time of a step are retired in it.
+
+dflow_t **flow_table;   ///< Chunks of FLOW_CHUNK flows. Flows never move, so the ports keep pointers to them.
+long flow_chunks;       ///< Chunks in the flow table.
+float *flow_speed;      ///< Speeds of the flows, apart from them so the bandwidth kernels can gather them.
+int *flow_type;         ///< Types of the flows, idem.
+long *free_flows;       ///< Stack of the flows not in use.
+long n_free_flows;      ///< Flows in the stack.
+long *active_flows;     ///< Flows in use, in no particular order.
+long n_active_flows;    ///< Flows in use.
+static long *active_slot;   ///< Position of every flow in use in active_flows.
+
+static void add_dynamic_sample(double length);
+static void sample_dynamic_metrics(double start, double t_next);
 
 /**
  * Performs a dynamic run in which flows are placed following the workload description (message causality and cpu periods).
@@ -45,16 +62,18 @@ int *traffic_priority_params;
 void run_dynamic()
 {
     unsigned long long time_next_app;
-//	struct timespec s;
-//	struct timespec e;
-//	long tot;
+    struct timespec s;
+    struct timespec e;
+    double secs;
 
- //   if(clock_gettime(CLOCK_MODE , &s)!=0)
- //     perror("Error Measuring starting time.");
+    if(clock_gettime(CLOCK_MODE , &s)!=0)
+        perror("Error Measuring starting time.");
 
     agg_bw = 0.0;
     steps = 0;
     dmetrics_step = 1;
+    dmetrics_bw = 0.0;
+    dmetrics_util = 0.0;
     injected_flows = 0;
     consumed_flows = 0;
     min_speed = FLT_MAX;
@@ -63,21 +82,74 @@ void run_dynamic()
     init_metrics(&metrics);
     list_initialize(&list_cpus, sizeof(event*));
     list_initialize(&list_flows, sizeof(event*));
+    init_flows();
 
     while(list_length(&workload) > 0 || list_length(&running_applications) > 0){
         time_next_app = schedule_next_application();
         update_events(time_next_app);
     }
+    if(dmetrics_time > 0 && sched_info->makespan > (double)dmetrics_time * (dmetrics_step - 1))
+        add_dynamic_sample(sched_info->makespan - ((double)dmetrics_time * (dmetrics_step - 1)));
+    finish_workload();
+    finish_flows();
     set_makespan(&metrics, sched_info->makespan);
     finish_scheduling(servers);
     update_metrics(&metrics);
     report_metrics(&metrics);
 
- //   if(clock_gettime(CLOCK_MODE , &e)!=0)
- //     perror("Error Measuring end time.");
+    if(clock_gettime(CLOCK_MODE , &e)!=0)
+        perror("Error Measuring end time.");
 
- //   tot=e.tv_sec-s.tv_sec;
- //   printf("Total runtime:  %ld:%02ld:%02ld\n",tot/3600,(tot/60)%60, tot%60);
+    secs = (e.tv_sec - s.tv_sec) + ((e.tv_nsec - s.tv_nsec) / 1e9);
+    printf("Flows: %ld in %.3f s, %.1f flows/s\n", injected_flows, secs, injected_flows / secs);
+    if(coalesce_window > 0){
+        printf("Coalesced events: %ld Steps: %ld Timing error: mean %g max %g\n", metrics.execution.coalesced_events, steps,
+               mean_coalesce_error(&metrics), metrics.execution.max_coalesce_error);
+    }
+}
+
+/**
+ * Closes a sampling interval of the dynamic metrics, of the given length, adding the mean bandwidth
+ * and utilization along it to the metrics.
+ */
+static void add_dynamic_sample(double length)
+{
+    float sample;
+
+    sample = dmetrics_bw / length;
+    list_append(&metrics.execution.agg_bw, &sample);
+    sample = dmetrics_util / length;
+    list_append(&metrics.execution.utilization, &sample);
+    dmetrics_bw = 0.0;
+    dmetrics_util = 0.0;
+}
+
+/**
+ * Adds a step, from start and t_next long, to the dynamic metrics sampled every dmetrics_time. The
+ * bandwidth of the links does not change along a step, so it is integrated exactly, splitting the
+ * step at the end of every interval, instead of ending the step there and solving the bandwidth
+ * again.
+ */
+static void sample_dynamic_metrics(double start, double t_next)
+{
+    double end = start + t_next;
+    double boundary = (double)dmetrics_time * dmetrics_step;
+    float bw = 0.0;
+    float util = 0.0;
+
+    if(links > 0){
+        bw = avg_link_bandwidth * links;
+        util = total_link_bw / links;
+    }
+    while(end >= boundary){
+        dmetrics_bw += bw * (boundary - start);
+        dmetrics_util += util * (boundary - start);
+        add_dynamic_sample(dmetrics_time);
+        start = boundary;
+        boundary = (double)dmetrics_time * ++dmetrics_step;
+    }
+    dmetrics_bw += bw * (end - start);
+    dmetrics_util += util * (end - start);
 }
 
 /**
@@ -90,18 +162,16 @@ void update_events(unsigned long long time_next_app)
     //long t_next;
     double t_next;
 
+    PROF_START(PROF_NEXT_EVENT);
     t_next = time_next_event(&list_cpus, &list_flows);
+    PROF_END(PROF_NEXT_EVENT);
 
     if((time_next_app - sched_info->makespan > 0) && (time_next_app - sched_info->makespan < t_next)){
         t_next = time_next_app - sched_info->makespan;
     }
 
-    if(dmetrics_time > 0){
-        if((sched_info->makespan + t_next) / dmetrics_time >= dmetrics_step ){
-            t_next = (dmetrics_time * dmetrics_step) - sched_info->makespan;
-            dmetrics_step++;
-        }
-    }
+    if(dmetrics_time > 0)
+        sample_dynamic_metrics(sched_info->makespan, t_next);
 
     sched_info->makespan += t_next;
 
@@ -113,6 +183,23 @@ void update_events(unsigned long long time_next_app)
     update_flows(&list_flows, t_next);
 }
 
+/**
+ * Whether an event finishes in this step: when it has no time left, or when it has less than the
+ * coalescing window left. Then it is retired before its time, and the error made is accounted.
+ */
+static int event_finished(double time_left)
+{
+    if(time_left <= 0)
+        return(1);
+    if(time_left > coalesce_window)
+        return(0);
+    metrics.execution.coalesced_events++;
+    metrics.execution.coalesce_error += time_left;
+    if(time_left > metrics.execution.max_coalesce_error)
+        metrics.execution.max_coalesce_error = time_left;
+    return(1);
+}
+
 /**
  * Update the remaining time of the CPU events using the previously calculated time.
  * Checks if a task has finished and, when all tasks have finished, finish the application.
@@ -131,7 +218,7 @@ void update_cpus(list_t *list_cpus, double t_next){
         pid = (*ev)->pid;
 
         (*ev)->count -= t_next;
-        if((*ev)->count <= 0){
+        if(event_finished((*ev)->count)){
             app->remaining_cpus[pid]--;
             list_rem_head((*ev)->app->task_events_occurred[(*ev)->pid]);
             num = insert_new_events(app, pid);
@@ -155,26 +242,26 @@ void update_cpus(list_t *list_cpus, double t_next){
 void update_flows(list_t *list_flows, double t_next){
 
     event **ev = NULL;
+    dflow_t *flow;
     application *app;
     int pid, pid2, rem, src, dst;
     long num_ev_send, num_ev_rec;
 
     list_reset(list_flows);
     while(list_next(list_flows, (void*)&ev)){
-        //printf("%f %f %f %ld %d\n", (*ev)->dflow.speed, t_next, ((*ev)->dflow.speed * t_next), (*ev)->count, (*ev)->dflow.allocated);
-        if((*ev)->dflow.allocated)
-        (*ev)->count -= ((*ev)->dflow.speed * t_next);
-        //printf("%f %f %f %ld %d\n", (*ev)->dflow.speed, t_next, ((*ev)->dflow.speed * t_next), (*ev)->count, (*ev)->dflow.allocated);
-        list_reset((*ev)->dflow.path);
-        //(*ev)->dflow.speed = FLT_MAX;
-        if((*ev)->count <= 0){
+        flow = get_flow((*ev)->flow);
+        //printf("%f %f %f %ld\n", flow->speed, t_next, (flow->speed * t_next), (*ev)->count);
+        (*ev)->count -= (flow_speed[(*ev)->flow] * t_next);
+        //flow->speed = FLT_MAX;
+        if((*ev)->count <= 0 || (coalesce_window > 0 && event_finished((*ev)->count / flow_speed[(*ev)->flow]))){
             app = (*ev)->app;
             pid = (*ev)->pid;
             pid2 = (*ev)->pid2;
             src = do_translation(app, (*ev)->pid, (*ev)->type_flow);
             dst = do_translation(app, (*ev)->pid2, (*ev)->type_flow);
-            update_flows_latency(&(app->info), (sched_info->makespan - (*ev)->dflow.start_time), (*ev)->type_flow);
-            remove_flow(&(*ev)->dflow, app->info.id, src, dst);
+            update_flows_latency(&(app->info), (sched_info->makespan - flow->start_time), (*ev)->type_flow);
+            remove_flow((*ev)->flow, app->info.id, src, dst);
+            free_flow((*ev)->flow);
             rem = remove_reception_event((*ev)->app->task_events[pid2], (*ev)->id, pid2, pid, (*ev)->total_subflows);
             remove_send_event(app->task_events_occurred[pid], (*ev)->id, pid, pid2, (*ev)->subflows_aux);
             if(rem){
@@ -199,6 +286,112 @@ void update_flows(list_t *list_flows, double t_next){
     }
 }
 
+/**
+ * Initializes the flow table, empty.
+ */
+void init_flows()
+{
+    flow_table = NULL;
+    flow_chunks = 0;
+    flow_speed = NULL;
+    flow_type = NULL;
+    free_flows = NULL;
+    n_free_flows = 0;
+    active_flows = NULL;
+    n_active_flows = 0;
+    active_slot = NULL;
+}
+
+/**
+ * Takes a flow from the flow table, growing it by a chunk when it is full, and initializes it.
+ *
+ * @return the index of the flow.
+ */
+long alloc_flow()
+{
+    long i, f;
+    dflow_t *flow;
+
+    if(n_free_flows == 0){
+        flow_table = realloc(flow_table, (flow_chunks + 1) * sizeof(dflow_t*));
+        flow_table[flow_chunks] = malloc(FLOW_CHUNK * sizeof(dflow_t));
+        flow_speed = realloc(flow_speed, (flow_chunks + 1) * FLOW_CHUNK * sizeof(float));
+        flow_type = realloc(flow_type, (flow_chunks + 1) * FLOW_CHUNK * sizeof(int));
+        free_flows = realloc(free_flows, (flow_chunks + 1) * FLOW_CHUNK * sizeof(long));
+        active_flows = realloc(active_flows, (flow_chunks + 1) * FLOW_CHUNK * sizeof(long));
+        active_slot = realloc(active_slot, (flow_chunks + 1) * FLOW_CHUNK * sizeof(long));
+        // lowest indices on top of the stack
+        for(i = FLOW_CHUNK - 1; i >= 0; i--){
+            free_flows[n_free_flows++] = (flow_chunks * FLOW_CHUNK) + i;
+            flow_table[flow_chunks][i].path = NULL;
+            flow_table[flow_chunks][i].path_length = 0;
+            flow_table[flow_chunks][i].max_path_length = 0;
+            flow_table[flow_chunks][i].lightpath = NULL;
+            flow_table[flow_chunks][i].lightpath_length = 0;
+            flow_table[flow_chunks][i].max_lightpath_length = 0;
+        }
+        flow_chunks++;
+    }
+    f = free_flows[--n_free_flows];
+    active_slot[f] = n_active_flows;
+    active_flows[n_active_flows++] = f;
+    flow = get_flow(f);
+    flow_speed[f] = FLT_MAX;
+    flow_type[f] = -1;
+    flow->san_link = -1;
+    flow->max_flows = 0;
+    flow->n_max_flows = 0;
+    flow->min_flows = INT_MAX;
+    flow->n_min_flows = 0;
+    flow->path_length = 0;
+    flow->lightpath_length = 0;
+    return(f);
+}
+
+/**
+ * Returns a flow to the flow table. It keeps the hops allocated for its route or circuit, for
+ * the next flow.
+ */
+void free_flow(long f)
+{
+    long last = active_flows[--n_active_flows];
+
+    active_flows[active_slot[f]] = last;
+    active_slot[last] = active_slot[f];
+    free_flows[n_free_flows++] = f;
+}
+
+/**
+ * Frees the flow table.
+ */
+void finish_flows()
+{
+    long i, j;
+
+    for(i = 0; i < flow_chunks; i++){
+        for(j = 0; j < FLOW_CHUNK; j++){
+            free(flow_table[i][j].path);
+            free(flow_table[i][j].lightpath);
+        }
+        free(flow_table[i]);
+    }
+    free(flow_table);
+    free(flow_speed);
+    free(flow_type);
+    free(free_flows);
+    free(active_flows);
+    free(active_slot);
+    flow_table = NULL;
+    flow_chunks = 0;
+    flow_speed = NULL;
+    flow_type = NULL;
+    free_flows = NULL;
+    n_free_flows = 0;
+    active_flows = NULL;
+    n_active_flows = 0;
+    active_slot = NULL;
+}
+
 long max_route_dynamic(long src, long dst)
 {
     long current = src;
@@ -210,8 +403,8 @@ long max_route_dynamic(long src, long dst)
         next_port = route(current, dst);
         current_aux = current;
         current = network[current].port[next_port].neighbour.node;
-        if(network[current].port[next_port].link_info_apps[0] > path_n_apps && current_aux != src && current != dst){
-            path_n_apps = network[current].port[next_port].link_info_apps[0];
+        if(network[current_aux].port[next_port].link_last_app > path_n_apps && current_aux != src && current != dst){
+            path_n_apps = network[current_aux].port[next_port].link_last_app;
             //break;
 
         }
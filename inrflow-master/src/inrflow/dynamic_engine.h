@@ -6,6 +6,23 @@
 
 #include "node.h"
 
+#define FLOW_CHUNK 1024	///< Flows allocated at once in the flow table.
+
+/// Flow f of the flow table.
+#define get_flow(f) (&flow_table[(f) / FLOW_CHUNK][(f) % FLOW_CHUNK])
+
+extern dflow_t **flow_table;
+
+extern long flow_chunks;    ///< Chunks in the flow table.
+
+extern float *flow_speed;   ///< Speed of every flow of the flow table.
+
+extern int *flow_type;      ///< Type of every flow of the flow table.
+
+extern long *active_flows;  ///< Flows in use, in no particular order.
+
+extern long n_active_flows; ///< Flows in use.
+
 int flow_inj_mode; ///< Flow injection mode
 
 int dmetrics_time;
@@ -18,12 +35,20 @@ double (*time_next_event)(list_t *list_cpus, list_t *list_flows);
 
 long (*insert_new_events)(application *app, long ntask);
 
-void (*remove_flow)(dflow_t *flow, long id, long src, long dst);
+void (*remove_flow)(long f, long id, long src, long dst);
 
 void (*min_links_bandwidth)();
 
 void run_dynamic();
 
+void init_flows();
+
+long alloc_flow();
+
+void free_flow(long f);
+
+void finish_flows();
+
 void update_events(unsigned long long time_next_app);
 
 void update_cpus(list_t *list_cpus, double t_next);
@@ -6,6 +6,8 @@
 #include "list.h"
 #include "metrics.h"
 #include "globals.h"
+#include "profiler.h"
+#include "fair_share.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
@@ -58,33 +60,37 @@ double time_next_event_electric(list_t *list_cpus, list_t *list_flows){
 #ifdef DEBUG
                         active_events++;
 #endif // DEBUG
-                        if(ev->count == ev->length){
-                            ev->dflow.start_time = sched_info->makespan;
-                            flow = &ev->dflow;
+                        if(ev->flow == -1){
+                            ev->flow = alloc_flow();
+                            flow = get_flow(ev->flow);
+                            flow->start_time = sched_info->makespan;
                             src = do_translation(app, ev->pid, ev->type_flow);
                             dst = do_translation(app, ev->pid2, ev->type_flow);
                             if(src == dst && ev->type_flow == 1){
-                                ev->dflow.speed = read_capacity;
+                                flow_speed[ev->flow] = read_capacity;
                             }
                             else if(src == dst && ev->type_flow == 2){
-                                ev->dflow.speed = write_capacity;
+                                flow_speed[ev->flow] = write_capacity;
                             }
                             else if(src == dst){
-                                ev->dflow.speed = memory_capacity;
+                                flow_speed[ev->flow] = memory_capacity;
                             }
                             if(ev->type_flow == 5){
                                 src_aux = random() % n_io_servers;
                                 sched_info->san->san_links[src_aux].n_flows_read++;
-                                ev->dflow.san_link = src_aux;
+                                flow->san_link = src_aux;
                             }
                             else if(ev->type_flow == 6){
                                 src_aux = random() % n_io_servers;
                                 sched_info->san->san_links[src_aux].n_flows_write++;
-                                ev->dflow.san_link = src_aux;
+                                flow->san_link = src_aux;
                             }
-                            path_length = mark_route_dynamic_electric(app, flow, src, dst, ev->type_flow);
-                            if(path_length == -1)
+                            path_length = mark_route_dynamic_electric(app, ev->flow, src, dst, ev->type_flow);
+                            if(path_length == -1){
+                                free_flow(ev->flow);
+                                ev->flow = -1;
                                 continue;
+                            }
                             update_flows_distance(&(app->info), path_length, ev->type_flow);
                             list_append(list_flows, &ev);
                         }
@@ -111,29 +117,32 @@ double time_next_event_electric(list_t *list_cpus, list_t *list_flows){
 
     san_links_bandwidth();
 
+    PROF_START(PROF_BANDWIDTH);
     min_links_bandwidth();
+    PROF_END(PROF_BANDWIDTH);
 
     list_reset(list_flows);
     while(list_next(list_flows, (void*)&ev_p)){
+        flow = get_flow((*ev_p)->flow);
         if((*ev_p)->type_flow == 5){
-            src = (*ev_p)->dflow.san_link;
+            src = flow->san_link;
             if(sched_info->san->san_links[src].current_speed_read > read_capacity){
-                (*ev_p)->dflow.speed = read_capacity;
+                flow_speed[(*ev_p)->flow] = read_capacity;
             }
             else{
-                (*ev_p)->dflow.speed = sched_info->san->san_links[src].current_speed_read;
+                flow_speed[(*ev_p)->flow] = sched_info->san->san_links[src].current_speed_read;
             }
         }
         else if((*ev_p)->type_flow == 6){
-            src = (*ev_p)->dflow.san_link;
+            src = flow->san_link;
             if(sched_info->san->san_links[src].current_speed_write > write_capacity){
-                (*ev_p)->dflow.speed = write_capacity;
+                flow_speed[(*ev_p)->flow] = write_capacity;
             }
             else{
-                (*ev_p)->dflow.speed = sched_info->san->san_links[src].current_speed_write;
+                flow_speed[(*ev_p)->flow] = sched_info->san->san_links[src].current_speed_write;
             }
         }
-        time_next = round_ns((*ev_p)->count / (*ev_p)->dflow.speed);
+        time_next = round_ns((*ev_p)->count / flow_speed[(*ev_p)->flow]);
         if(time_next < min){
             min = time_next;
         }
@@ -220,22 +229,22 @@ long insert_new_events_electric(application *app, long ntask){
  *
  * @return 1 if there is a path between them, 0 otherwise.
  */
-long mark_route_dynamic_electric(application *app, dflow_t *flow, long src, long dst, int type)
+long mark_route_dynamic_electric(application *app, long f, long src, long dst, int type)
 {
     long current = src;
     long current_aux = 0;
     long path_length = 0;
-    node_list *node;
     long next_port;
-    long app_id;
-    long apps_running = 0;
-    route_t path;
-    list_t *dflows;
+    long last_app;
+    route_t *path;
+    dflow_t *flow = get_flow(f);
     long path_number = 0;
     long path_n_flows_max = 0;
     long path_n_apps = 0;
 
+    PROF_START(PROF_INIT_ROUTING);
     path_number = init_routing(src, dst, app->info.id);
+    PROF_END(PROF_INIT_ROUTING);
     if(path_number  == -1){
         return -1; // no injection at this time
     }
@@ -251,15 +260,23 @@ long mark_route_dynamic_electric(application *app, dflow_t *flow, long src, long
         flow->type_id = -1;
     }
 
-    flow->type = type;
-    list_initialize(flow->path, sizeof(route_t));
+    flow_type[f] = type;
+    flow->path_length = 0;
     while(current != dst) {	// not at destination yet
+        PROF_START(PROF_ROUTE);
         next_port = route(current, dst);
+        PROF_END(PROF_ROUTE);
 
         path_length++;
 
-        path.node = current;
-        path.port = next_port;
+        if(flow->path_length == flow->max_path_length){
+            flow->max_path_length = (flow->max_path_length == 0) ? 8 : 2 * flow->max_path_length;
+            flow->path = realloc(flow->path, flow->max_path_length * sizeof(route_t));
+        }
+        path = &flow->path[flow->path_length];
+        path->node = current;
+        path->port = next_port;
+        path->slot = add_port_flow(&network[current].port[next_port], f, flow->path_length++);
         network[current].port[next_port].flows++;
         if(type == 1){
             network[current].port[next_port].flows_storage_read++;
@@ -283,31 +300,12 @@ long mark_route_dynamic_electric(application *app, dflow_t *flow, long src, long
         }
         app->info.links_utilization[current][next_port]++;
 
-        if(network[current].port[next_port].link_info[app->info.id] == 0){
-            apps_running = 0;
-            for(app_id = 1; app_id < MAX_CONCURRENT_APPS + 1;app_id++){
-                if((network[current].port[next_port].link_info[app_id] > 0) && is_running(app_id)){
-                    apps_running++;
-                }
-            }
-            network[current].port[next_port].link_info[0] = apps_running + 1;
+        last_app = add_link_app_flow(&network[current].port[next_port], app->info.id);
+        if(last_app > path_n_apps){
+            path_n_apps = last_app;
         }
-        network[current].port[next_port].link_info[app->info.id]++;
 
-        if(network[current].port[next_port].link_info_apps[app->info.id] == 0){
-            network[current].port[next_port].link_info_apps[0] = app->info.id;
-        }
-        network[current].port[next_port].link_info_apps[app->info.id]++;
-        if(network[current].port[next_port].link_info_apps[0] > path_n_apps){
-            path_n_apps = network[current].port[next_port].link_info_apps[0];
-        }
-
-        list_append(&network[current].port[next_port].dflows, &flow);
-        list_tail_node(&network[current].port[next_port].dflows, (void*)&node);
-        path.n_l = node;
-        list_append(flow->path, &path);
-        dflows = &network[current].port[next_port].dflows;
-        calc_insert_flow_max_min_electric(dflows, current, next_port);
+        calc_insert_flow_max_min_electric(current, next_port);
         current_aux = current;
         current = network[current].port[next_port].neighbour.node;
 
@@ -319,85 +317,76 @@ long mark_route_dynamic_electric(application *app, dflow_t *flow, long src, long
     return(path_length);
 }
 
-void remove_flow_electric(dflow_t *flow, long id, long src, long dst){
+void remove_flow_electric(long f, long id, long src, long dst){
 
+    dflow_t *flow = get_flow(f);
     route_t *path;
     long path_n_apps = 0;
+    long last_app;
+    long h;
 
-    if(flow->type == 1){
+    if(flow_type[f] == 1){
         network[src].flows_storage_read_injected--;
     }
-    else if(flow->type == 2){
+    else if(flow_type[f] == 2){
         network[dst].flows_storage_write_injected--;
     }
-    else if(flow->type == 5){
+    else if(flow_type[f] == 5){
         src = flow->san_link;
         sched_info->san->san_links[src].n_flows_read--;
     }
-    else if(flow->type == 6){
+    else if(flow_type[f] == 6){
         src = flow->san_link;
         sched_info->san->san_links[src].n_flows_write--;
     }
-    list_reset(flow->path);
-    while(list_next(flow->path, (void*)&path)){
-
+    for(h = 0; h < flow->path_length; h++){
+        path = &flow->path[h];
         network[path->node].port[path->port].flows--;
-        if(flow->type == 1){
+        if(flow_type[f] == 1){
             network[path->node].port[path->port].flows_storage_read--;
             network[path->node].port[path->port].flows_storage_read_fault--;
         }
-        else if(flow->type == 3){
+        else if(flow_type[f] == 3){
             network[path->node].port[path->port].flows_storage_read--;
         }
-        else if(flow->type == 2){
+        else if(flow_type[f] == 2){
             network[path->node].port[path->port].flows_storage_write--;
             network[path->node].port[path->port].flows_storage_write_fault--;
         }
-        else if(flow->type == 4){
+        else if(flow_type[f] == 4){
             network[path->node].port[path->port].flows_storage_write--;
         }
-        network[path->node].port[path->port].link_info_apps[id]--;
-        if(network[path->node].port[path->port].link_info_apps[id] == 0){
-            network[path->node].port[path->port].link_info_apps[0] = 0;
-        }
-        if(network[path->node].port[path->port].link_info_apps[0] > path_n_apps){
-            path_n_apps = network[path->node].port[path->port].link_info_apps[0];
+        last_app = remove_link_app_flow(&network[path->node].port[path->port], id);
+        if(last_app > path_n_apps){
+            path_n_apps = last_app;
         }
 
-        list_rem_node(&network[path->node].port[path->port].dflows, path->n_l);
-        list_rem_elem(flow->path);
+        remove_port_flow(&network[path->node].port[path->port], path->slot);
     }
-    free(flow->path);
+    flow->path_length = 0;
 }
 
-void min_links_bandwidth_fast_electric(){
+/**
+ * Speed of the storage flows of the servers (reads and writes of the local storage), in the
+ * dynamic-fast mode. It comes before their fair share in the links.
+ */
+void storage_bandwidth_electric(){
 
     long i,j,i_aux, j_aux;
     long bandwidth_read = 0;
     long bandwidth_write = 0;
-    float total_link_bw = 0.0;
-    float link_bw = 0.0;
-    float l_bandwidth = 0;
-    float l_bandwidth_comms = 0;
-    float l_bandwidth_stg = 0;
-    float bandwidth_comms = 0;
-    float bandwidth_stg = 0;
-    list_t *dflows;
-    dflow_t **flow;
-    min_speed = FLT_MAX;
-    avg_link_bandwidth = 0.0;
-    links = 0;
-    total_links = 0;
+    port_t *port;
+    long k, f;
 
     for(i=0; i<servers; i++){
         if(network[i].flows_storage_read_injected > 0){
             bandwidth_read = read_capacity / network[i].flows_storage_read_injected;
             for(j = 0 ;j<network[i].nports; j++){
-                dflows = &network[i].port[j].dflows;
-                list_reset(dflows);
-                while(list_next(dflows, (void*)&flow)){
-                    if((*flow)->type_id == i && (*flow)->type == 1){
-                        (*flow)->speed = bandwidth_read;
+                port = &network[i].port[j];
+                for(k = 0; k < port->n_dflows; k++){
+                    f = port->dflows[k].flow;
+                    if(flow_type[f] == 1 && get_flow(f)->type_id == i){
+                        flow_speed[f] = bandwidth_read;
                     }
                 }
             }
@@ -408,11 +397,11 @@ void min_links_bandwidth_fast_electric(){
                 i_aux = network[i].port[j].neighbour.node;
                 for(j_aux = 0; j_aux < network[i_aux].nports; j_aux++){
                     if(network[i_aux].port[j_aux].neighbour.node == i){
-                        dflows = &network[i_aux].port[j_aux].dflows;
-                        list_reset(dflows);
-                        while(list_next(dflows, (void*)&flow)){
-                            if((*flow)->type_id == i  && (*flow)->type == 2){
-                                (*flow)->speed = bandwidth_write;
+                        port = &network[i_aux].port[j_aux];
+                        for(k = 0; k < port->n_dflows; k++){
+                            f = port->dflows[k].flow;
+                            if(flow_type[f] == 2 && get_flow(f)->type_id == i){
+                                flow_speed[f] = bandwidth_write;
                             }
                         }
                         break;
@@ -421,92 +410,77 @@ void min_links_bandwidth_fast_electric(){
             }
         }
     }
+}
 
-    for(i=0; i<servers+switches; i++){
-        for(j=0; j<network[i].nports; j++){
-            total_links++;
-            if(network[i].port[j].neighbour.node == -1 || network[i].port[j].neighbour.port == -1 ||  network[i].port[j].flows == 0)
-                continue;
-            links++;
-            link_bw = 0;
-
-            if(traffic_priority == TTP_TRAFFIC_PRIORITY){
-                l_bandwidth = (float)network[i].port[j].bandwidth_capacity;
-                l_bandwidth_comms = (float)network[i].port[j].bandwidth_capacity * ((float)traffic_priority_params[0]/100);
-                l_bandwidth_stg = (float)network[i].port[j].bandwidth_capacity * ((float)traffic_priority_params[1]/100);
-
-                if((network[i].port[j].flows - (network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write)) == 0){
-                    bandwidth_stg =  l_bandwidth / network[i].port[j].flows;
-                }
-                else if((network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write) == 0){
-                    bandwidth_comms =  l_bandwidth / network[i].port[j].flows;
-                }
-                else{
-                bandwidth_comms = l_bandwidth_comms / (network[i].port[j].flows - (network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write));
-                bandwidth_stg = l_bandwidth_stg / (network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write);
-                }
-
-                dflows = &network[i].port[j].dflows;
-                list_reset(dflows);
-                while(list_next(dflows, (void*)&flow)){
-
-                    if(bandwidth_comms < (*flow)->speed && (*flow)->type == 0 && (*flow)->type != 5 && (*flow)->type != 6){
-                        (*flow)->speed = bandwidth_comms;
-                    }
-
-                    if(bandwidth_stg < (*flow)->speed && (*flow)->type != 0 && (*flow)->type != 5 && (*flow)->type != 6){
-                        (*flow)->speed = bandwidth_stg;
-                    }
+/**
+ * Fair share of a port in the dynamic-fast mode, for its flows of comms and for its storage flows,
+ * following the traffic priority. A share that does not apply to any flow of the port is infinite.
+ */
+void port_shares_electric(port_t *port, float *bandwidth_comms, float *bandwidth_stg){
 
-                    if((*flow)->type != 5 && (*flow)->type != 6){
-                        link_bw += (*flow)->speed;
-                    }
-                }
-            }
-            else if(traffic_priority == STP_TRAFFIC_PRIORITY){
+    float l_bandwidth = (float)port->bandwidth_capacity;
+    float l_bandwidth_comms;
+    float l_bandwidth_stg;
+    long flows_stg = port->flows_storage_read + port->flows_storage_write;
 
-                l_bandwidth = (float)network[i].port[j].bandwidth_capacity;
+    *bandwidth_comms = INFINITY;
+    *bandwidth_stg = INFINITY;
+    if(traffic_priority == TTP_TRAFFIC_PRIORITY){
+        l_bandwidth_comms = (float)port->bandwidth_capacity * ((float)traffic_priority_params[0]/100);
+        l_bandwidth_stg = (float)port->bandwidth_capacity * ((float)traffic_priority_params[1]/100);
 
-                if((network[i].port[j].flows - (network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write)) > 0){
-                    bandwidth_comms = l_bandwidth / (network[i].port[j].flows - (network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write));
-                    bandwidth_stg = 0;
-                }
-                else if(network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write > 0){
-                    bandwidth_stg = l_bandwidth / (network[i].port[j].flows_storage_read + network[i].port[j].flows_storage_write);
-                    bandwidth_comms = 0;
-                }
+        if((port->flows - flows_stg) == 0){
+            *bandwidth_stg =  l_bandwidth / port->flows;
+        }
+        else if(flows_stg == 0){
+            *bandwidth_comms =  l_bandwidth / port->flows;
+        }
+        else{
+            *bandwidth_comms = l_bandwidth_comms / (port->flows - flows_stg);
+            *bandwidth_stg = l_bandwidth_stg / flows_stg;
+        }
+    }
+    else if(traffic_priority == STP_TRAFFIC_PRIORITY){
+        // Comms first: the storage flows are not lowered while there are comms
+        if((port->flows - flows_stg) > 0){
+            *bandwidth_comms = l_bandwidth / (port->flows - flows_stg);
+        }
+        else if(flows_stg > 0){
+            *bandwidth_stg = l_bandwidth / flows_stg;
+        }
+    }
+    else{
+        *bandwidth_comms = l_bandwidth / port->flows;
+        *bandwidth_stg = *bandwidth_comms;
+    }
+}
 
-                dflows = &network[i].port[j].dflows;
-                list_reset(dflows);
-                while(list_next(dflows, (void*)&flow)){
+void min_links_bandwidth_fast_electric(){
 
-                    if(bandwidth_comms < (*flow)->speed && bandwidth_comms > 0 && (*flow)->type == 0 && (*flow)->type != 5 && (*flow)->type != 6){
-                        (*flow)->speed = bandwidth_comms;
-                    }
+    long i,j;
+    float link_bw = 0.0;
+    float l_bandwidth = 0;
+    float bandwidth_comms = 0;
+    float bandwidth_stg = 0;
+    port_t *port;
+    min_speed = FLT_MAX;
+    total_link_bw = 0.0;
+    avg_link_bandwidth = 0.0;
+    links = 0;
+    total_links = 0;
 
-                    if(bandwidth_stg < (*flow)->speed && bandwidth_stg > 0 && (*flow)->type != 0 && (*flow)->type != 5 && (*flow)->type != 6){
-                        (*flow)->speed = bandwidth_stg;
-                    }
+    storage_bandwidth_electric();
 
-                    if((*flow)->type != 5 && (*flow)->type != 6){
-                        link_bw += (*flow)->speed;
-                    }
-                }
-            }
-            else{
-                l_bandwidth = (float)network[i].port[j].bandwidth_capacity;
-                bandwidth_comms = l_bandwidth / network[i].port[j].flows;
-                dflows = &network[i].port[j].dflows;
-                list_reset(dflows);
-                while(list_next(dflows, (void*)&flow)){
-                    if(bandwidth_comms < (*flow)->speed && (*flow)->type != 5 && (*flow)->type != 6){
-                        (*flow)->speed = bandwidth_comms;
-                    }
-                    if((*flow)->type != 5 && (*flow)->type != 6){
-                        link_bw += (*flow)->speed;
-                    }
-                }
-            }
+    for(i=0; i<servers+switches; i++){
+        for(j=0; j<network[i].nports; j++){
+            total_links++;
+            if(network[i].port[j].neighbour.node == -1 || network[i].port[j].neighbour.port == -1 ||  network[i].port[j].flows == 0)
+                continue;
+            links++;
+            port = &network[i].port[j];
+            l_bandwidth = (float)port->bandwidth_capacity;
+            port_shares_electric(port, &bandwidth_comms, &bandwidth_stg);
+            link_bw = fair_share(port->dflows, port->n_dflows, bandwidth_comms, bandwidth_stg);
 
             if(link_bw < min_speed)
                 min_speed = link_bw;
@@ -532,9 +506,11 @@ void min_links_bandwidth_accurate_electric(){
     float remaining_bandwidth = 0.0;
     float remaining_bandwidth_aux = 0.0;
     long remaining_flows = 0;
-    list_t *dflows;
-    dflow_t **flow;
+    port_t *port;
+    dflow_t *flow;
+    long k, f;
     min_speed = FLT_MAX;
+    total_link_bw = 0.0;
     avg_link_bandwidth = 0.0;
     links = 0;
     total_links = 0;
@@ -548,51 +524,53 @@ void min_links_bandwidth_accurate_electric(){
             link_bw = 0;
             l_bandwidth = (float)network[i].port[j].bandwidth_capacity;
             bandwidth = l_bandwidth / network[i].port[j].flows;
-            dflows = &network[i].port[j].dflows;
+            port = &network[i].port[j];
 
             remaining_bandwidth = 0;
             remaining_flows = 0;
 
-            list_reset(dflows);
-            while(list_next(dflows, (void*)&flow)){
+            for(k = 0; k < port->n_dflows; k++){
+                f = port->dflows[k].flow;
+                flow = get_flow(f);
                 // Consider all links with the same bandwidth
-                flow_min_bandwidth = l_bandwidth / (*flow)->max_flows;
-                flow_max_bandwidth = l_bandwidth / (*flow)->min_flows;
+                flow_min_bandwidth = l_bandwidth / flow->max_flows;
+                flow_max_bandwidth = l_bandwidth / flow->min_flows;
 
-                if(bandwidth <= (*flow)->speed && bandwidth > flow_min_bandwidth){
-                    (*flow)->speed = flow_min_bandwidth;
+                if(bandwidth <= flow_speed[f] && bandwidth > flow_min_bandwidth){
+                    flow_speed[f] = flow_min_bandwidth;
                     link_bw += flow_min_bandwidth;
                     remaining_bandwidth += (bandwidth - flow_min_bandwidth);
                 }
-                else if(bandwidth <= (*flow)->speed){
-                    (*flow)->speed = bandwidth;
+                else if(bandwidth <= flow_speed[f]){
+                    flow_speed[f] = bandwidth;
                     link_bw += bandwidth;
                     remaining_flows++;
                 }
                 else{
-                    link_bw += (*flow)->speed;
-                    remaining_bandwidth += ((*flow)->speed - bandwidth);
+                    link_bw += flow_speed[f];
+                    remaining_bandwidth += (flow_speed[f] - bandwidth);
                 }
-                //link_bw += (*flow)->speed;
+                //link_bw += flow_speed[f];
             }
             while(remaining_flows > 0 && (remaining_bandwidth_aux = floorf(remaining_bandwidth/remaining_flows)) > 0){
-                list_reset(dflows);
-                while(list_next(dflows, (void*)&flow)){
-                    flow_min_bandwidth = l_bandwidth / (*flow)->max_flows;
-                    flow_max_bandwidth = l_bandwidth / (*flow)->min_flows;
-                    if(bandwidth <= flow_min_bandwidth && ((*flow)->speed + remaining_bandwidth_aux <= flow_max_bandwidth)){
-                        (*flow)->speed += remaining_bandwidth_aux;
+                for(k = 0; k < port->n_dflows; k++){
+                    f = port->dflows[k].flow;
+                    flow = get_flow(f);
+                    flow_min_bandwidth = l_bandwidth / flow->max_flows;
+                    flow_max_bandwidth = l_bandwidth / flow->min_flows;
+                    if(bandwidth <= flow_min_bandwidth && (flow_speed[f] + remaining_bandwidth_aux <= flow_max_bandwidth)){
+                        flow_speed[f] += remaining_bandwidth_aux;
                         link_bw += remaining_bandwidth_aux;
                         remaining_bandwidth -= remaining_bandwidth_aux;
                     }
-                    else  if((bandwidth <= flow_min_bandwidth) && ((*flow)->speed + remaining_bandwidth_aux > flow_max_bandwidth) && ((*flow)->speed != flow_max_bandwidth)){
-                        bw_aux = (flow_max_bandwidth - (*flow)->speed);
+                    else  if((bandwidth <= flow_min_bandwidth) && (flow_speed[f] + remaining_bandwidth_aux > flow_max_bandwidth) && (flow_speed[f] != flow_max_bandwidth)){
+                        bw_aux = (flow_max_bandwidth - flow_speed[f]);
                         remaining_bandwidth -= bw_aux;
                         link_bw += bw_aux;
-                        (*flow)->speed += bw_aux;
+                        flow_speed[f] += bw_aux;
                         remaining_flows--;
                     }
-                    else if((bandwidth <= flow_min_bandwidth) && ((*flow)->speed + remaining_bandwidth_aux > flow_max_bandwidth) && ((*flow)->speed == flow_max_bandwidth)){
+                    else if((bandwidth <= flow_min_bandwidth) && (flow_speed[f] + remaining_bandwidth_aux > flow_max_bandwidth) && (flow_speed[f] == flow_max_bandwidth)){
                         remaining_flows--;
                     }
                 }
@@ -609,44 +587,47 @@ void min_links_bandwidth_accurate_electric(){
     metrics.execution.avg_agg_bw += ((link_bw - metrics.execution.avg_agg_bw) / (float)(++metrics.execution.n_steps));
 }
 
-void calc_insert_flow_max_min_electric(list_t *dflows, long current, long next_port){
+void calc_insert_flow_max_min_electric(long current, long next_port){
 
-    dflow_t **flow_aux;
+    dflow_t *flow_aux;
     route_t *path_aux;
+    link_flow_t *dflows;
+    long k, h;
     switch(mode){
         case DYNAMIC_ELECTRIC_ACCURATE:
-            list_reset(dflows);
-            while(list_next(dflows, (void*)&flow_aux)){
-                if(network[current].port[next_port].flows > (*flow_aux)->max_flows){
-                    (*flow_aux)->max_flows = network[current].port[next_port].flows;
-                    (*flow_aux)->n_max_flows = 1;
+            dflows = network[current].port[next_port].dflows;
+            for(k = 0; k < network[current].port[next_port].n_dflows; k++){
+                flow_aux = get_flow(dflows[k].flow);
+                if(network[current].port[next_port].flows > flow_aux->max_flows){
+                    flow_aux->max_flows = network[current].port[next_port].flows;
+                    flow_aux->n_max_flows = 1;
                 }
-                else if(network[current].port[next_port].flows == (*flow_aux)->max_flows){
-                    (*flow_aux)->n_max_flows++;
+                else if(network[current].port[next_port].flows == flow_aux->max_flows){
+                    flow_aux->n_max_flows++;
                 }
-                if((network[current].port[next_port].flows < (*flow_aux)->min_flows)){
-                    (*flow_aux)->min_flows = network[current].port[next_port].flows;
-                    (*flow_aux)->n_min_flows = 1;
+                if((network[current].port[next_port].flows < flow_aux->min_flows)){
+                    flow_aux->min_flows = network[current].port[next_port].flows;
+                    flow_aux->n_min_flows = 1;
                 }
-                else if(network[current].port[next_port].flows - 1 == (*flow_aux)->min_flows && (*flow_aux)->n_min_flows == 1){
-                    (*flow_aux)->min_flows = INT_MAX;
-                    (*flow_aux)->n_min_flows = 0;
-                    list_reset((*flow_aux)->path);
-                    while(list_next((*flow_aux)->path, (void*)&path_aux)){
-                        if(network[path_aux->node].port[path_aux->port].flows < (*flow_aux)->min_flows){
-                            (*flow_aux)->min_flows = network[path_aux->node].port[path_aux->port].flows;
-                            (*flow_aux)->n_min_flows = 1;
+                else if(network[current].port[next_port].flows - 1 == flow_aux->min_flows && flow_aux->n_min_flows == 1){
+                    flow_aux->min_flows = INT_MAX;
+                    flow_aux->n_min_flows = 0;
+                    for(h = 0; h < flow_aux->path_length; h++){
+                        path_aux = &flow_aux->path[h];
+                        if(network[path_aux->node].port[path_aux->port].flows < flow_aux->min_flows){
+                            flow_aux->min_flows = network[path_aux->node].port[path_aux->port].flows;
+                            flow_aux->n_min_flows = 1;
                         }
-                        else if(network[path_aux->node].port[path_aux->port].flows == (*flow_aux)->min_flows){
-                            (*flow_aux)->n_min_flows++;
+                        else if(network[path_aux->node].port[path_aux->port].flows == flow_aux->min_flows){
+                            flow_aux->n_min_flows++;
                         }
                     }
                 }
-                else if(network[current].port[next_port].flows - 1 == (*flow_aux)->min_flows){
-                    (*flow_aux)->n_min_flows--;
+                else if(network[current].port[next_port].flows - 1 == flow_aux->min_flows){
+                    flow_aux->n_min_flows--;
                 }
-                else if(network[current].port[next_port].flows == (*flow_aux)->min_flows){
-                    (*flow_aux)->n_min_flows++;
+                else if(network[current].port[next_port].flows == flow_aux->min_flows){
+                    flow_aux->n_min_flows++;
                 }
             }
             break;
@@ -654,49 +635,52 @@ void calc_insert_flow_max_min_electric(list_t *dflows, long current, long next_p
 }
 
 
-void calc_remove_flow_max_min_electric(list_t *dflows, long node, long port){
+void calc_remove_flow_max_min_electric(long node, long port){
 
-    dflow_t **flow_aux;
+    dflow_t *flow_aux;
     route_t *path_aux;
+    link_flow_t *dflows;
+    long k, h;
 
     switch(mode){
         case DYNAMIC_ELECTRIC_ACCURATE:
-            list_reset(dflows);
-            while(list_next(dflows, (void*)&flow_aux)){
-                if(((*flow_aux)->max_flows == network[node].port[port].flows + 1) && (*flow_aux)->n_max_flows == 1){
-                    (*flow_aux)->max_flows = 0;
-                    (*flow_aux)->n_max_flows = 0;
-                    list_reset((*flow_aux)->path);
-                    while(list_next((*flow_aux)->path, (void*)&path_aux)){
-                        if(network[path_aux->node].port[path_aux->port].flows > (*flow_aux)->max_flows){
-                            (*flow_aux)->max_flows = network[path_aux->node].port[path_aux->port].flows;
-                            (*flow_aux)->n_max_flows = 1;
+            dflows = network[node].port[port].dflows;
+            for(k = 0; k < network[node].port[port].n_dflows; k++){
+                flow_aux = get_flow(dflows[k].flow);
+                if((flow_aux->max_flows == network[node].port[port].flows + 1) && flow_aux->n_max_flows == 1){
+                    flow_aux->max_flows = 0;
+                    flow_aux->n_max_flows = 0;
+                    for(h = 0; h < flow_aux->path_length; h++){
+                        path_aux = &flow_aux->path[h];
+                        if(network[path_aux->node].port[path_aux->port].flows > flow_aux->max_flows){
+                            flow_aux->max_flows = network[path_aux->node].port[path_aux->port].flows;
+                            flow_aux->n_max_flows = 1;
                         }
-                        else if(network[path_aux->node].port[path_aux->port].flows == (*flow_aux)->max_flows){
-                            (*flow_aux)->n_max_flows++;
+                        else if(network[path_aux->node].port[path_aux->port].flows == flow_aux->max_flows){
+                            flow_aux->n_max_flows++;
                         }
                     }
                 }
-                else if((*flow_aux)->max_flows == network[node].port[port].flows + 1){
-                    (*flow_aux)->n_max_flows--;
+                else if(flow_aux->max_flows == network[node].port[port].flows + 1){
+                    flow_aux->n_max_flows--;
                 }
-                if(((*flow_aux)->min_flows == network[node].port[port].flows + 1) && (*flow_aux)->n_min_flows == 1){
-                    (*flow_aux)->min_flows = INT_MAX;
-                    (*flow_aux)->n_min_flows = 0;
-                    list_reset((*flow_aux)->path);
-                    while(list_next((*flow_aux)->path, (void*)&path_aux)){
-                        if(network[path_aux->node].port[path_aux->port].flows < (*flow_aux)->min_flows){
-                            (*flow_aux)->min_flows = network[path_aux->node].port[path_aux->port].flows;
-                            (*flow_aux)->n_min_flows = 1;
+                if((flow_aux->min_flows == network[node].port[port].flows + 1) && flow_aux->n_min_flows == 1){
+                    flow_aux->min_flows = INT_MAX;
+                    flow_aux->n_min_flows = 0;
+                    for(h = 0; h < flow_aux->path_length; h++){
+                        path_aux = &flow_aux->path[h];
+                        if(network[path_aux->node].port[path_aux->port].flows < flow_aux->min_flows){
+                            flow_aux->min_flows = network[path_aux->node].port[path_aux->port].flows;
+                            flow_aux->n_min_flows = 1;
                         }
-                        else if(network[path_aux->node].port[path_aux->port].flows == (*flow_aux)->min_flows){
-                            (*flow_aux)->n_min_flows++;
+                        else if(network[path_aux->node].port[path_aux->port].flows == flow_aux->min_flows){
+                            flow_aux->n_min_flows++;
                         }
                     }
                 }
-                else if((*flow_aux)->min_flows == (network[node].port[port].flows + 1)){
-                    (*flow_aux)->min_flows = network[node].port[port].flows;
-                    (*flow_aux)->n_min_flows--;
+                else if(flow_aux->min_flows == (network[node].port[port].flows + 1)){
+                    flow_aux->min_flows = network[node].port[port].flows;
+                    flow_aux->n_min_flows--;
                 }
             }
             break;
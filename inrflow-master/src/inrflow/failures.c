@@ -11,6 +11,7 @@ extern long ports;	///< The total number of ports in the topology
 
 float failure_rate;  ///< rate of the network which is faulty updates n_failures
 long n_failures;  ///< number of failures
+long sweep_steps;  ///< number of steps in which failures are added in a failure sweep
 
 /**
  * Counts the number of failures in the network.
@@ -26,6 +27,41 @@ long check_failures()
 }
 
 
+/**
+ * Computes the number of links to break from the failure rate, unless it was given explicitly.
+ */
+long target_failures()
+{
+    if (n_failures==-1) // undefined
+        n_failures = (long)((ports/2)*failure_rate);//ports is the number of ports (twice the number of links)
+    return n_failures;
+}
+
+/**
+ * Breaks a random link that is neither faulty nor disconnected. Both ends are marked as faulty.
+ *
+ * @param node returns the node in which the failure was chosen.
+ * @param port returns the port of the failure in the node.
+ */
+void fail_random_link(long *node, long *port)
+{
+    long i,j; // node, port
+
+    do {
+        i=rand()%(servers+switches);
+        j=rand()%network[i].nports;
+        // Choose a different link if the link is already faulty or it is disconnected
+    } while (network[i].port[j].faulty==1 ||
+            network[i].port[j].neighbour.node==-1);
+    network[i].port[j].faulty=1;
+    network[network[i].port[j].neighbour.node].port[network[i].port[j].neighbour.port].faulty=1;
+#ifdef SHOWCONNECTIONS
+    printf("node %ld fails on port %ld\n",i,j);
+#endif
+    *node=i;
+    *port=j;
+}
+
 /**
  * Selects at random which links to break
  */
@@ -35,23 +71,10 @@ void set_failures()
     long i,j; // node, port
 
     //use probability to decide number of failures.  cast it to long
-    if (n_failures==-1) // undefined
-        n_failures = (long)((ports/2)*failure_rate);//ports is the number of ports (twice the number of links)
-
+    target_failures();
 
-    for(n=0; n<n_failures; n++) {
-        do {
-            i=rand()%(servers+switches);
-            j=rand()%network[i].nports;
-            // Choose a different link if the link is already faulty or it is disconnected
-        } while (network[i].port[j].faulty==1 ||
-                network[i].port[j].neighbour.node==-1);
-        network[i].port[j].faulty=1;
-        network[network[i].port[j].neighbour.node].port[network[i].port[j].neighbour.port].faulty=1;
-#ifdef SHOWCONNECTIONS
-        printf("node %ld fails on port %ld\n",i,j);
-#endif
-    }
+    for(n=0; n<n_failures; n++)
+        fail_random_link(&i, &j);
 
 #ifdef DEBUG
     long c_failures;
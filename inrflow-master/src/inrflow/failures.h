@@ -1,6 +1,10 @@
 #ifndef _failures
 #define _failures
 
+long target_failures();
+
+void fail_random_link(long *node, long *port);
+
 void set_failures();
 
 long check_failures();
@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fair_share.h"
+#include "dynamic_engine.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FAIR_SHARE_X86
+#endif
+
+bw_kernel_t bw_kernel;  ///< Fair-share kernel requested.
+
+float (*fair_share)(const link_flow_t *dflows, long n, float comms, float stg);
+
+static bw_kernel_t kernel_used;     ///< Fair-share kernel selected by init_fair_share().
+
+/**
+ * Fair share of a flow.
+ *
+ * @return the bandwidth used by the flow, or 0 for the flows of the SAN.
+ */
+static inline float fair_share_flow(int f, float comms, float stg, int *used)
+{
+    float share;
+
+    if(flow_type[f] == 5 || flow_type[f] == 6){
+        *used = 0;
+        return(0);
+    }
+    share = (flow_type[f] == 0) ? comms : stg;
+    if(share < flow_speed[f])
+        flow_speed[f] = share;
+    *used = 1;
+    return(flow_speed[f]);
+}
+
+static float fair_share_scalar(const link_flow_t *dflows, long n, float comms, float stg)
+{
+    long k;
+    int used;
+    float speed;
+    float link_bw = 0.0;
+
+    for(k = 0; k < n; k++){
+        speed = fair_share_flow(dflows[k].flow, comms, stg, &used);
+        if(used)
+            link_bw += speed;
+    }
+    return(link_bw);
+}
+
+#ifdef FAIR_SHARE_X86
+
+/**
+ * 8 flows at a time. AVX2 has no scatter, so the speeds lowered are written back one by one.
+ */
+__attribute__((target("avx2")))
+static float fair_share_avx2(const link_flow_t *dflows, long n, float comms, float stg)
+{
+    const __m256i lanes = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);    // flow of every entry
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i san_read = _mm256_set1_epi32(5);
+    const __m256i san_write = _mm256_set1_epi32(6);
+    const __m256 v_comms = _mm256_set1_ps(comms);
+    const __m256 v_stg = _mm256_set1_ps(stg);
+    __m256i f, type, san;
+    __m256 speed, share, lower;
+    int flows[8];
+    float speeds[8];
+    int m_lower, m_used;
+    long k, l;
+    int used;
+    float link_bw = 0.0;
+
+    for(k = 0; k + 8 <= n; k += 8){
+        f = _mm256_i32gather_epi32((const int*)&dflows[k], lanes, 4);
+        type = _mm256_i32gather_epi32(flow_type, f, 4);
+        speed = _mm256_i32gather_ps(flow_speed, f, 4);
+        share = _mm256_blendv_ps(v_stg, v_comms, _mm256_castsi256_ps(_mm256_cmpeq_epi32(type, zero)));
+        san = _mm256_or_si256(_mm256_cmpeq_epi32(type, san_read), _mm256_cmpeq_epi32(type, san_write));
+        lower = _mm256_andnot_ps(_mm256_castsi256_ps(san), _mm256_cmp_ps(share, speed, _CMP_LT_OQ));
+        speed = _mm256_blendv_ps(speed, share, lower);
+        m_lower = _mm256_movemask_ps(lower);
+        m_used = ~_mm256_movemask_ps(_mm256_castsi256_ps(san)) & 0xff;
+        _mm256_storeu_si256((__m256i*)flows, f);
+        _mm256_storeu_ps(speeds, speed);
+        for(l = 0; l < 8; l++){
+            if(m_lower & (1 << l))
+                flow_speed[flows[l]] = speeds[l];
+            if(m_used & (1 << l))
+                link_bw += speeds[l];
+        }
+    }
+    for(; k < n; k++){
+        speeds[0] = fair_share_flow(dflows[k].flow, comms, stg, &used);
+        if(used)
+            link_bw += speeds[0];
+    }
+    return(link_bw);
+}
+
+/**
+ * 16 flows at a time, with masked scatters.
+ */
+__attribute__((target("avx512f")))
+static float fair_share_avx512(const link_flow_t *dflows, long n, float comms, float stg)
+{
+    const __m512i lanes = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i san_read = _mm512_set1_epi32(5);
+    const __m512i san_write = _mm512_set1_epi32(6);
+    const __m512 v_comms = _mm512_set1_ps(comms);
+    const __m512 v_stg = _mm512_set1_ps(stg);
+    __m512i f, type;
+    __m512 speed, share;
+    __mmask16 m_lower, m_used;
+    float speeds[16];
+    long k, l;
+    int used;
+    float link_bw = 0.0;
+
+    for(k = 0; k + 16 <= n; k += 16){
+        f = _mm512_i32gather_epi32(lanes, (const int*)&dflows[k], 4);
+        type = _mm512_i32gather_epi32(f, flow_type, 4);
+        speed = _mm512_i32gather_ps(f, flow_speed, 4);
+        share = _mm512_mask_blend_ps(_mm512_cmpeq_epi32_mask(type, zero), v_stg, v_comms);
+        m_used = ~(_mm512_cmpeq_epi32_mask(type, san_read) | _mm512_cmpeq_epi32_mask(type, san_write));
+        m_lower = _mm512_mask_cmp_ps_mask(m_used, share, speed, _CMP_LT_OQ);
+        speed = _mm512_mask_blend_ps(m_lower, speed, share);
+        _mm512_mask_i32scatter_ps(flow_speed, m_lower, f, speed, 4);
+        _mm512_storeu_ps(speeds, speed);
+        for(l = 0; l < 16; l++){
+            if(m_used & (1 << l))
+                link_bw += speeds[l];
+        }
+    }
+    for(; k < n; k++){
+        speeds[0] = fair_share_flow(dflows[k].flow, comms, stg, &used);
+        if(used)
+            link_bw += speeds[0];
+    }
+    return(link_bw);
+}
+
+#endif // FAIR_SHARE_X86
+
+/**
+ * Selects the fair-share kernel: the one requested with bw_kernel, or the scalar one.
+ */
+void init_fair_share()
+{
+    kernel_used = bw_kernel;
+    if(kernel_used == AUTO_BW_KERNEL)
+        kernel_used = SCALAR_BW_KERNEL;
+#ifdef FAIR_SHARE_X86
+    __builtin_cpu_init();
+    if((kernel_used == AVX512_BW_KERNEL && !__builtin_cpu_supports("avx512f")) ||
+       (kernel_used == AVX2_BW_KERNEL && !__builtin_cpu_supports("avx2"))){
+        printf("Error: The CPU does not support the %s bandwidth kernel.\n", fair_share_name());
+        exit(-1);
+    }
+#else
+    if(kernel_used != SCALAR_BW_KERNEL){
+        printf("Error: The %s bandwidth kernel is only available in x86 builds.\n", fair_share_name());
+        exit(-1);
+    }
+#endif
+    switch(kernel_used){
+#ifdef FAIR_SHARE_X86
+        case AVX512_BW_KERNEL:
+            fair_share = fair_share_avx512;
+            break;
+        case AVX2_BW_KERNEL:
+            fair_share = fair_share_avx2;
+            break;
+#endif
+        default:
+            fair_share = fair_share_scalar;
+            break;
+    }
+}
+
+const char *fair_share_name()
+{
+    switch(kernel_used){
+        case AVX512_BW_KERNEL:
+            return("avx512");
+        case AVX2_BW_KERNEL:
+            return("avx2");
+        case SCALAR_BW_KERNEL:
+            return("scalar");
+        default:
+            return("auto");
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef _fair_share
+#define _fair_share
+
+#include "node.h"
+
+/**
+ * Fair-share kernels of the dynamic-fast electric engine.
+ *
+ * A kernel lowers the speed of the flows of a port to their share of it and adds up the bandwidth
+ * they use, reading the speeds and types of the flows from flow_speed and flow_type
+ * (dynamic_engine.h). The vector kernels gather the flows of a port, compare and blend their
+ * speeds in vector registers and scatter back the lowered ones. The bandwidth used is added flow by
+ * flow, in the order of the port, so every kernel gives the same results, bit by bit, as the
+ * scalar one.
+ *
+ * The kernel is chosen at run time with bw_kernel=auto|scalar|avx2|avx512. auto takes the scalar
+ * one, as the vector kernels have not been measured faster.
+ */
+
+typedef enum bw_kernel_t {
+    AUTO_BW_KERNEL = 0,
+    SCALAR_BW_KERNEL,
+    AVX2_BW_KERNEL,
+    AVX512_BW_KERNEL
+} bw_kernel_t;
+
+extern bw_kernel_t bw_kernel;   ///< Fair-share kernel requested.
+
+/**
+ * Fair share of the n flows of a port: comms for the flows of type 0, and stg for the storage
+ * ones. The flows of the SAN (types 5 and 6) are left alone.
+ *
+ * @return the bandwidth used by the flows, but those of the SAN.
+ */
+extern float (*fair_share)(const link_flow_t *dflows, long n, float comms, float stg);
+
+void init_fair_share();
+
+const char *fair_share_name();
+
+#endif
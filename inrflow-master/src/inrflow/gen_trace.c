@@ -33,6 +33,7 @@ void insert_computation(application *app, long t_id, long computation)
     ev.subflows_aux = 0;
     ev.app = app;
     ev.type_flow = -1;
+    ev.flow = -1;
 
     if (computation>0)
         list_append(app->task_events[t_id], &ev);
@@ -61,18 +62,8 @@ void insert_send(application *app, long src, long dst, long tag, long size, int
     ev.total_subflows = 0;
     ev.subflows_aux = 0;
     ev.app = app;
-    ev.dflow.speed = FLT_MAX;
-    ev.dflow.san_link = -1;
-    ev.dflow.max_flows = 0;
-    ev.dflow.n_max_flows = 0;
-    ev.dflow.min_flows = INT_MAX;
-    ev.dflow.n_min_flows = 0;
-    if(mode == DYNAMIC_PHOTONIC)
-        ev.dflow.allocated = 0;
-    else
-        ev.dflow.allocated = 1;
-    ev.dflow.path = malloc(sizeof(list_t));
     ev.type_flow = type;
+    ev.flow = -1;
     //if(type == 1 || type == 3)
     //printf("S: (%ld --> %ld) %ld - %d\n", from, to, size,type);
     list_append(app->task_events[src], &ev);
@@ -101,9 +92,8 @@ void insert_recv(application *app, long src, long dst, long tag, long size, int
     ev.total_subflows = 0;
     ev.subflows_aux = 0;
     ev.app = app;
-    ev.dflow.speed = FLT_MAX;
-    ev.dflow.san_link = -1;
     ev.type_flow = type;
+    ev.flow = -1;
     //if(type == 0)
     //printf("R: (%ld --> %ld) %ld\n", from, to, size);
     list_append(app->task_events[dst], &ev);
@@ -31,6 +31,9 @@
 #include "misc.h"
 #include "globals.h"
 #include "literal.h"
+#include "profiler.h"
+#include "fair_share.h"
+#include "parallel_bandwidth.h"
 
 #ifdef WIN32
 #include <windows.h>
@@ -81,6 +84,14 @@ static literal_t options_l[] = {
     {26, "photonic_policies"},
     {27, "photonic_router"},
     {28, "flows_priority"},
+    {29, "analysis_threads"},
+    {30, "sweep_steps"},
+    {31, "results"},
+    {32, "profile_sample"},
+    {33, "profile_trace"},
+    {34, "bw_kernel"},
+    {35, "bandwidth_threads"},
+    {36, "coalesce_window"},
     LITERAL_END
 };
 
@@ -98,6 +109,18 @@ static literal_t bool_l[] = {
     LITERAL_END
 };
 
+/**
+ * Fair-share kernels of the dynamic-fast mode.
+ * @see literal.c
+ */
+static literal_t bw_kernel_l[] = {
+    { AUTO_BW_KERNEL,   "auto"},
+    { SCALAR_BW_KERNEL, "scalar"},
+    { AVX2_BW_KERNEL,   "avx2"},
+    { AVX512_BW_KERNEL, "avx512"},
+    LITERAL_END
+};
+
 /**
  * All the topologies allowed are specified here.
  * @see literal.c
@@ -302,6 +325,8 @@ literal_t applications_l[] = {
 
 literal_t scheduling_l[] = {
     { FCFS,  "fcfs"},
+    { EASY_BACKFILLING,  "easy"},
+    { CONSERVATIVE_BACKFILLING,  "conservative"},
     LITERAL_END
 };
 
@@ -336,6 +361,8 @@ literal_t rt_mode_l[] = {
     { DYNAMIC_ELECTRIC_FAST,  "dynamic-fast"},
     { DYNAMIC_ELECTRIC_ACCURATE,  "dynamic-accurate"},
     { DYNAMIC_PHOTONIC,  "dynamic-photonic"},
+    { TOPO_ANALYSIS,  "analysis"},
+    { FAILURE_SWEEP,  "failure-sweep"},
     LITERAL_END
 };
 
@@ -854,6 +881,37 @@ void get_option(char * option)
                 traffic_priority_params[i] = atoi(param);
             }
             break;
+        case 29:
+            sscanf(value, "%d", &analysis_threads);
+            break;
+        case 30:
+            sscanf(value, "%ld", &sweep_steps);
+            break;
+        case 31:
+            sscanf(value, "%s", results_file);
+            break;
+        case 32:
+            sscanf(value, "%ld", &profile_sample);
+            break;
+        case 33:
+            sscanf(value, "%s", profile_trace);
+            break;
+        case 34:
+            if(!literal_value(bw_kernel_l, value, (int *) &bw_kernel)) {
+                printf("Error: Unknown bandwidth kernel - %s.\n", value);
+                exit(-1);
+            }
+            break;
+        case 35:
+            sscanf(value, "%ld", &bandwidth_threads);
+            break;
+        case 36:
+            sscanf(value, "%lf", &coalesce_window);
+            if(coalesce_window < 0) {
+                printf("Error: The coalescing window cannot be negative - %s.\n", value);
+                exit(-1);
+            }
+            break;
         default:
             printf("Unknown parameter - %s\n", value);
             exit(0);
@@ -876,6 +934,10 @@ void verify_conf(void)
         printf("ERROR: Check photonic channels and lambdas assignment policies\n");
         exit(-1);
     }
+    if(mode == FAILURE_SWEEP && (sweep_steps <= 0 || n_failures == 0)){
+        printf("ERROR: A failure sweep needs a positive number of steps and failures (failure_rate or num_failures)\n");
+        exit(-1);
+    }
 }
 
 /**
@@ -890,11 +952,15 @@ void set_default_conf (void)
     topo=BCUBE;
     pattern=ALL2ALL;
     placement=SEQUENTIAL_PLC;
+    scheduling=FCFS;
+    scheduling_name="fcfs";
     failure_rate=0;
     n_failures=0;
+    sweep_steps=10;
     flow_inj_mode = 0;
     dmetrics_time = 0;
     verbose=0;
+    analysis_threads=0;
     load_balancing=1;
     server_cores = 1;
     server_memory = 1000;
@@ -918,4 +984,10 @@ void set_default_conf (void)
     traffic_priority = FTP_TRAFFIC_PRIORITY;
     traffic_priority_nparams = 0;
     snprintf(output_dir,200, ".");
+    results_file[0] = '\0';
+    profile_sample = 1024;
+    profile_trace[0] = '\0';
+    bw_kernel = AUTO_BW_KERNEL;
+    bandwidth_threads = 1;
+    coalesce_window = 0;
 }
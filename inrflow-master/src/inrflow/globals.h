@@ -59,6 +59,7 @@ extern long allocation_nparam;
 extern long allocation_params[];
 extern char* allocation_name;
 extern long n_failures;
+extern long sweep_steps;
 extern float failure_rate;
 extern long r_seed;
 extern long out_net_struc;
@@ -69,6 +70,7 @@ extern list_t running_applications;
 extern applications_t applications_type;
 extern char applications_file[200];
 extern char output_dir[200];
+extern char results_file[200];
 extern routing_t routing;
 extern tpattern_t pattern;
 extern placement_t placement;
@@ -79,6 +81,8 @@ extern char* traffic_name;
 extern metrics_t metrics;
 extern int n_channels;
 extern int n_lambdas;
+extern int channel_words;
+extern int lambda_words;
 extern long channel_bandwidth;
 extern channel_assignment_policy_t channel_assign_pol;
 extern lambda_assignment_policy_t lambda_assign_pol;
@@ -104,7 +108,9 @@ extern int compile_latex;
 extern int mode;
 extern int flow_inj_mode;
 extern int dmetrics_time;
+extern double coalesce_window;
 extern int verbose;
+extern int analysis_threads;
 extern int load_balancing;
 
 extern long server_cores;
@@ -135,14 +141,6 @@ extern literal_t global_connection_l[];
 extern literal_t channel_assignment_policy_l[];
 extern literal_t lambda_assignment_policy_l[];
 
-#ifdef MEASURE_ROUTING_TIME
-extern long long total_prerouting_time;  ///< stores the aggregated prerouting time.
-extern long prerouting_count;              ///< stores how many times we have prerouted.
-
-extern long long total_hoprouting_time;  ///< stores the aggregated hoprouting time.
-extern long hoprouting_count;              ///< stores how many times we have hoprouted.
-#endif
-
 extern long dmetrics_step;
 extern float agg_bw;
 extern long steps;
@@ -165,5 +163,6 @@ void get_conf(long, char **);
 void print_coordinates(long node, long port);
 
 void run_static();
+void run_failure_sweep();
 
 #endif
@@ -348,6 +348,31 @@ void list_concat(list_t *l1, list_t *l2)
     }
 }
 
+/*
+ * Moves the last element returned by list_next to the head of the list. The iteration
+ * continues from the element that followed it.
+ */
+void list_current_to_head(list_t *l)
+{
+    node_list *node;
+
+    node = l->rem_current;
+    if(node == NULL || node == l->head){
+        return;
+    }
+    node->prev->next = node->next;
+    if(node == l->tail){
+        l->tail = node->prev;
+    }
+    else{
+        node->next->prev = node->prev;
+    }
+    node->prev = NULL;
+    node->next = l->head;
+    l->head->prev = node;
+    l->head = node;
+}
+
 /*
  * Remove a node from the list.
  */
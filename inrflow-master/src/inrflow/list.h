@@ -59,6 +59,8 @@ void list_rem_elem(list_t *l);
 
 void list_rem_head_append(list_t *sl, list_t *dl);
 
+void list_current_to_head(list_t *l);
+
 void list_rem_node(list_t *li, node_list *node);
 
 void list_get_i(list_t *l, long num, void **elem);
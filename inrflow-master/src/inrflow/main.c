@@ -40,10 +40,15 @@
 #include "failures.h"
 #include "io.h"
 #include "list.h"
+#include "topo_analysis.h"
+#include "profiler.h"
+#include "fair_share.h"
+#include "parallel_bandwidth.h"
 
 long r_seed;    ///< Random seed
 int bfs_output; ///< Generate a bfs file with the topology? 0:no, other:yes
 int mode; ///< Runtime mode: static or dynamic.
+int analysis_threads; ///< Threads used in the analysis mode, 0 means one per online core.
 
 /**
  * Main function.
@@ -58,6 +63,8 @@ int mode; ///< Runtime mode: static or dynamic.
  */
 int main(int argc, char **argv){
 
+    long threads;
+
 #ifdef DEBUG
     printf("DEBUG flag is on.\n");
 #endif
@@ -70,6 +77,8 @@ int main(int argc, char **argv){
         case STATIC:
         case DYNAMIC_ELECTRIC_FAST:
         case DYNAMIC_ELECTRIC_ACCURATE:
+        case TOPO_ANALYSIS:
+        case FAILURE_SWEEP:
             construct_network_electric();
             break;
         case DYNAMIC_PHOTONIC:
@@ -82,11 +91,13 @@ int main(int argc, char **argv){
 
     reset_network();
 
-    set_failures();
+    if (mode != FAILURE_SWEEP) // failures are added progressively during the sweep
+        set_failures();
 
     if (bfs_output!=0)
         generate_bfs_file();
 
+    prof_init();
     switch(mode){
         case STATIC:
             init_patterns();
@@ -97,7 +108,17 @@ int main(int argc, char **argv){
             insert_new_events = insert_new_events_electric;
             remove_flow = remove_flow_electric;
             min_links_bandwidth = min_links_bandwidth_fast_electric;
+            init_fair_share();
+            threads = init_parallel_bandwidth();
+            if(threads > 1){
+                min_links_bandwidth = min_links_bandwidth_fast_parallel;
+                printf("Bandwidth threads: %ld\n", threads);
+            }
+            else{
+                printf("Bandwidth kernel: %s\n", fair_share_name());
+            }
             run_dynamic();
+            finish_parallel_bandwidth();
             break;
         case DYNAMIC_ELECTRIC_ACCURATE:
             time_next_event = time_next_event_electric;
@@ -112,32 +133,36 @@ int main(int argc, char **argv){
             insert_new_events = insert_new_events_photonic;
             remove_flow = remove_flow_photonic;
             min_links_bandwidth = min_links_bandwidth_photonic;
-            if(channel_assign_pol == STATIC_CHANNEL_ASSIGN &&
-                    lambda_assign_pol == STATIC_LAMBDA_ASSIGN)
-                explore_route = explore_route_static_static;
-            else if(channel_assign_pol == ADAPTIVE_CHANNEL_ASSIGN &&
-                  lambda_assign_pol == STATIC_LAMBDA_ASSIGN)
-              explore_route = explore_route_adaptive_static;
-            else if(channel_assign_pol == STATIC_CHANNEL_ASSIGN &&
-                  lambda_assign_pol == ADAPTIVE_LAMBDA_ASSIGN)
-              explore_route = explore_route_adaptive_static;
-            else if(channel_assign_pol == ADAPTIVE_CHANNEL_ASSIGN &&
-                  lambda_assign_pol == ADAPTIVE_LAMBDA_ASSIGN)
-              explore_route = explore_route_adaptive_static;
+            // The lambda policy is applied when reserving the channel of every hop.
+            if(channel_assign_pol == STATIC_CHANNEL_ASSIGN)
+                explore_route = explore_route_static_channel;
+            else
+                explore_route = explore_route_adaptive_channel;
             run_dynamic();
             break;
+        case TOPO_ANALYSIS:
+            run_topo_analysis();
+            break;
+        case FAILURE_SWEEP:
+            init_patterns();
+            run_failure_sweep();
+            break;
         default:
             printf("Execution mode not defined.\n");
             exit(-1);
     }
+    prof_finish();
     finish_topo();
 switch(mode){
         case STATIC:
         case DYNAMIC_ELECTRIC_FAST:
         case DYNAMIC_ELECTRIC_ACCURATE:
+        case TOPO_ANALYSIS:
+        case FAILURE_SWEEP:
             release_network_electric();
             break;
         case DYNAMIC_PHOTONIC:
+            finish_photonic();
             release_network_photonic();
             break;
         default:
@@ -21,6 +21,10 @@ void init_metrics(struct metrics_t *metrics){
     metrics->scheduling.avg_total_time = 0.0;
     metrics->scheduling.utilization = 0.0;
     metrics->scheduling.utilization_if = 0.0;
+    metrics->scheduling.max_wait = 0.0;
+    metrics->scheduling.sum_slowdown = 0.0;
+    metrics->scheduling.max_slowdown = 0.0;
+    metrics->scheduling.backfilled = 0;
 
     //Applications metrics
     metrics->applications.n_apps = 0;
@@ -34,7 +38,11 @@ void init_metrics(struct metrics_t *metrics){
     metrics->execution.avg_agg_bw = 0.0;
     metrics->execution.n_steps = 0;
     metrics->execution.links_info = NULL;
+    metrics->execution.coalesced_events = 0;
+    metrics->execution.coalesce_error = 0.0;
+    metrics->execution.max_coalesce_error = 0.0;
     list_initialize(&metrics->execution.agg_bw, sizeof(float));
+    list_initialize(&metrics->execution.utilization, sizeof(float));
 }
 
 void init_metrics_application(struct app_metrics *info){
@@ -77,6 +85,15 @@ double get_makespan(struct metrics_t *metrics){
     return( metrics->scheduling.makespan);
 }
 
+/**
+ * Mean time the events retired by the coalescing window were retired in advance.
+ */
+double mean_coalesce_error(struct metrics_t *metrics){
+    if(metrics->execution.coalesced_events == 0)
+        return(0.0);
+    return(metrics->execution.coalesce_error / metrics->execution.coalesced_events);
+}
+
 void report_metrics(struct metrics_t *metrics){
 
     long i, j;
@@ -107,6 +124,11 @@ void report_metrics(struct metrics_t *metrics){
     fprintf(fd_sched,"Average total time:   %.5f\n", metrics->scheduling.avg_total_time / (double)metrics->applications.n_apps);
     fprintf(fd_sched,"Utilization:          %.5f\n", metrics->scheduling.utilization / metrics->scheduling.makespan);
     fprintf(fd_sched,"Utilization-if:       %.5f\n", metrics->scheduling.utilization_if / metrics->scheduling.makespan);
+    fprintf(fd_sched,"Scheduling policy:    %s\n", scheduling_name);
+    fprintf(fd_sched,"Max wait time:        %.5f\n", metrics->scheduling.max_wait);
+    fprintf(fd_sched,"Mean slowdown:        %.5f\n", metrics->scheduling.sum_slowdown / (double)metrics->applications.n_apps);
+    fprintf(fd_sched,"Max slowdown:         %.5f\n", metrics->scheduling.max_slowdown);
+    fprintf(fd_sched,"Backfilled apps:      %ld\n", metrics->scheduling.backfilled);
     fclose(fd_sched);
 
     if((fd_applications = fopen(applications_filename, "w")) == NULL){
@@ -193,11 +215,24 @@ void report_metrics(struct metrics_t *metrics){
     }
     fprintf(fd_execution,"\n");
     free(metrics->execution.links_info);
-    fprintf(fd_execution,"Dynamics aggregated bandwith: ");
-    while(list_length(&metrics->execution.agg_bw) > 0){
-        list_head(&metrics->execution.agg_bw, (void*)&agg_bw);
-        fprintf(fd_execution, "%.5f ", *agg_bw);
-        list_rem_head(&metrics->execution.agg_bw);
+    if(coalesce_window > 0){ // events retired early, so the times above are approximate
+        fprintf(fd_execution,"Coalescing window:            %g\n", coalesce_window);
+        fprintf(fd_execution,"Coalesced events:             %ld\n", metrics->execution.coalesced_events);
+        fprintf(fd_execution,"Coalescing error (mean/max):  %g %g\n", mean_coalesce_error(metrics), metrics->execution.max_coalesce_error);
+    }
+    if(dmetrics_time > 0){ // only sampled with metricsint
+        fprintf(fd_execution,"Dynamics aggregated bandwith: ");
+        while(list_length(&metrics->execution.agg_bw) > 0){
+            list_head(&metrics->execution.agg_bw, (void*)&agg_bw);
+            fprintf(fd_execution, "%.5f ", *agg_bw);
+            list_rem_head(&metrics->execution.agg_bw);
+        }
+        fprintf(fd_execution,"\nDynamics utilization:         ");
+        while(list_length(&metrics->execution.utilization) > 0){
+            list_head(&metrics->execution.utilization, (void*)&agg_bw);
+            fprintf(fd_execution, "%.5f ", *agg_bw);
+            list_rem_head(&metrics->execution.utilization);
+        }
     }
     fclose(fd_execution);
 
@@ -222,7 +257,7 @@ void update_metrics(struct metrics_t *metrics){
     for(i=0; i<servers+switches; i++) {
         network[i].nports=get_radix(i);
         for(j=0; j<network[i].nports; j++) {
-            metrics->execution.links_info[network[i].port[j].link_info[0]]++;
+            metrics->execution.links_info[network[i].port[j].link_shared]++;
 
         }
     }
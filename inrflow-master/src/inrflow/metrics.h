@@ -9,7 +9,10 @@ typedef struct scheduling_metrics{
     double avg_total_time;
     float utilization;
     float utilization_if;
-
+    double max_wait;
+    double sum_slowdown;    ///< aggregated slowdown: (waiting time + runtime) / runtime
+    double max_slowdown;
+    long backfilled;        ///< applications started ahead of an older one
 
 } scheduling_metric;
 
@@ -65,7 +68,8 @@ typedef struct execution_metrics{
     double avg_latency;
     float avg_agg_bw;
     long n_steps;
-    list_t agg_bw;
+    list_t agg_bw;          ///< Mean bandwidth used in every interval of dmetrics_time.
+    list_t utilization;     ///< Mean utilization of the links in use in every interval of dmetrics_time.
     long *links_info;
     double avg_active_flows;
     double avg_injected_flows;
@@ -73,6 +77,9 @@ typedef struct execution_metrics{
     double avg_bandwidth;
     double max_bandwidth;
     double min_bandwidth;
+    long coalesced_events;      ///< Events retired before their time by the coalescing window.
+    double coalesce_error;      ///< Time they were retired in advance, in total.
+    double max_coalesce_error;  ///< Time the event retired earliest was retired in advance.
 
 } execution_metrics;
 
@@ -90,6 +97,8 @@ double get_makespan(struct metrics_t *metrics);
 
 void set_makespan(struct metrics_t *metrics, double makespan);
 
+double mean_coalesce_error(struct metrics_t *metrics);
+
 void update_metrics(struct metrics_t *metrics);
 
 void update_flows_distance(struct app_metrics *info, long path_length, int type);
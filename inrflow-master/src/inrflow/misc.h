@@ -214,7 +214,9 @@ typedef enum applications_t{
 } applications_t;
 
 typedef enum scheduling_t{
-    FCFS
+    FCFS,
+    EASY_BACKFILLING,
+    CONSERVATIVE_BACKFILLING
 } scheduling_t;
 
 typedef enum allocation_t{
@@ -244,7 +246,9 @@ typedef enum rt_mode_t{
     STATIC,
     DYNAMIC_ELECTRIC_FAST,
     DYNAMIC_ELECTRIC_ACCURATE,
-    DYNAMIC_PHOTONIC
+    DYNAMIC_PHOTONIC,
+    TOPO_ANALYSIS,
+    FAILURE_SWEEP
 } rt_mode_t;
 
 typedef enum storage_t{
@@ -320,8 +324,6 @@ typedef enum traffic_priority_t{
 #define UPPER_SERVER_HOPS 1000
 #endif
 
-//#define MEASURE_ROUTING_TIME
-
 #ifndef CLOCK_MODE
 //#define CLOCK_MODE CLOCK_REALTIME
 #define CLOCK_MODE CLOCK_MONOTONIC
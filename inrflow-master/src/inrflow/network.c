@@ -62,7 +62,7 @@ void check_network_consistency()
  */
 void construct_network_electric()
 {
-    long i,j,k; // node, port
+    long i,j; // node, port
     tuple_t dst;
 
     printf("Constructing electric Network\n");
@@ -81,10 +81,8 @@ void construct_network_electric()
             network[i].port[j].neighbour.node=-1;
             network[i].port[j].neighbour.port=-1;
             network[i].port[j].bandwidth_capacity=0;
-            for(k=0; k < MAX_CONCURRENT_APPS + 1;k++){
-                network[i].port[j].link_info[k] = 0;
-                network[i].port[j].link_info_apps[k] = 0;
-            }
+            init_link_apps(&network[i].port[j]);
+            init_port_flows(&network[i].port[j]);
 
         }
     }
@@ -101,7 +99,6 @@ void construct_network_electric()
                 network[i].port[j].neighbour=dst;
                 //network[dst.node].port[dst.port].neighbour.node=i;
                 //network[dst.node].port[dst.port].neighbour.port=j;
-                list_initialize(&network[i].port[j].dflows, sizeof(dflow_t*));
                 if (topo==EXATORUS){
                     if (i<servers){
                         if (j==0) //CRDBs
@@ -197,6 +194,9 @@ void construct_network_photonic()
 
     printf("Constructing photonic Network\n");
 
+    channel_words = (n_channels + 63) / 64;
+    lambda_words = (n_lambdas + 63) / 64;
+
     servers=get_servers();
     switches=get_switches();
     ports=get_ports();
@@ -212,17 +212,19 @@ void construct_network_photonic()
             network[i].port[j].neighbour.node=-1;
             network[i].port[j].neighbour.port=-1;
             network[i].port[j].bandwidth_capacity=0;
-            for(k=0; k < MAX_CONCURRENT_APPS + 1;k++){
-                network[i].port[j].link_info[k] = 0;
-                network[i].port[j].link_info_apps[k] = 0;
-            }
+            init_link_apps(&network[i].port[j]);
+            init_port_flows(&network[i].port[j]);
             network[i].opt_port[j].n_channels = n_channels;
             network[i].opt_port[j].channel_bandwidth = channel_bandwidth;
             network[i].opt_port[j].channels = malloc(n_channels * sizeof(opt_channel_t));
+            network[i].opt_port[j].channel_used = calloc(channel_words, sizeof(uint64_t));
+            network[i].opt_port[j].channel_full = calloc(channel_words, sizeof(uint64_t));
+            network[i].opt_port[j].reserved_bandwidth = 0;
             for(k=0; k < n_channels; k++){
                 network[i].opt_port[j].channels[k].flows = 0;
                 network[i].opt_port[j].channels[k].n_lambdas = n_lambdas;
                 network[i].opt_port[j].channels[k].lambda_bandwidth = (channel_bandwidth / n_lambdas);
+                network[i].opt_port[j].channels[k].lambda_busy = calloc(lambda_words, sizeof(uint64_t));
             }
 
         }
@@ -240,7 +242,6 @@ void construct_network_photonic()
                 network[i].port[j].neighbour=dst;
                 network[dst.node].port[dst.port].neighbour.node=i;
                 network[dst.node].port[dst.port].neighbour.port=j;
-                list_initialize(&network[i].port[j].dflows, sizeof(dflow_t*));
                 if(is_server(i)){
                     network[i].port[j].bandwidth_capacity = (channel_bandwidth * n_channels);
                 }
@@ -264,9 +265,13 @@ void construct_network_photonic()
 
 void release_network_electric(){
 
-    long i;
+    long i, j;
 
     for(i=0; i<servers+switches; i++) {
+        for(j=0; j<network[i].nports; j++) {
+            release_link_apps(&network[i].port[j]);
+            release_port_flows(&network[i].port[j]);
+        }
         free(network[i].port);
     }
     free(network);
@@ -274,11 +279,18 @@ void release_network_electric(){
 
 void release_network_photonic(){
 
-    long i, j;
+    long i, j, k;
 
     for(i=0; i<servers+switches; i++) {
         for(j=0; j<network[i].nports; j++) {
+            for(k=0; k < network[i].opt_port[j].n_channels; k++){
+                free(network[i].opt_port[j].channels[k].lambda_busy);
+            }
             free(network[i].opt_port[j].channels);
+            free(network[i].opt_port[j].channel_used);
+            free(network[i].opt_port[j].channel_full);
+            release_link_apps(&network[i].port[j]);
+            release_port_flows(&network[i].port[j]);
         }
         free(network[i].opt_port);
         free(network[i].port);
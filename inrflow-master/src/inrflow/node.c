@@ -1,5 +1,9 @@
 #include "node.h"
 #include "globals.h"
+#include "applications.h"
+#include "dynamic_engine.h"
+
+#include <stdlib.h>
 
 void set_bandwidth_capacity(port_t *port, long bandwidth_capacity){
 
@@ -11,3 +15,146 @@ long get_bandwidth_capacity(long node, long port){
 
 }
 
+
+void init_link_apps(port_t *port){
+
+    port->link_shared = 0;
+    port->link_last_app = 0;
+    port->n_link_apps = 0;
+    port->max_link_apps = 0;
+    port->link_apps = NULL;
+}
+
+void release_link_apps(port_t *port){
+
+    free(port->link_apps);
+    init_link_apps(port);
+}
+
+/**
+ * Looks for the entry of an application in a port. Entries of applications that are not running
+ * anymore are removed on the way, so the memory used by a link is proportional to the number of
+ * applications currently sharing it.
+ *
+ * @return the entry of the application, or NULL if it has not used the link.
+ */
+static link_app_t *find_link_app(port_t *port, long app_id){
+
+    long i = 0;
+    link_app_t *entry = NULL;
+
+    while(i < port->n_link_apps){
+        if(port->link_apps[i].app_id == app_id){
+            entry = &port->link_apps[i];
+            i++;
+        }
+        else if(port->link_apps[i].active == 0 && !is_running(port->link_apps[i].app_id)){
+            port->link_apps[i] = port->link_apps[--port->n_link_apps];
+        }
+        else{
+            i++;
+        }
+    }
+    return(entry);
+}
+
+/**
+ * Accounts a new flow of an application through a port.
+ *
+ * @return the last application that started using the link.
+ */
+long add_link_app_flow(port_t *port, long app_id){
+
+    long i;
+    long apps_running = 0;
+    link_app_t *entry;
+
+    entry = find_link_app(port, app_id);
+    if(entry == NULL){
+        if(port->n_link_apps == port->max_link_apps){
+            port->max_link_apps = (port->max_link_apps == 0) ? 2 : 2 * port->max_link_apps;
+            port->link_apps = realloc(port->link_apps, port->max_link_apps * sizeof(link_app_t));
+        }
+        entry = &port->link_apps[port->n_link_apps++];
+        entry->app_id = app_id;
+        entry->flows = 0;
+        entry->active = 0;
+    }
+    if(entry->flows == 0){
+        for(i = 0; i < port->n_link_apps; i++){
+            if(port->link_apps[i].app_id != app_id && port->link_apps[i].flows > 0 && is_running(port->link_apps[i].app_id)){
+                apps_running++;
+            }
+        }
+        port->link_shared = apps_running + 1;
+    }
+    entry->flows++;
+    if(entry->active == 0){
+        port->link_last_app = app_id;
+    }
+    entry->active++;
+    return(port->link_last_app);
+}
+
+/**
+ * Removes a flow of an application from a port.
+ *
+ * @return the last application that started using the link.
+ */
+long remove_link_app_flow(port_t *port, long app_id){
+
+    link_app_t *entry;
+
+    entry = find_link_app(port, app_id);
+    if(entry != NULL){
+        entry->active--;
+        if(entry->active == 0){
+            port->link_last_app = 0;
+        }
+    }
+    return(port->link_last_app);
+}
+
+void init_port_flows(port_t *port){
+
+    port->n_dflows = 0;
+    port->max_dflows = 0;
+    port->dflows = NULL;
+}
+
+void release_port_flows(port_t *port){
+
+    free(port->dflows);
+    init_port_flows(port);
+}
+
+/**
+ * Adds a flow to a port, as the given hop of its route.
+ *
+ * @return the slot of the flow in the port, to remove it later.
+ */
+int add_port_flow(port_t *port, long flow, long hop){
+
+    if(port->n_dflows == port->max_dflows){
+        port->max_dflows = (port->max_dflows == 0) ? 4 : 2 * port->max_dflows;
+        port->dflows = realloc(port->dflows, port->max_dflows * sizeof(link_flow_t));
+    }
+    port->dflows[port->n_dflows].flow = flow;
+    port->dflows[port->n_dflows].hop = hop;
+    return(port->n_dflows++);
+}
+
+/**
+ * Removes the flow in a slot of a port. The last flow of the port takes its slot, and the hop of
+ * its route is updated to point to it.
+ */
+void remove_port_flow(port_t *port, long slot){
+
+    link_flow_t *last;
+
+    last = &port->dflows[--port->n_dflows];
+    if(slot != port->n_dflows){
+        port->dflows[slot] = *last;
+        get_flow(last->flow)->path[last->hop].slot = slot;
+    }
+}
@@ -3,8 +3,7 @@
 
 #include "list.h"
 
-// Define the maximum number of applications to execute and therefore, the maximum number of concurrent applications.  
-#define MAX_CONCURRENT_APPS 1
+#include <stdint.h>
 
 /**
  * Structure that defines a port/link location.
@@ -19,6 +18,7 @@ typedef struct opt_channel_t{
     long flows;    
     int n_lambdas;
     long lambda_bandwidth;
+    uint64_t *lambda_busy;	///< bit l is set if lambda l is reserved by a lightpath.
 } opt_channel_t;
 
 typedef struct opt_port_t {
@@ -26,8 +26,28 @@ typedef struct opt_port_t {
     int n_channels;
     opt_channel_t *channels;
     long channel_bandwidth;
+    uint64_t *channel_used;	///< bit c is set if any lambda of channel c is reserved.
+    uint64_t *channel_full;	///< bit c is set if all the lambdas of channel c are reserved.
+    long reserved_bandwidth;	///< bandwidth reserved by the lightpaths going through the port.
 } opt_port_t;
 
+/**
+ * Usage of a link by an application. Ports only keep entries for the applications using them.
+ */
+typedef struct link_app_t {
+    long app_id;    ///< the application.
+    long flows;     ///< flows of the application that have been routed through the link.
+    long active;    ///< flows of the application currently using the link.
+} link_app_t;
+
+/**
+ * A flow using a link: the flow, in the flow table, and the hop of its route the link is.
+ */
+typedef struct link_flow_t {
+    int flow;   ///< the flow.
+    int hop;    ///< the hop of its route.
+} link_flow_t;
+
 /**
  * Structure that defines a port/link.
  */
@@ -38,10 +58,15 @@ typedef struct port_t {
     long flows_storage_read_fault;	///< the number of flows that use this specific port.
     long flows_storage_write;	///< the number of flows that use this specific port.
     long flows_storage_write_fault;	///< the number of flows that use this specific port.
-    long link_info[MAX_CONCURRENT_APPS + 1]; 
-    long link_info_apps[MAX_CONCURRENT_APPS + 1]; 
+    long link_shared;	///< running applications sharing the link when it was last taken by a new application.
+    long link_last_app;	///< last application that started using the link (0 once released).
+    int n_link_apps;	///< number of entries in link_apps.
+    int max_link_apps;	///< number of allocated entries in link_apps.
+    link_app_t *link_apps;	///< per-application usage of the link, allocated on demand.
     long bandwidth_capacity;
-    list_t dflows;
+    int n_dflows;	///< number of entries in dflows.
+    int max_dflows;	///< number of allocated entries in dflows.
+    link_flow_t *dflows;	///< flows using the link, in no particular order, allocated on demand.
     tuple_t neighbour;	///< the node & port it is connected to (-1 means not connected).
 } port_t;
 
@@ -61,4 +86,20 @@ void set_bandwidth_capacity(port_t *port, long bandwidth_capacity);
 
 long get_bandwidth_capacity(long node, long port);
 
+void init_link_apps(port_t *port);
+
+void release_link_apps(port_t *port);
+
+void init_port_flows(port_t *port);
+
+void release_port_flows(port_t *port);
+
+int add_port_flow(port_t *port, long flow, long hop);
+
+void remove_port_flow(port_t *port, long slot);
+
+long add_link_app_flow(port_t *port, long app_id);
+
+long remove_link_app_flow(port_t *port, long app_id);
+
 #endif //_node
@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <float.h>
+#include <math.h>
+
+#include "parallel_bandwidth.h"
+#include "dynamic_engine.h"
+#include "electric_engine.h"
+#include "metrics.h"
+#include "globals.h"
+
+extern long servers; ///< The total number of servers
+extern long switches;///< The total number of switches
+
+long bandwidth_threads;    ///< Threads solving the bandwidth, 0 means one per online core.
+
+static long n_threads = 1;          ///< Threads started, counting the caller.
+static pthread_t *tids;
+static pthread_barrier_t barrier;   ///< Start and end of every pass.
+static int quit;                    ///< Whether the threads have to finish.
+
+static long *port_offset;           ///< Index of the first port of every node.
+static long *first_node;            ///< First node of the ports of every thread, and all the nodes at the end.
+static float *port_comms;           ///< Share of every port for the flows of comms.
+static float *port_stg;             ///< Share of every port for the storage flows.
+static float *port_bw;              ///< Bandwidth used in every port.
+
+/**
+ * A hop of a flow, by port.
+ */
+typedef struct hop_port_t {
+    long port;  ///< Index of the port, as in port_offset.
+    long hop;   ///< Hop of the route.
+} hop_port_t;
+
+static hop_port_t **hop_ports;      ///< Hops of the flow being solved by every thread, sorted by port.
+static long *max_hop_ports;         ///< Hops allocated for every thread.
+
+/**
+ * Whether a port is used by any flow. Others are not in the statistics of the links.
+ */
+static inline int port_used(long i, long j)
+{
+    return(network[i].port[j].neighbour.node != -1 && network[i].port[j].neighbour.port != -1 && network[i].port[j].flows != 0);
+}
+
+/**
+ * Pass 1: shares of the ports of thread t.
+ */
+static void solve_shares(long t)
+{
+    long i, j, p;
+
+    for(i = first_node[t]; i < first_node[t + 1]; i++){
+        for(j = 0; j < network[i].nports; j++){
+            p = port_offset[i] + j;
+            if(port_used(i, j)){
+                port_shares_electric(&network[i].port[j], &port_comms[p], &port_stg[p]);
+            }
+            else{
+                port_comms[p] = INFINITY;
+                port_stg[p] = INFINITY;
+            }
+        }
+    }
+}
+
+/**
+ * Pass 2: speeds of the flows in use of thread t in every hop of their route. Flows of the SAN
+ * (types 5 and 6) are left alone.
+ *
+ * The hops of a flow are sorted by port, so the speed in every hop is the running minimum of the
+ * shares, as the serial solver lowers it port by port. Routes are short, and usually in port
+ * order already, so they are sorted by insertion.
+ */
+static void solve_flows(long t)
+{
+    long i, f, h, k, p;
+    dflow_t *flow;
+    hop_port_t *hops;
+    float share, speed;
+
+    for(i = (n_active_flows * t) / n_threads; i < (n_active_flows * (t + 1)) / n_threads; i++){
+        f = active_flows[i];
+        flow = get_flow(f);
+        if(flow->path_length == 0 || flow_type[f] == 5 || flow_type[f] == 6)
+            continue;
+        if(flow->path_length > max_hop_ports[t]){
+            max_hop_ports[t] = flow->path_length;
+            hop_ports[t] = realloc(hop_ports[t], max_hop_ports[t] * sizeof(hop_port_t));
+        }
+        hops = hop_ports[t];
+        for(h = 0; h < flow->path_length; h++){
+            p = port_offset[flow->path[h].node] + flow->path[h].port;
+            for(k = h; k > 0 && hops[k - 1].port > p; k--)
+                hops[k] = hops[k - 1];
+            hops[k].port = p;
+            hops[k].hop = h;
+        }
+        speed = flow_speed[f];
+        for(k = 0; k < flow->path_length; k++){
+            share = (flow_type[f] == 0) ? port_comms[hops[k].port] : port_stg[hops[k].port];
+            if(share < speed)
+                speed = share;
+            flow->path[hops[k].hop].speed = speed;
+        }
+        flow_speed[f] = speed;
+    }
+}
+
+/**
+ * Pass 3: bandwidth used in the ports of thread t.
+ */
+static void solve_ports(long t)
+{
+    long i, j, k;
+    link_flow_t *dflow;
+    float link_bw;
+
+    for(i = first_node[t]; i < first_node[t + 1]; i++){
+        for(j = 0; j < network[i].nports; j++){
+            if(!port_used(i, j))
+                continue;
+            link_bw = 0;
+            for(k = 0; k < network[i].port[j].n_dflows; k++){
+                dflow = &network[i].port[j].dflows[k];
+                if(flow_type[dflow->flow] != 5 && flow_type[dflow->flow] != 6)
+                    link_bw += get_flow(dflow->flow)->path[dflow->hop].speed;
+            }
+            port_bw[port_offset[i] + j] = link_bw;
+        }
+    }
+}
+
+static void solve(long t)
+{
+    solve_shares(t);
+    pthread_barrier_wait(&barrier);
+    solve_flows(t);
+    pthread_barrier_wait(&barrier);
+    solve_ports(t);
+}
+
+static void *bandwidth_worker(void *arg)
+{
+    long t = (long)arg;
+
+    while(1){
+        pthread_barrier_wait(&barrier);
+        if(quit)
+            break;
+        solve(t);
+        pthread_barrier_wait(&barrier);
+    }
+    return(NULL);
+}
+
+/**
+ * Starts the threads solving the bandwidth, if more than one is requested. The ports are split
+ * among the threads by whole nodes, with about the same number of ports each. Requesting more
+ * threads than online cores falls back to the serial solver, as they would only wait for each
+ * other in the barriers.
+ *
+ * @return the number of threads solving the bandwidth.
+ */
+long init_parallel_bandwidth()
+{
+    long i, t, nodes = servers + switches;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    n_threads = bandwidth_threads;
+    if(n_threads <= 0)
+        n_threads = cores;
+    if(n_threads > cores){
+        printf("WARNING: %ld bandwidth threads requested, but only %ld cores are online. Solving the bandwidth serially.\n", n_threads, cores);
+        n_threads = 1;
+    }
+    if(n_threads > nodes)
+        n_threads = nodes;
+    if(n_threads <= 1){
+        n_threads = 1;
+        return(n_threads);
+    }
+
+    port_offset = malloc((nodes + 1) * sizeof(long));
+    port_offset[0] = 0;
+    for(i = 0; i < nodes; i++)
+        port_offset[i + 1] = port_offset[i] + network[i].nports;
+    first_node = malloc((n_threads + 1) * sizeof(long));
+    first_node[0] = 0;
+    for(i = 0, t = 1; t < n_threads; t++){
+        while(i < nodes && port_offset[i] < (port_offset[nodes] * t) / n_threads)
+            i++;
+        first_node[t] = i;
+    }
+    first_node[n_threads] = nodes;
+    port_comms = malloc(port_offset[nodes] * sizeof(float));
+    port_stg = malloc(port_offset[nodes] * sizeof(float));
+    port_bw = malloc(port_offset[nodes] * sizeof(float));
+    hop_ports = calloc(n_threads, sizeof(hop_port_t*));
+    max_hop_ports = calloc(n_threads, sizeof(long));
+
+    quit = 0;
+    pthread_barrier_init(&barrier, NULL, n_threads);
+    tids = malloc(n_threads * sizeof(pthread_t));
+    for(t = 1; t < n_threads; t++){
+        if(pthread_create(&tids[t], NULL, bandwidth_worker, (void*)t) != 0){
+            perror("Unable to create bandwidth thread");
+            exit(-1);
+        }
+    }
+    return(n_threads);
+}
+
+void finish_parallel_bandwidth()
+{
+    long t;
+
+    if(n_threads <= 1)
+        return;
+    quit = 1;
+    pthread_barrier_wait(&barrier);
+    for(t = 1; t < n_threads; t++)
+        pthread_join(tids[t], NULL);
+    pthread_barrier_destroy(&barrier);
+    free(tids);
+    free(port_offset);
+    free(first_node);
+    free(port_comms);
+    free(port_stg);
+    free(port_bw);
+    for(t = 0; t < n_threads; t++)
+        free(hop_ports[t]);
+    free(hop_ports);
+    free(max_hop_ports);
+    n_threads = 1;
+}
+
+/**
+ * Same as min_links_bandwidth_fast_electric(), solved by all the threads.
+ */
+void min_links_bandwidth_fast_parallel()
+{
+    long i, j;
+    float link_bw = 0.0;
+    float l_bandwidth = 0;
+
+    min_speed = FLT_MAX;
+    total_link_bw = 0.0;
+    avg_link_bandwidth = 0.0;
+    links = 0;
+    total_links = 0;
+
+    storage_bandwidth_electric();
+
+    pthread_barrier_wait(&barrier);
+    solve(0);
+    pthread_barrier_wait(&barrier);
+
+    for(i = 0; i < servers + switches; i++){
+        for(j = 0; j < network[i].nports; j++){
+            total_links++;
+            if(!port_used(i, j))
+                continue;
+            links++;
+            link_bw = port_bw[port_offset[i] + j];
+            l_bandwidth = (float)network[i].port[j].bandwidth_capacity;
+
+            if(link_bw < min_speed)
+                min_speed = link_bw;
+
+            total_link_bw += (link_bw / (float)l_bandwidth);
+            avg_link_bandwidth += link_bw;
+        }
+    }
+    avg_link_bandwidth /= links;
+    agg_bw += (((total_link_bw / links) - agg_bw) / (float)(++steps));
+    metrics.execution.avg_agg_bw += ((link_bw - metrics.execution.avg_agg_bw) / (float)(++metrics.execution.n_steps));
+}
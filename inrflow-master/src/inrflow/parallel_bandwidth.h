@@ -0,0 +1,31 @@
+#ifndef _parallel_bandwidth
+#define _parallel_bandwidth
+
+/**
+ * Parallel bandwidth solver of the dynamic-fast mode.
+ *
+ * The serial solver (min_links_bandwidth_fast_electric) visits the ports in order, lowering the
+ * speed of their flows to the share of the port and adding up the speeds. So the bandwidth used
+ * in a port is computed with the speeds lowered by the ports before it, and not by those after it.
+ * The parallel solver gets the same results in three passes, split among bandwidth_threads threads
+ * (the caller being the first one):
+ *
+ * 1. The shares of every port, split by ports.
+ * 2. The speed of every flow in every hop of its route: the lowest of its speed and the shares of
+ *    the ports of its route up to that one, in the order of the ports. Split by flows.
+ * 3. The bandwidth used in every port, adding the speeds of its flows in its hop in the order of
+ *    the flows of the port, as the serial solver does. Split by ports.
+ *
+ * The statistics of the links are then added up by the caller, in the order of the ports, so they
+ * are the same bit by bit.
+ */
+
+extern long bandwidth_threads;  ///< Threads solving the bandwidth, 0 means one per online core.
+
+long init_parallel_bandwidth();
+
+void finish_parallel_bandwidth();
+
+void min_links_bandwidth_fast_parallel();
+
+#endif
@@ -2,40 +2,53 @@
 #include <stdlib.h>
 #include "path_list.h"
 
+void init_path(struct path_t *path, long capacity)
+{
+	if(capacity < 1)
+		capacity = 1;
+	path->port = malloc(capacity * sizeof(long));
+	if(path->port == NULL) {
+		printf("Could not allocate the path buffer\n");
+		exit(-1);
+	}
+	path->capacity = capacity;
+	path->head = 0;
+	path->length = 0;
+}
 
-long delete_tail(struct path_t **path,struct path_t *path_tail)
+void free_path(struct path_t *path)
 {
-	struct path_t *t1,*t2;
-	if(*path == NULL && path_tail== NULL) return 1;
-	//assume now that head is not null, since otherwise path_tail would
-	//also be null and we would not fall through the above if statement
+	free(path->port);
+	path->port = NULL;
+	path->capacity = 0;
+	path->head = 0;
+	path->length = 0;
+}
 
-	if(path_tail != NULL) {
-		t1=path_tail->next;
-		path_tail->next = NULL;
-	} else { // if(path!=NULL){
-		t1=*path;
-		*path = NULL;//prevents a dangling pointer
-	}
-	while(t1!=NULL) {
-		t2=t1;
-		t1=t1->next;
-		free(t2);
-	}
+long delete_tail(struct path_t *path, long mark)
+{
+	if(mark < path->length)
+		path->length = mark;
+	if(path->head > path->length)
+		path->head = path->length;
 	return 1;
 }
 
-long empty_path(struct path_t **path,struct path_t **path_tail)
+long empty_path(struct path_t *path)
 {
-	*path_tail = NULL;
-	delete_tail(path,NULL);
-	*path = NULL;
+	path->head = 0;
+	path->length = 0;
 	return 1;
 }
 
+long path_mark(struct path_t *path)
+{
+	return path->length;
+}
+
 long path_is_null(struct path_t *path)
 {
-	if(path==NULL)
+	if(path->head == path->length)
 		return 1;
 	else
 		return 0;
@@ -43,47 +56,35 @@ long path_is_null(struct path_t *path)
 
 void print_path(struct path_t *path)
 {
-	struct path_t *curr;
-	curr = path;
-	while(curr!=NULL) {
-		printf("%ld, ",curr->port);
-		curr = curr->next;
-	}
+	long i;
+
+	for(i = path->head; i < path->length; i++)
+		printf("%ld, ",path->port[i]);
 	printf(".\n");
 
 }
 
-void path_enqueue(struct path_t **path, struct path_t **path_tail, struct path_t **path_penultimate, long port)
+void path_enqueue(struct path_t *path, long port)
 {
-	if(*path_tail != NULL) {
-		(*path_tail)->next = malloc(sizeof(struct path_t));
-		*path_penultimate = *path_tail;
-		*path_tail = (*path_tail)->next;
-	} else {
-		*path = malloc(sizeof(struct path_t));
-		*path_tail = *path;
-		*path_penultimate = NULL;
+	if(path->length == path->capacity) {
+		path->capacity *= 2;
+		path->port = realloc(path->port, path->capacity * sizeof(long));
+		if(path->port == NULL) {
+			printf("Could not grow the path buffer to %ld ports\n", path->capacity);
+			exit(-1);
+		}
 	}
-	(*path_tail)->port = port;
-
-	(*path_tail)->next = NULL;
+	path->port[path->length++] = port;
 }
 
-long path_dequeue(struct path_t **path, struct path_t **path_tail)
+long path_dequeue(struct path_t *path)
 {
 	long port;
-	struct path_t *freeme;
-	if(*path == NULL)
+
+	if(path->head == path->length)
 		return -1;
-	else {
-		//store head of path in result
-		port = (*path)->port;
-		//pop the head
-		freeme = *path;
-		*path = (*path)->next;
-		free(freeme);
-		if(*path==NULL)
-			*path_tail = NULL;
-		return port;
-	}
+	port = path->port[path->head++];
+	if(path->head == path->length) // consumed, rewind for the next path
+		empty_path(path);
+	return port;
 }
@@ -1,21 +1,36 @@
 /**
  * @file
- * @brief Linked-list for storing routed path.
+ * @brief Array-backed buffer for storing routed paths.
  *
- * Nodes queue at the path tail and dequeue from the path head
+ * Ports are enqueued at the path tail and dequeued from the path head. The
+ * buffer belongs to a routing context (usually a static in the topology) and
+ * is reused for every route, so building, truncating and consuming a path do
+ * not allocate memory. The array doubles when a path exceeds its capacity.
  */
 #ifndef _path_list
 #define _path_list
 
-struct path_t { ///< linked-list for path storage used in mark_route
-	long port;
-	struct path_t * next;
+struct path_t { ///< route buffer used in init_routing and consumed in route
+	long *port;     ///< ports of the path, in order
+	long head;      ///< position of the next port to dequeue
+	long length;    ///< number of ports stored
+	long capacity;  ///< number of ports allocated
 };
 
+/**
+ * Allocate the buffer for 'capacity' ports (it grows if needed)
+ */
+void init_path(struct path_t *path, long capacity);
+
+/**
+ * Free the buffer
+ */
+void free_path(struct path_t *path);
+
 /**
  * Determine whether 'path' is empty
  *
- * @return 1 if 'path' is NULL, 0 otherwise
+ * @return 1 if there are no ports left to dequeue, 0 otherwise
  */
 long path_is_null(struct path_t *path);
 
@@ -26,23 +41,31 @@ long path_is_null(struct path_t *path);
 void print_path(struct path_t *path);
 
 /**
- * Delete and free all nodes
+ * Delete all ports
  */
-long empty_path(struct path_t **path,struct path_t **path_tail);
+long empty_path(struct path_t *path);
 
 /**
- * Truncate the path at 'path_tail'
+ * Bookmark the current tail, to truncate the path later on
+ *
+ * @return the bookmark, to be used in delete_tail
  */
-long delete_tail(struct path_t **path,struct path_t *path_tail);
+long path_mark(struct path_t *path);
 
 /**
- * Add a node at path_tail
+ * Truncate the path at 'mark' (as returned by path_mark)
  */
-void path_enqueue(struct path_t **path, struct path_t **path_tail, struct path_t **path_penultimate, long port);
+long delete_tail(struct path_t *path, long mark);
 
+/**
+ * Add a port at the tail
+ */
+void path_enqueue(struct path_t *path, long port);
 
 /**
- * Dequeue a node from head of 'path' and return value of its 'port'
+ * Dequeue a port from head of 'path'
+ *
+ * @return the port, or -1 if 'path' is empty
  */
-long path_dequeue(struct path_t **path, struct path_t **path_tail);
+long path_dequeue(struct path_t *path);
 #endif
@@ -6,6 +6,7 @@
 #include "list.h"
 #include "metrics.h"
 #include "globals.h"
+#include "profiler.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <limits.h>
@@ -20,11 +21,149 @@ extern long ports;	///< The total number of ports in the topology
 
 int n_channels;
 int n_lambdas;
+int channel_words;  ///< words of the channel bitsets of a port.
+int lambda_words;   ///< words of the lambda bitset of a channel.
 long channel_bandwidth;
 long n_inj;
 channel_assignment_policy_t channel_assign_pol;
 lambda_assignment_policy_t lambda_assign_pol;
-list_t *path;
+
+photonic_path_t *path_buffer = NULL;    ///< hops of the lightpath being explored.
+long path_buffer_size = 0;              ///< allocated hops in path_buffer.
+
+/**
+ * Bits of word w of a bitset of nbits bits that are inside the bitset.
+ */
+static uint64_t word_mask(long w, long nbits)
+{
+    long rem = nbits - (w * 64);
+
+    if(rem >= 64)
+        return(~0ULL);
+    return((1ULL << rem) - 1);
+}
+
+/**
+ * Walks the route from src to dst and stores its hops in path_buffer.
+ *
+ * @return the number of hops.
+ */
+static long collect_route(long src, long dst)
+{
+    long current = src;
+    long next_port;
+    long length = 0;
+
+    PROF_START(PROF_INIT_ROUTING);
+    length = init_routing(src, dst);
+    PROF_END(PROF_INIT_ROUTING);
+    if(length == -1){
+        finish_route();
+        return(0);
+    }
+    length = 0;
+    while(current != dst){
+        if(length == path_buffer_size){
+            path_buffer_size = (path_buffer_size == 0) ? 16 : path_buffer_size * 2;
+            path_buffer = realloc(path_buffer, path_buffer_size * sizeof(photonic_path_t));
+        }
+        PROF_START(PROF_ROUTE);
+        next_port = route(current, dst);
+        PROF_END(PROF_ROUTE);
+        set_path(&path_buffer[length++], current, next_port, -1, 0, 0);
+        current = network[current].port[next_port].neighbour.node;
+    }
+    finish_route();
+    return(length);
+}
+
+/**
+ * Channels in word w of a port that can take a new lightpath: not used at all when the whole
+ * channel is reserved (static lambdas), or with some free lambda otherwise.
+ */
+static uint64_t free_channels(opt_port_t *op, long w)
+{
+    uint64_t busy;
+
+    if(lambda_assign_pol == STATIC_LAMBDA_ASSIGN)
+        busy = op->channel_used[w];
+    else
+        busy = op->channel_full[w];
+    return(~busy & word_mask(w, op->n_channels));
+}
+
+/**
+ * Chooses the lambdas of the channel of a hop: all of them with static lambda assignment,
+ * or the first free one with adaptive lambda assignment.
+ */
+static void assign_lambdas(photonic_path_t *hop)
+{
+    opt_channel_t *ch = &network[hop->node_id].opt_port[hop->next_port].channels[hop->channel_id];
+    uint64_t free_l;
+    long w;
+
+    if(lambda_assign_pol == STATIC_LAMBDA_ASSIGN){
+        hop->lambda_id = 0;
+        hop->n_lambdas = ch->n_lambdas;
+        return;
+    }
+    for(w = 0; w < lambda_words; w++){
+        free_l = ~ch->lambda_busy[w] & word_mask(w, ch->n_lambdas);
+        if(free_l){
+            hop->lambda_id = (w * 64) + __builtin_ctzll(free_l);
+            hop->n_lambdas = 1;
+            return;
+        }
+    }
+    printf("Error: no free lambda in a channel with free lambdas.\n");
+    exit(-1);
+}
+
+/**
+ * Bandwidth of the lambdas reserved in a hop.
+ */
+static long hop_bandwidth(photonic_path_t *hop)
+{
+    opt_port_t *op = &network[hop->node_id].opt_port[hop->next_port];
+    opt_channel_t *ch = &op->channels[hop->channel_id];
+
+    if(hop->n_lambdas == ch->n_lambdas)
+        return(op->channel_bandwidth);
+    return(hop->n_lambdas * ch->lambda_bandwidth);
+}
+
+/**
+ * Reserves (or releases) the lambdas of a hop and updates the channel bitsets of its port.
+ */
+static void reserve_hop(photonic_path_t *hop, long reserve)
+{
+    opt_port_t *op = &network[hop->node_id].opt_port[hop->next_port];
+    opt_channel_t *ch = &op->channels[hop->channel_id];
+    uint64_t c_bit = 1ULL << (hop->channel_id % 64);
+    long c_w = hop->channel_id / 64;
+    long l, w, used = 0, full = 1;
+
+    for(l = hop->lambda_id; l < hop->lambda_id + hop->n_lambdas; l++){
+        if(reserve)
+            ch->lambda_busy[l / 64] |= 1ULL << (l % 64);
+        else
+            ch->lambda_busy[l / 64] &= ~(1ULL << (l % 64));
+    }
+    for(w = 0; w < lambda_words; w++){
+        used |= (ch->lambda_busy[w] != 0);
+        full &= (ch->lambda_busy[w] == word_mask(w, ch->n_lambdas));
+    }
+    op->channel_used[c_w] = used ? (op->channel_used[c_w] | c_bit) : (op->channel_used[c_w] & ~c_bit);
+    op->channel_full[c_w] = full ? (op->channel_full[c_w] | c_bit) : (op->channel_full[c_w] & ~c_bit);
+    if(reserve){
+        ch->flows++;
+        op->reserved_bandwidth += hop_bandwidth(hop);
+    }
+    else{
+        ch->flows--;
+        op->reserved_bandwidth -= hop_bandwidth(hop);
+    }
+}
 
 /**
  * Calculates the time in which the first event (CPU, flow sent) will finish or occur.
@@ -34,7 +173,7 @@ double time_next_event_photonic(list_t *list_cpus, list_t *list_flows){
 
     long i;
     int src_aux;
-    long found;
+    long length;
     //long min = LONG_MAX;
     double min = DBL_MAX;
     //long time_next = 0;
@@ -47,7 +186,6 @@ double time_next_event_photonic(list_t *list_cpus, list_t *list_flows){
     long src = -1;
     long dst = -1;
 
-    path = malloc(sizeof(list_t));
     list_reset(&running_applications);
     while(list_next(&running_applications, (void*)&app)){
         for(i = 0; i < app->size; i++){
@@ -60,37 +198,43 @@ double time_next_event_photonic(list_t *list_cpus, list_t *list_flows){
                         }
                         break;
                     case SENDING:
-                        if(ev->count == ev->length){
-                            ev->dflow.start_time = sched_info->makespan;
-                            flow = &ev->dflow;
+                        if(ev->flow == -1){
                             src = do_translation(app, ev->pid, ev->type_flow);
                             dst = do_translation(app, ev->pid2, ev->type_flow);
+                            if(src == dst){
+                                length = 0; // no circuit needed
+                            }
+                            else{
+                                length = explore_routes(src, dst);
+                                if(length == 0){
+                                    if(verbose == 2)
+                                        printf("## Not Allocated flow (%ld --> %ld)\n", src, dst);
+                                    continue;
+                                }
+                            }
+                            ev->flow = alloc_flow();
+                            flow = get_flow(ev->flow);
+                            flow->start_time = sched_info->makespan;
                             if(src == dst && ev->type_flow == 1){
-                                ev->dflow.speed = read_capacity;
+                                flow_speed[ev->flow] = read_capacity;
                             }
                             else if(src == dst && ev->type_flow == 2){
-                                ev->dflow.speed = write_capacity;
+                                flow_speed[ev->flow] = write_capacity;
                             }
                             else if(src == dst){
-                                ev->dflow.speed = memory_capacity;
+                                flow_speed[ev->flow] = memory_capacity;
                             }
                             if(ev->type_flow == 5){
                                 src_aux = random() % n_io_servers;
                                 sched_info->san->san_links[src_aux].n_flows_read++;
-                                ev->dflow.san_link = src_aux;
+                                flow->san_link = src_aux;
                             }
                             else if(ev->type_flow == 6){
                                 src_aux = random() % n_io_servers;
                                 sched_info->san->san_links[src_aux].n_flows_write++;
-                                ev->dflow.san_link = src_aux;
-                            }
-                            found = explore_routes(path,src, dst);
-                            if(found == 0){
-                                printf("## Not Allocated flow (%ld --> %ld)\n", src, dst);
-                                continue;
+                                flow->san_link = src_aux;
                             }
-                            flow->allocated = 1;
-                            path_length = mark_route_dynamic_photonic(app, flow, src, dst, ev->type_flow, path);
+                            path_length = mark_route_dynamic_photonic(app, ev->flow, src, dst, ev->type_flow, length);
                             update_flows_distance(&(app->info), path_length, ev->type_flow);
                             list_append(list_flows, &ev);
                         }
@@ -110,37 +254,38 @@ double time_next_event_photonic(list_t *list_cpus, list_t *list_flows){
 
     san_links_bandwidth();
 
+    PROF_START(PROF_BANDWIDTH);
     min_links_bandwidth();
+    PROF_END(PROF_BANDWIDTH);
 
     list_reset(list_flows);
     while(list_next(list_flows, (void*)&ev_p)){
+        flow = get_flow((*ev_p)->flow);
         if((*ev_p)->type_flow == 5){
-            src = (*ev_p)->dflow.san_link;
+            src = flow->san_link;
             //src = do_translation(app, (*ev_p)->pid, (*ev_p)->type_flow);
             if(sched_info->san->san_links[src].current_speed_read > read_capacity){
-                (*ev_p)->dflow.speed = read_capacity;
+                flow_speed[(*ev_p)->flow] = read_capacity;
             }
             else{
-                (*ev_p)->dflow.speed = sched_info->san->san_links[src].current_speed_read;
+                flow_speed[(*ev_p)->flow] = sched_info->san->san_links[src].current_speed_read;
             }
         }
         else if((*ev_p)->type_flow == 6){
-            src = (*ev_p)->dflow.san_link;
+            src = flow->san_link;
             //src = do_translation(app, (*ev_p)->pid, (*ev_p)->type_flow);
             if(sched_info->san->san_links[src].current_speed_write > write_capacity){
-                (*ev_p)->dflow.speed = write_capacity;
+                flow_speed[(*ev_p)->flow] = write_capacity;
             }
             else{
-                (*ev_p)->dflow.speed = sched_info->san->san_links[src].current_speed_write;
+                flow_speed[(*ev_p)->flow] = sched_info->san->san_links[src].current_speed_write;
             }
         }
-        time_next = round_ns((*ev_p)->count / (*ev_p)->dflow.speed);
+        time_next = round_ns((*ev_p)->count / flow_speed[(*ev_p)->flow]);
         if(time_next < min){
             min = time_next;
         }
     }
-    printf("MIN: %f\n",min);
-    free(path);
     return(min);
 }
 
@@ -217,11 +362,19 @@ long insert_new_events_photonic(application *app, long ntask){
     return(num);
 }
 
-long mark_route_dynamic_photonic(application *app, dflow_t *flow, long src, long dst, int type, list_t *path)
+/**
+ * Reserves the lightpath left in path_buffer by explore_routes() for a flow. The hops go to the
+ * storage the flow slot kept from its previous circuits, grown only for longer ones.
+ * The speed of the flow is the bandwidth of the lambdas reserved in its slowest hop.
+ *
+ * @return the length of the lightpath.
+ */
+long mark_route_dynamic_photonic(application *app, long f, long src, long dst, int type, long length)
 {
-    long app_id;
-    long apps_running = 0;
+    dflow_t *flow = get_flow(f);
+    long last_app;
     long path_n_apps = 0;
+    long h, node, port;
     photonic_path_t *path_hop;
 
 
@@ -237,321 +390,246 @@ long mark_route_dynamic_photonic(application *app, dflow_t *flow, long src, long
         flow->type_id = -1;
     }
 
-    printf("Allocated flow (%ld --> %ld) Channels: ", src, dst);
-    flow->type = type;
-    //while(current != dst) {	// not at destination yet
-    list_reset(path);
-    while(list_next(path, (void*)&path_hop)){
-
-        network[path_hop->node_id].port[path_hop->next_port].flows++;
-        network[path_hop->node_id].opt_port[path_hop->next_port].channels[path_hop->channel_id].flows++;
-        printf("%ld ", path_hop->channel_id);
-        flow->speed = network[path_hop->node_id].opt_port[path_hop->next_port].channel_bandwidth;
+    if(verbose == 2)
+        printf("Allocated flow (%ld --> %ld) Channels: ", src, dst);
+    flow_type[f] = type;
+    flow->lightpath_length = length;
+    if(length > flow->max_lightpath_length){
+        flow->max_lightpath_length = length;
+        flow->lightpath = realloc(flow->lightpath, length * sizeof(photonic_path_t));
+    }
+    if(length > 0){
+        flow_speed[f] = FLT_MAX;
+    }
+    for(h = 0; h < length; h++){
+        path_hop = &flow->lightpath[h];
+        *path_hop = path_buffer[h];
+        node = path_hop->node_id;
+        port = path_hop->next_port;
+
+        reserve_hop(path_hop, 1);
+        network[node].port[port].flows++;
+        if(verbose == 2)
+            printf("%d ", path_hop->channel_id);
+        if(hop_bandwidth(path_hop) < flow_speed[f])
+            flow_speed[f] = hop_bandwidth(path_hop);
         if(type == 1){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_read++;
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_read_fault++;
+            network[node].port[port].flows_storage_read++;
+            network[node].port[port].flows_storage_read_fault++;
         }
         else if(type == 3){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_read++;
+            network[node].port[port].flows_storage_read++;
         }
         else if(type == 2){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_write++;
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_write_fault++;
+            network[node].port[port].flows_storage_write++;
+            network[node].port[port].flows_storage_write_fault++;
         }
         else if(type == 4){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_write++;
+            network[node].port[port].flows_storage_write++;
         }
-        if(app->info.links_utilization[path_hop->node_id] == NULL){
-            app->info.links_utilization[path_hop->node_id] = calloc(get_radix(path_hop->node_id), sizeof(int));
+        if(app->info.links_utilization[node] == NULL){
+            app->info.links_utilization[node] = calloc(get_radix(node), sizeof(long));
         }
-        else if(app->info.links_utilization[path_hop->node_id][path_hop->next_port] == 0){
+        else if(app->info.links_utilization[node][port] == 0){
             app->info.num_links_used++;
         }
-        app->info.links_utilization[path_hop->node_id][path_hop->next_port]++;
-
-        if(network[path_hop->node_id].port[path_hop->next_port].link_info[app->info.id] == 0){
-            apps_running = 0;
-            for(app_id = 1; app_id < MAX_CONCURRENT_APPS + 1;app_id++){
-                if((network[path_hop->node_id].port[path_hop->next_port].link_info[app_id] > 0) && is_running(app_id)){
-                    apps_running++;
-                }
-            }
-            network[path_hop->node_id].port[path_hop->next_port].link_info[0] = apps_running + 1;
-        }
-        network[path_hop->node_id].port[path_hop->next_port].link_info[app->info.id]++;
+        app->info.links_utilization[node][port]++;
 
-
-        //printf("iINFO_APPS: %ld (%ld) #%ld, %ld#\n", network[current].port[next_port].link_info_apps[app->info.id],  network[current].port[next_port].link_info_apps[0], current, next_port);
-
-        if(network[path_hop->node_id].port[path_hop->next_port].link_info_apps[app->info.id] == 0){
-            network[path_hop->node_id].port[path_hop->next_port].link_info_apps[0] = app->info.id;
-        }
-        network[path_hop->node_id].port[path_hop->next_port].link_info_apps[app->info.id]++;
-        if(network[path_hop->node_id].port[path_hop->next_port].link_info_apps[0] > path_n_apps){
-            path_n_apps = network[path_hop->node_id].port[path_hop->next_port].link_info_apps[0];
+        last_app = add_link_app_flow(&network[node].port[port], app->info.id);
+        if(last_app > path_n_apps){
+            path_n_apps = last_app;
         }
-
-        //list_append(&network[current].port[path_hop->next_port].dflows, &flow);
-        //list_tail_node(&network[current].port[path_hop->next_port].dflows, (void*)&node);
-        //path.n_l = node;
-        //dflows = &network[current].port[path_hop->next_port].dflows;
-        //    calc_insert_flow_max_min(dflows, current, next_port);
-        //current_aux = current;
-        //current = network[current].port[path_hop->next_port].neighbour.node;
-
-        //if(network[current_aux].port[path_hop->next_port].flows > path_n_flows_max && current_aux != src && current != dst){
-        //   path_n_flows_max = network[current_aux].port[path_hop->next_port].flows;
-        //}
     }
-    printf("\n");
-    list_initialize(flow->path, sizeof(photonic_path_t));
-    list_concat(flow->path,path);
-    return(path->length);
+    if(verbose == 2)
+        printf("\n");
+    return(length);
 }
 
-long explore_routes(list_t* path, long src, long dst){
+/**
+ * Looks for a lightpath from src to dst in any of the paths provided by the routing.
+ *
+ * @return the length of the lightpath found (left in path_buffer), 0 if there is none.
+ */
+long explore_routes(long src, long dst){
 
     long n_paths;
-    long found = 0;
+    long length = 0;
     long current_path = 0;
 
-    list_initialize(path, sizeof(photonic_path_t));
     n_paths = get_n_paths_routing(src, dst);
 
-    while (!found &&  current_path < n_paths){
-        found = explore_route(path, src, dst);
+    while (length == 0 && current_path < n_paths){
+        length = explore_route(src, dst);
         current_path++;
     }
-    return(found);
+    return(length);
 }
 
+/**
+ * Static channel assignment: the lightpath uses the same channel in all its hops. The channels
+ * free in every hop are found at once by AND-ing the free-channel bitsets of the ports of the path.
+ *
+ * @return the length of the lightpath, 0 if there is no channel free along the whole path.
+ */
+long explore_route_static_channel(long src, long dst){
 
-long explore_route_static_static(list_t* path, long src, long dst){
-
-    long current;
-    long next_port, current_channel;
-    long found = 0;
-    photonic_path_t path_hop;
+    long length, h, w;
+    int channel = -1;
+    uint64_t avail;
 
-    current_channel = 0;
-    current = src;
-    init_routing(current, dst);
-    next_port = route(current, dst);
+    length = collect_route(src, dst);
 
-    while(!found && current_channel < network[current].opt_port[next_port].n_channels){
-        while(current != dst){	// not at destination yet
-            if(network[current].opt_port[next_port].channels[current_channel].flows != 0){
-                list_destroy(path);
-                break;
-            }
-            set_path(&path_hop, current, next_port, current_channel, 0, NULL);
-            list_append(path, &path_hop);
-            current = network[current].port[next_port].neighbour.node;
-            next_port = route(current, dst);
-            if(current == dst){
-                found = 1;
-            }
+    for(w = 0; w < channel_words && channel == -1; w++){
+        avail = word_mask(w, n_channels);
+        for(h = 0; h < length && avail; h++){
+            avail &= free_channels(&network[path_buffer[h].node_id].opt_port[path_buffer[h].next_port], w);
         }
-        current_channel++;
-        init_routing(src, dst);
-        next_port = route(src, dst);
-        current = src;
+        if(avail){
+            channel = (w * 64) + __builtin_ctzll(avail);
+        }
+    }
+    if(channel == -1){
+        return(0);
+    }
+    for(h = 0; h < length; h++){
+        path_buffer[h].channel_id = channel;
+        assign_lambdas(&path_buffer[h]);
     }
-    //assert(!found && path->head == NULL);
-    return(found);
+    return(length);
 }
 
-long explore_route_adaptive_static(list_t* path, long src, long dst){
-
-    int current_channel;
-    long current;
-    long next_port;
-    long found = 1;
-    photonic_path_t path_hop;
-
-    current_channel = 0;
-    init_routing(src, dst);
-    next_port = route(src, dst);
-    current = src;
+/**
+ * Adaptive channel assignment: every hop of the lightpath takes the first channel free in its port.
+ *
+ * @return the length of the lightpath, 0 if some port of the path has no free channel.
+ */
+long explore_route_adaptive_channel(long src, long dst){
 
-    while(found && current != dst){	// not at destination yet
+    long length, h, w;
+    uint64_t avail;
+    opt_port_t *op;
 
-        while(current_channel < network[current].opt_port[next_port].n_channels){
+    length = collect_route(src, dst);
 
-            if(network[current].opt_port[next_port].channels[current_channel].flows == 0){
-                set_path(&path_hop, current, next_port, current_channel, 0, NULL);
-                list_append(path, &path_hop);
+    for(h = 0; h < length; h++){
+        op = &network[path_buffer[h].node_id].opt_port[path_buffer[h].next_port];
+        path_buffer[h].channel_id = -1;
+        for(w = 0; w < channel_words; w++){
+            avail = free_channels(op, w);
+            if(avail){
+                path_buffer[h].channel_id = (w * 64) + __builtin_ctzll(avail);
                 break;
             }
-            current_channel++;
         }
-        if(current_channel == network[current].opt_port[next_port].n_channels){
-            found = 0;
-            list_destroy(path);
-            break;
+        if(path_buffer[h].channel_id == -1){
+            return(0);
         }
-        current_channel = 0;
-        current = network[current].port[next_port].neighbour.node;
-        next_port = route(current, dst);
+        assign_lambdas(&path_buffer[h]);
     }
-    return(found);
+    return(length);
 }
 
-void remove_flow_photonic(dflow_t *flow, long id, long src, long dst){
+void remove_flow_photonic(long f, long id, long src, long dst){
 
+    dflow_t *flow = get_flow(f);
     photonic_path_t *path_hop;
-    //list_t *dflows;
-    //long node, port;
     long path_n_apps = 0;
+    long last_app;
+    long h, node, port;
 
-    if(flow->type == 1){
+    if(flow_type[f] == 1){
         network[src].flows_storage_read_injected--;
     }
-    else if(flow->type == 2){
+    else if(flow_type[f] == 2){
         network[dst].flows_storage_write_injected--;
     }
-    else if(flow->type == 5){
+    else if(flow_type[f] == 5){
         src = flow->san_link;
         sched_info->san->san_links[src].n_flows_read--;
     }
-    else if(flow->type == 6){
+    else if(flow_type[f] == 6){
         src = flow->san_link;
         sched_info->san->san_links[src].n_flows_write--;
     }
-    list_reset(flow->path);
-    while(list_next(flow->path, (void*)&path_hop)){
-        network[path_hop->node_id].port[path_hop->next_port].flows--;
-        network[path_hop->node_id].opt_port[path_hop->next_port].channels[path_hop->channel_id].flows--;
-        if(flow->type == 1){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_read--;
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_read_fault--;
-        }
-        else if(flow->type == 3){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_read--;
+    for(h = 0; h < flow->lightpath_length; h++){
+        path_hop = &flow->lightpath[h];
+        node = path_hop->node_id;
+        port = path_hop->next_port;
+        reserve_hop(path_hop, 0);
+        network[node].port[port].flows--;
+        if(flow_type[f] == 1){
+            network[node].port[port].flows_storage_read--;
+            network[node].port[port].flows_storage_read_fault--;
         }
-        else if(flow->type == 2){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_write--;
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_write_fault--;
+        else if(flow_type[f] == 3){
+            network[node].port[port].flows_storage_read--;
         }
-        else if(flow->type == 4){
-            network[path_hop->node_id].port[path_hop->next_port].flows_storage_write--;
+        else if(flow_type[f] == 2){
+            network[node].port[port].flows_storage_write--;
+            network[node].port[port].flows_storage_write_fault--;
         }
-        network[path_hop->node_id].port[path_hop->next_port].link_info_apps[id]--;
-        //printf("RF: #%ld,%ld#\n",path->node_id, path->next_port);
-        if(network[path_hop->node_id].port[path_hop->next_port].link_info_apps[id] == 0){
-            network[path_hop->node_id].port[path_hop->next_port].link_info_apps[0] = 0;
+        else if(flow_type[f] == 4){
+            network[node].port[port].flows_storage_write--;
         }
-        if(network[path_hop->node_id].port[path_hop->next_port].link_info_apps[0] > path_n_apps){
-            path_n_apps = network[path_hop->node_id].port[path_hop->next_port].link_info_apps[0];
+        last_app = remove_link_app_flow(&network[node].port[port], id);
+        if(last_app > path_n_apps){
+            path_n_apps = last_app;
         }
-
-
-        //dflows = &network[path->node_id].port[path->next_port].dflows;
-        //node = path->node;
-        //port = path->next_port;
-        //list_rem_node(&network[path->node_id].port[path->next_port].dflows, path->n_l);
-        list_rem_elem(flow->path);
-        //calc_remove_flow_max_min(dflows, node, port);
     }
-    free(flow->path);
+    flow->lightpath_length = 0;
 }
 
+/**
+ * Link bandwidth statistics. Lightpaths have their lambdas reserved end to end, so the bandwidth
+ * used in a link is the bandwidth reserved by the lightpaths going through it. The aggregated
+ * bandwidth of the execution is the mean, along the steps, of the mean bandwidth of the links used.
+ */
 void min_links_bandwidth_photonic(){
 
-    long i,j,i_aux, j_aux;
-    long bandwidth_read = 0;
-    long bandwidth_write = 0;
-    float total_link_bw = 0.0;
+    long i,j;
     float link_bw = 0.0;
-    float l_bandwidth = 0;
-    float bandwidth = 0;
-    list_t *dflows;
-    dflow_t **flow;
     min_speed = FLT_MAX;
+    total_link_bw = 0.0;
     avg_link_bandwidth = 0.0;
     links = 0;
     total_links = 0;
-    /*
-       for(i=0; i<servers; i++){
-       if(network[i].flows_storage_read_injected > 0){
-       bandwidth_read = read_capacity / network[i].flows_storage_read_injected;
-       for(j = 0 ;j<network[i].nports; j++){
-       dflows = &network[i].port[j].dflows;
-       list_reset(dflows);
-       while(list_next(dflows, (void*)&flow)){
-       if((*flow)->type_id == i && (*flow)->type == 1){
-       (*flow)->speed = bandwidth_read;
-       }
-       }
-       }
-       }
-       if(network[i].flows_storage_write_injected > 0){
-       bandwidth_write = write_capacity / network[i].flows_storage_write_injected;
-       for(j = 0 ;j<network[i].nports; j++){
-       i_aux = network[i].port[j].neighbour.node;
-       for(j_aux = 0; j_aux < network[i_aux].nports; j_aux++){
-       if(network[i_aux].port[j_aux].neighbour.node == i){
-       dflows = &network[i_aux].port[j_aux].dflows;
-       list_reset(dflows);
-       while(list_next(dflows, (void*)&flow)){
-       if((*flow)->type_id == i  && (*flow)->type == 2){
-       (*flow)->speed = bandwidth_write;
-       }
-       }
-       break;
-       }
-       }
-       }
-       }
-       }
-       */
+
     for(i = 0; i < servers + switches; i++){
         for(j = 0; j < network[i].nports; j++){
             total_links++;
             if(network[i].port[j].neighbour.node == -1 || network[i].port[j].neighbour.port == -1 ||  network[i].port[j].flows == 0)
                 continue;
             links++;
-            link_bw = 0;
-            //l_bandwidth = (float)network[i].port[j].bandwidth_capacity;
-            //bandwidth = l_bandwidth / network[i].port[j].flows;
-            //dflows = &network[i].port[j].dflows;
-            //list_reset(dflows);
-            //while(list_next(dflows, (void*)&flow)){
-            //    if(bandwidth < (*flow)->speed && (*flow)->type != 5 && (*flow)->type != 6){
-            //        (*flow)->speed = bandwidth;
-            //    }
-            //    if((*flow)->type != 5 && (*flow)->type != 6){
-            //        link_bw += (*flow)->speed;
-            //    }
-            //}
-            // if(link_bw < min_speed)
-            //     min_speed = link_bw;
-
-            //total_link_bw += (link_bw / (float)l_bandwidth);
-            // avg_link_bandwidth += link_bw;
+            link_bw = (float)network[i].opt_port[j].reserved_bandwidth;
+            if(link_bw < min_speed)
+                min_speed = link_bw;
+
+            total_link_bw += (link_bw / (float)network[i].port[j].bandwidth_capacity);
+            avg_link_bandwidth += link_bw;
         }
     }
-    //avg_link_bandwidth /= links;
-    //agg_bw += (((total_link_bw / links) - agg_bw) / (float)(++steps));
-    //metrics.execution.avg_agg_bw += ((link_bw - metrics.execution.avg_agg_bw) / (float)(++metrics.execution.n_steps));
-    /*
-       if((dmetrics_time > 0 && (sched_info->makespan % dmetrics_time) == 0)){
-       list_append(&metrics.execution.agg_bw, &agg_bw);
-       agg_bw = 0.0;
-       steps = 0;
-       }
-       */
+    if(links == 0)
+        return;
+    avg_link_bandwidth /= links;
+    agg_bw += (((total_link_bw / links) - agg_bw) / (float)(++steps));
+    metrics.execution.avg_agg_bw += ((avg_link_bandwidth - metrics.execution.avg_agg_bw) / (float)(++metrics.execution.n_steps));
+}
 
+/**
+ * Frees the structures used to explore lightpaths.
+ */
+void finish_photonic(){
+
+    free(path_buffer);
+    path_buffer = NULL;
+    path_buffer_size = 0;
 }
 
-void set_path(photonic_path_t *path_hop, long node_id, long next_port, int channel_id, int n_lambdas, int *lambdas){
+void set_path(photonic_path_t *path_hop, long node_id, long next_port, int channel_id, int lambda_id, int n_lambdas){
 
     path_hop->node_id = node_id;
     path_hop->next_port = next_port;
     path_hop->channel_id = channel_id;
-    path_hop->n_lambdas= n_lambdas;
-    path_hop->lambdas = lambdas;;
+    path_hop->lambda_id = lambda_id;
+    path_hop->n_lambdas = n_lambdas;
 }
-
-
-
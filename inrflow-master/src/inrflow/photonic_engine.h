@@ -6,14 +6,17 @@
 
 #include "node.h"
 
+/**
+ * A hop of a lightpath: the channel (and lambdas within it) reserved at a port.
+ */
 typedef struct photonic_path_t{
-    
+
     long node_id;
     long next_port;
     int channel_id;
-    int n_lambdas;
-    int *lambdas;
-    
+    int lambda_id;  ///< first reserved lambda.
+    int n_lambdas;  ///< number of reserved lambdas, from lambda_id on.
+
 } photonic_path_t;
 
 void update_events_photonic(unsigned long long time_next_app);
@@ -22,19 +25,21 @@ double time_next_event_photonic(list_t *list_cpus, list_t *list_flows);
 
 long insert_new_events_photonic(application *app, long ntask);
 
-long mark_route_dynamic_photonic(application *app, dflow_t *flow, long src, long dst, int type, list_t *path);
+long mark_route_dynamic_photonic(application *app, long f, long src, long dst, int type, long length);
 
-long explore_routes(list_t* path, long src, long dst);
+long explore_routes(long src, long dst);
 
-long (*explore_route)(list_t* path, long src, long dst);
+long (*explore_route)(long src, long dst);
 
-long explore_route_static_static(list_t *path, long src, long dst);
+long explore_route_static_channel(long src, long dst);
 
-long explore_route_adaptive_static(list_t *path, long src, long dst);
+long explore_route_adaptive_channel(long src, long dst);
 
-void remove_flow_photonic(dflow_t *flow, long id, long pid, long pid2);
+void remove_flow_photonic(long f, long id, long pid, long pid2);
 
 void min_links_bandwidth_photonic();
 
-void set_path(photonic_path_t *path, long node_id, long next_port, int channel_id, int n_lambdas, int *lambdas);
+void finish_photonic();
+
+void set_path(photonic_path_t *path, long node_id, long next_port, int channel_id, int lambda_id, int n_lambdas);
 #endif
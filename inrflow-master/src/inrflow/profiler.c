@@ -0,0 +1,218 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "profiler.h"
+#include "misc.h"
+
+long profile_sample;        ///< Time one in every profile_sample calls of a zone.
+char profile_trace[200];    ///< Chrome trace file, or empty for none.
+
+#ifdef PROFILE
+
+static char *zone_names[PROF_ZONES] = {"init_routing", "route", "bandwidth", "next_event", "allocation"};
+
+__thread prof_thread_t *prof_thread = NULL;    ///< Counters of this thread.
+long prof_burst;                                ///< Consecutive calls timed.
+int prof_tracing = 0;                           ///< Whether the calls timed are written to the trace.
+
+static long prof_gap;                   ///< Mean calls not timed between bursts.
+static prof_thread_t *threads = NULL;   ///< Counters of all the threads.
+static long n_threads = 0;
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+
+static FILE *trace = NULL;
+static long trace_events;
+
+static uint64_t start_ticks;        ///< Ticks at prof_init().
+static uint64_t overhead;           ///< Ticks measured for an empty zone.
+static double ns_per_tick;
+
+static double now_ns()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MODE, &ts);
+    return (ts.tv_sec * 1e9) + ts.tv_nsec;
+}
+
+#if !defined(__x86_64__) && !defined(__i386__)
+uint64_t prof_ticks()
+{
+    return (uint64_t)now_ns();
+}
+#endif
+
+/**
+ * Allocates the counters of the calling thread.
+ */
+prof_thread_t *prof_register()
+{
+    prof_thread_t *t = calloc(1, sizeof(prof_thread_t));
+    long z;
+
+    for(z = 0; z < PROF_ZONES; z++)
+    {
+        t->skip[z] = 1;
+        t->burst[z] = prof_burst;
+        t->gap[z] = prof_gap;
+    }
+
+    pthread_mutex_lock(&lock);
+    t->tid = n_threads++;
+    t->seed = 0x9e3779b97f4a7c15ULL * (t->tid + 1);
+    t->next = threads;
+    threads = t;
+    pthread_mutex_unlock(&lock);
+    prof_thread = t;
+    return t;
+}
+
+/**
+ * Starts a new burst of calls timed, after a random gap.
+ *
+ * @return The calls until the first one of the burst.
+ */
+long prof_skip(prof_thread_t *t, long zone)
+{
+    t->seed ^= t->seed << 13;
+    t->seed ^= t->seed >> 7;
+    t->seed ^= t->seed << 17;
+    t->burst[zone] = prof_burst;
+    return 1 + (t->seed % (2 * t->gap[zone]));
+}
+
+/**
+ * Writes the buffered events of a thread to the trace.
+ */
+void prof_flush(prof_thread_t *t)
+{
+    long i;
+    prof_event_t *ev;
+
+    pthread_mutex_lock(&lock);
+    for(i = 0; i < t->n_events && trace_events < PROF_TRACE_MAX; i++)
+    {
+        ev = &t->events[i];
+        fprintf(trace, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%ld,\"ts\":%.3f,\"dur\":%.3f}",
+                trace_events++ ? ",\n" : "", zone_names[ev->zone], t->tid,
+                (ev->start - start_ticks) * ns_per_tick / 1000,
+                (ev->end - ev->start > overhead ? ev->end - ev->start - overhead : 0) * ns_per_tick / 1000);
+    }
+    if(trace_events == PROF_TRACE_MAX)
+        prof_tracing = 0;
+    pthread_mutex_unlock(&lock);
+    t->n_events = 0;
+}
+
+/**
+ * Calibrates the time stamp counter, and the time it takes to read it, and opens the trace, if any.
+ */
+void prof_init()
+{
+    double t0, t1;
+    uint64_t c0, c1;
+    long i;
+
+    if(profile_sample < 1)
+        profile_sample = 1;
+    prof_burst = (profile_sample < PROF_BURST) ? profile_sample : PROF_BURST;
+    prof_gap = (profile_sample - 1) * prof_burst;
+
+    t0 = now_ns();
+    c0 = prof_ticks();
+    do
+    {
+        t1 = now_ns();
+    } while(t1 - t0 < 1e6);
+    ns_per_tick = (t1 - t0) / (prof_ticks() - c0);
+
+    overhead = ~0UL;
+    for(i = 0; i < 1000; i++)
+    {
+        c0 = prof_ticks();
+        c1 = prof_ticks() - c0;
+        if(c1 < overhead)
+            overhead = c1;
+    }
+
+    if(profile_trace[0] != '\0')
+    {
+        if((trace = fopen(profile_trace, "w")) == NULL)
+        {
+            perror("Unable to open profile trace");
+            exit(-1);
+        }
+        fprintf(trace, "{\"traceEvents\":[\n");
+        trace_events = 0;
+        prof_tracing = 1;
+    }
+    start_ticks = prof_ticks();
+}
+
+/**
+ * Prints the time breakdown of the zones, added up over all the threads, and closes the trace.
+ */
+void prof_finish()
+{
+    prof_thread_t *t;
+    unsigned long calls, timed;
+    uint64_t ticks;
+    double total, run = (prof_ticks() - start_ticks) * ns_per_tick;
+    long z;
+
+    printf("Profile (1 in %ld calls timed, zones include nested zones):\n", profile_sample);
+    printf("%-18s %14s %12s %10s %8s\n", "zone", "calls", "total.ms", "mean.ns", "run.%");
+    for(z = 0; z < PROF_ZONES; z++)
+    {
+        calls = timed = ticks = 0;
+        for(t = threads; t != NULL; t = t->next)
+        {
+            calls += t->calls[z];
+            timed += t->timed[z];
+            ticks += t->ticks[z];
+        }
+        if(timed == 0)
+            continue;
+        ticks = (ticks > timed * overhead) ? ticks - (timed * overhead) : 0;
+        total = ticks * ns_per_tick * ((double)calls / timed);
+        printf("prof.%-13s %14lu %12.3f %10.1f %8.2f\n", zone_names[z], calls, total / 1e6,
+               total / calls, 100 * total / run);
+    }
+    printf("%-18s %14s %12.3f\n", "prof.run", "", run / 1e6);
+
+    if(trace != NULL)
+    {
+        for(t = threads; t != NULL; t = t->next)
+            prof_flush(t);
+        fprintf(trace, "\n]}\n");
+        fclose(trace);
+        printf("Wrote profile trace to file: %s\n", profile_trace);
+        if(trace_events == PROF_TRACE_MAX)
+            printf("The trace only has the first %d calls timed, use a larger profile_sample to trace all the run.\n",
+                   PROF_TRACE_MAX);
+    }
+    while(threads != NULL)
+    {
+        t = threads;
+        threads = t->next;
+        free(t);
+    }
+    prof_thread = NULL;
+}
+
+#else
+
+void prof_init()
+{
+    if(profile_trace[0] != '\0')
+        printf("The profiler is not built in (build with -DPROFILE), ignoring profile_trace.\n");
+}
+
+void prof_finish()
+{
+}
+
+#endif // PROFILE
@@ -0,0 +1,129 @@
+#ifndef _profiler
+#define _profiler
+
+/**
+ * Hot-path profiler.
+ *
+ * Build with -DPROFILE to enable it, e.g. make CFLAGS="-Wall -O2 -fcommon -DPROFILE". Otherwise the
+ * zones expand to nothing.
+ *
+ * A zone is a piece of code between PROF_START(zone) and PROF_END(zone) in the same block. The
+ * zones are timed with the time stamp counter, one in every profile_sample calls, in per-thread
+ * counters, and their time breakdown is printed at the end of the run. Calls are timed in bursts of
+ * PROF_BURST consecutive calls, as the first call timed after a long gap is slowed down by the
+ * profiler itself (cold branches and cache lines), separated by random gaps, so the calls timed do
+ * not follow the patterns of the simulation (e.g. always the same servers). Zones taking long enough
+ * for the profiler to be negligible (e.g. bandwidth) are timed on every call.
+ * The time of a zone includes that of the zones nested in it (e.g. next_event includes bandwidth).
+ * With profile_trace=<file.json>, the timed calls are also written to a Chrome trace (see
+ * chrome://tracing or https://ui.perfetto.dev), buffered per thread. Only the first PROF_TRACE_MAX
+ * calls timed are written, so long runs need a larger profile_sample to be traced all along.
+ */
+
+typedef enum prof_zone_t {
+    PROF_INIT_ROUTING = 0,  ///< Computing a route: init_routing().
+    PROF_ROUTE,             ///< Routing a hop: route().
+    PROF_BANDWIDTH,         ///< Solving the bandwidth of the flows: min_links_bandwidth*().
+    PROF_NEXT_EVENT,        ///< Selecting the next event: time_next_event().
+    PROF_ALLOCATION,        ///< Allocating the nodes of an application.
+    PROF_ZONES
+} prof_zone_t;
+
+extern long profile_sample;         ///< Time one in every profile_sample calls of a zone.
+extern char profile_trace[200];     ///< Chrome trace file, or empty for none.
+
+void prof_init();
+
+void prof_finish();
+
+#ifdef PROFILE
+
+#include <stdint.h>
+
+#define PROF_TRACE_EVENTS 4096      ///< Events buffered per thread before writing them to the trace.
+#define PROF_TRACE_MAX 1000000      ///< Events written to the trace, about 100MB.
+#define PROF_BURST 16               ///< Consecutive calls timed when sampling.
+#define PROF_LONG_TICKS 100000      ///< Zones taking longer than this are timed on every call.
+
+typedef struct prof_event_t {
+    uint64_t start;
+    uint64_t end;
+    long zone;
+} prof_event_t;
+
+typedef struct prof_thread_t {
+    long tid;
+    unsigned long calls[PROF_ZONES];    ///< All the calls of every zone.
+    unsigned long timed[PROF_ZONES];    ///< Calls timed of every zone.
+    uint64_t ticks[PROF_ZONES];         ///< Ticks of the timed calls of every zone.
+    long skip[PROF_ZONES];              ///< Calls until the next one timed, counting it.
+    long burst[PROF_ZONES];             ///< Calls left to time in the current burst.
+    long gap[PROF_ZONES];               ///< Mean calls not timed between bursts, 0 to time every call.
+    uint64_t seed;                      ///< Random gaps.
+    long n_events;
+    prof_event_t events[PROF_TRACE_EVENTS];
+    struct prof_thread_t *next;
+} prof_thread_t;
+
+extern __thread prof_thread_t *prof_thread;
+extern long prof_burst;
+extern int prof_tracing;
+
+prof_thread_t *prof_register();
+
+void prof_flush(prof_thread_t *t);
+
+long prof_skip(prof_thread_t *t, long zone);
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define prof_ticks() __rdtsc()
+#else
+uint64_t prof_ticks();
+#endif
+
+/**
+ * Counts a call to a zone.
+ *
+ * @return The start of the call, or 0 if this call is not to be timed.
+ */
+static inline uint64_t prof_start(long zone)
+{
+    prof_thread_t *t = __builtin_expect(prof_thread != NULL, 1) ? prof_thread : prof_register();
+
+    t->calls[zone]++;
+    if(__builtin_expect(--t->skip[zone] != 0, 1))
+        return 0;
+    return prof_ticks();
+}
+
+static inline void prof_end(long zone, uint64_t start)
+{
+    prof_thread_t *t = prof_thread;
+    uint64_t end = prof_ticks();
+
+    t->timed[zone]++;
+    t->ticks[zone] += end - start;
+    if(end - start > PROF_LONG_TICKS)
+        t->gap[zone] = 0;
+    t->skip[zone] = (--t->burst[zone] > 0 || t->gap[zone] == 0) ? 1 : prof_skip(t, zone);
+    if(prof_tracing)
+    {
+        t->events[t->n_events].start = start;
+        t->events[t->n_events].end = end;
+        t->events[t->n_events].zone = zone;
+        if(++t->n_events == PROF_TRACE_EVENTS)
+            prof_flush(t);
+    }
+}
+
+#define PROF_START(zone) uint64_t prof_start_##zone = prof_start(zone)
+#define PROF_END(zone) do { if(prof_start_##zone) prof_end(zone, prof_start_##zone); } while(0)
+
+#else
+
+#define PROF_START(zone)
+#define PROF_END(zone)
+
+#endif // PROFILE
+#endif
@@ -7,6 +7,7 @@
 #include <unistd.h>
 
 #include "reporting.h"
+#include "results.h"
 #include "misc.h"
 #include "globals.h"
 
@@ -24,8 +25,22 @@ long *server_hop_histogram;
 long *path_length_histogram;
 long *flows_histogram;
 
-long **trace_matrix;///< Trace matrix records connected flows. Memory intensive,
-///usually off.
+/**
+ * A row of the trace matrix: the flows from a source to each destination.
+ *
+ * Rows start sparse, as the destinations with flows sorted by index (most patterns only connect each
+ * source to a few destinations), and become dense arrays once they would take more than half the
+ * memory of the dense row.
+ */
+typedef struct trace_row_t {
+    long n;         ///< Number of destinations in a sparse row.
+    long size;      ///< Capacity of dst & flows.
+    long *dst;      ///< Destinations of a sparse row, in increasing order.
+    long *flows;    ///< Flows to each destination of a sparse row, or to every server if dense.
+    long dense;     ///< Whether flows is a dense row of servers entries.
+} trace_row_t;
+
+trace_row_t *trace_matrix;///< Trace matrix records connected flows. Usually off.
 
 static time_t start_time;	///< Simulation start time / date.
 static time_t end_time;		///< Simulation finish time / date.
@@ -371,19 +386,9 @@ void init_stats()
 
 void init_trace_matrix()
 {
-    int i,j;
-
     if(TRACE_MATRIX)
     {
-        trace_matrix = malloc(servers * sizeof *trace_matrix);
-        for(i = 0; i < servers; i++)
-        {
-            trace_matrix[i] = malloc(servers * sizeof **trace_matrix);
-            for(j = 0; j < servers; j++)
-            {
-                trace_matrix[i][j] = 0;
-            }
-        }
+        trace_matrix = calloc(servers, sizeof *trace_matrix);
     }
 }
 
@@ -395,12 +400,32 @@ void destroy_trace_matrix()
     {
         for(i = 0; i < servers; i++)
         {
-            free( trace_matrix[i] );
+            free(trace_matrix[i].dst);
+            free(trace_matrix[i].flows);
         }
         free(trace_matrix);
     }
 }
 
+/**
+ * Turns a sparse row of the trace matrix into a dense one.
+ */
+static void densify_trace_row(trace_row_t *row)
+{
+    long i;
+    long *flows = calloc(servers, sizeof *flows);
+
+    for(i = 0; i < row->n; i++)
+    {
+        flows[row->dst[i]] = row->flows[i];
+    }
+    free(row->dst);
+    free(row->flows);
+    row->dst = NULL;
+    row->flows = flows;
+    row->dense = 1;
+}
+
 void finish_stats(struct key_value ** stats_head)
 {
     struct key_value* curr_node=NULL, *aux_node=NULL;
@@ -428,11 +453,73 @@ void update_statistics(long sh, long lh)
     server_hops+=sh;
 }
 
+/**
+ * Removes a flow from the path length statistics, e.g., when it has to be re-routed.
+ * @param sh path length in terms of server hops
+ * @param lh path length in terms of link hops
+ */
+void remove_statistics(long sh, long lh)
+{
+    server_hop_histogram[sh]--;
+    path_length_histogram[lh]--;
+    link_hops-=lh;
+    server_hops-=sh;
+}
+
 void update_trace_matrix(long src, long dst)
 {
+    trace_row_t *row;
+    long lo, hi, mid;
+
     if(TRACE_MATRIX)
     {
-        trace_matrix[src][dst]++;
+        row = &trace_matrix[src];
+        if(row->dense)
+        {
+            row->flows[dst]++;
+            return;
+        }
+        // Binary search, starting with the usual case of increasing destinations.
+        lo = 0;
+        hi = row->n;
+        if(hi > 0 && row->dst[hi - 1] < dst)
+        {
+            lo = hi;
+        }
+        while(lo < hi)
+        {
+            mid = (lo + hi) / 2;
+            if(row->dst[mid] < dst)
+            {
+                lo = mid + 1;
+            }
+            else
+            {
+                hi = mid;
+            }
+        }
+        if(lo < row->n && row->dst[lo] == dst)
+        {
+            row->flows[lo]++;
+            return;
+        }
+        if(4 * (row->n + 1) > servers)
+        {
+            densify_trace_row(row);
+            row->flows[dst]++;
+            return;
+        }
+        if(row->n == row->size)
+        {
+            row->size = (2 * row->size) + 4;
+            row->dst = realloc(row->dst, row->size * sizeof *row->dst);
+            row->flows = realloc(row->flows, row->size * sizeof *row->flows);
+        }
+        memmove(&row->dst[lo + 1], &row->dst[lo], (row->n - lo) * sizeof *row->dst);
+        memmove(&row->flows[lo + 1], &row->flows[lo], (row->n - lo) * sizeof *row->flows);
+        row->dst[lo] = dst;
+        row->flows[lo] = 1;
+        row->n++;
     }
 }
 
@@ -497,7 +584,23 @@ void write_trace_file()
 {
     int i,j;
 
-    if(TRACE_MATRIX)
+    if(TRACE_MATRIX && results_file[0] != '\0')
+    {
+        results_matrix_start("trace", servers, servers);
+        for(i = 0; i < servers; i++)
+        {
+            if(trace_matrix[i].dense)
+            {
+                results_matrix_row(trace_matrix[i].flows);
+            }
+            else
+            {
+                results_matrix_sparse_row(trace_matrix[i].dst, trace_matrix[i].flows, trace_matrix[i].n);
+            }
+        }
+        results_matrix_end();
+    }
+    else if(TRACE_MATRIX)
     {
         snprintf(trace_filename,300,"%s/%s_%s_trace.dat", output_dir, prefix_filename,traffic_name);
         trace_file = fopen(trace_filename, "w");
@@ -509,12 +612,26 @@ void write_trace_file()
         fprintf(trace_file,
                 "#Trace matrix records number of traffic flows from src to dst.\n"
                 "#It does not reflect number of flows on any particular link.\n"
+                "#Pairs with no flows are not listed.\n"
                 "src dst traffic.flows\n");
         for(i = 0; i < servers; i++)
         {
-            for(j = 0; j < servers; j++)
+            if(trace_matrix[i].dense)
+            {
+                for(j = 0; j < servers; j++)
+                {
+                    if(trace_matrix[i].flows[j] != 0)
+                    {
+                        fprintf(trace_file,"%d %d %ld\n",i,j,trace_matrix[i].flows[j]);
+                    }
+                }
+            }
+            else
             {
-                fprintf(trace_file,"%d %d %ld\n",i,j,trace_matrix[i][j]);
+                for(j = 0; j < trace_matrix[i].n; j++)
+                {
+                    fprintf(trace_file,"%d %ld %ld\n",i,trace_matrix[i].dst[j],trace_matrix[i].flows[j]);
+                }
             }
         }
         printf("Wrote trace to file: %s\n",trace_filename);
@@ -557,15 +674,26 @@ void capture_statistics()
             failure_rate,
             r_seed,
             time_started);
+    if(results_file[0] != '\0')
+    {
+        results_open(results_file);
+    }
     write_trace_file();
-    snprintf(stats_filename,300,"%s/%s.dat",output_dir, prefix_filename);
-    stats_file = fopen(stats_filename,"w");
-    if(stats_file == NULL)
+    if(results_file[0] != '\0')
     {
-        perror("Unable to open stats file");
-        exit(-1);
+        printf("Wrote stats to results store: %s\n",results_file);
+    }
+    else
+    {
+        snprintf(stats_filename,300,"%s/%s.dat",output_dir, prefix_filename);
+        stats_file = fopen(stats_filename,"w");
+        if(stats_file == NULL)
+        {
+            perror("Unable to open stats file");
+            exit(-1);
+        }
+        printf("Wrote stats to file: %s\n",stats_filename);
     }
-    printf("Wrote stats to file: %s\n",stats_filename);
 
     long max_flow=max_hist_array(flows_histogram,upper_flows);
     long long server_pairs, non_zero_path_server_pairs;
@@ -779,16 +907,6 @@ void capture_statistics()
     }
 #endif
 
-#ifdef MEASURE_ROUTING_TIME
-    add_key_value(&stats_head,
-                  "mean.prerouting.time","%f",
-                  ((float)total_prerouting_time)/prerouting_count);
-    add_key_value(&stats_head,
-                  "mean.hoprouting.time","%f",
-                  ((float)total_hoprouting_time)/hoprouting_count);
-
-#endif
-
     if(get_topo_nstats)
     {
         for (i = 0; i < get_topo_nstats(); i++)
@@ -798,9 +916,16 @@ void capture_statistics()
     }
 
     reverse_list(&stats_head);
-    print_keys(stats_head,stats_file);
-    print_values(stats_head,stats_file);
-    fclose(stats_file);
+    if(results_file[0] != '\0')
+    {
+        results_row(stats_head);
+    }
+    else
+    {
+        print_keys(stats_head,stats_file);
+        print_values(stats_head,stats_file);
+        fclose(stats_file);
+    }
 
     print_key_value_pairs(stats_head,stdout);
     finish_stats(&stats_head);
@@ -843,75 +968,92 @@ void capture_statistics()
         }
     }
 
-    snprintf(hist_filename,300,"%s/%s_hist.dat",output_dir, prefix_filename);
-    hist_file = fopen(hist_filename,"w");
-    if(hist_file == NULL)
+    if(results_file[0] != '\0')
     {
-        perror("Unable to open stats file");
-        exit(-1);
+        char hist_name[RESULTS_NAME_LEN];
+
+        results_vector("hist.h",server_hop_histogram,UPPER_SERVER_HOPS);
+        results_vector("hist.p",path_length_histogram,UPPER_PATH_LENGTH);
+        results_vector("hist.f",flows_histogram,upper_flows);
+        for(i=0; i<topo_nhists; i++)
+        {
+            snprintf(hist_name,RESULTS_NAME_LEN,"hist.%c",topo_hists_prefix[i]);
+            results_vector(hist_name,topo_hists[i],topo_hists_max[i]);
+        }
+        results_close();
     }
+    else
+    {
+        snprintf(hist_filename,300,"%s/%s_hist.dat",output_dir, prefix_filename);
+        hist_file = fopen(hist_filename,"w");
+        if(hist_file == NULL)
+        {
+            perror("Unable to open stats file");
+            exit(-1);
+        }
 
 #ifdef BROKEN_FLOWS_NOT_DELETED
-    if(n_failures>0)
-    {
+        if(n_failures>0)
+        {
 #endif
-        fprintf(hist_file, "#WARNING:  Flow-histogram is invalid for n.failures>0 (i.e., this output) in the current version of INRFlow\n");
+            fprintf(hist_file, "#WARNING:  Flow-histogram is invalid for n.failures>0 (i.e., this output) in the current version of INRFlow\n");
 #ifdef BROKEN_FLOWS_NOT_DELETED
-    }
+        }
 #endif
 
-    fprintf(hist_file,
-            "#Histograms for %s.\n"
-            "#hi,pi,fi are indices for h, p and f, respectively. *n is normalized so that the bars add up to 1.\n"
-            "#h: Server hop length histogram (server hop path length, number of occurrences)\n"
-            "#p: Path length histogram (path length, number of occurrences)\n"
-            "#f: Flows histogram (number of flows, number of uni-directional links with this many flows)\n",
-            //	  "#If needed, omit the length 0 paths to avoid plotting the case where src=dst\n",
-            hist_filename);
-
-    //for each topo histogram, print doc for ti t
-    if(topo_nhists>0)
-    {
         fprintf(hist_file,
-                "#Topology histograms.\n");
-        for(i=0; i<topo_nhists; i++)
+                "#Histograms for %s.\n"
+                "#hi,pi,fi are indices for h, p and f, respectively. *n is normalized so that the bars add up to 1.\n"
+                "#h: Server hop length histogram (server hop path length, number of occurrences)\n"
+                "#p: Path length histogram (path length, number of occurrences)\n"
+                "#f: Flows histogram (number of flows, number of uni-directional links with this many flows)\n",
+                //	  "#If needed, omit the length 0 paths to avoid plotting the case where src=dst\n",
+                hist_filename);
+
+        //for each topo histogram, print doc for ti t
+        if(topo_nhists>0)
         {
             fprintf(hist_file,
-                    "#%c: %s\n",topo_hists_prefix[i],topo_hists_doc[i]);
+                    "#Topology histograms.\n");
+            for(i=0; i<topo_nhists; i++)
+            {
+                fprintf(hist_file,
+                        "#%c: %s\n",topo_hists_prefix[i],topo_hists_doc[i]);
+            }
         }
-    }
 
-    double num_uni_dir_links = (double)size_hist_array(flows_histogram,upper_flows);
-    fprintf(hist_file,"%9s %9s %6s %9s %9s %6s %9s %9s %6s",
-            "hi", "h", "nh" ,"pi" ,"p", "np" ,"fi" ,"f", "nf");
-    //for each topo histogram, print ti t
-    for(i=0; i<topo_nhists; i++)
-    {
-        fprintf(hist_file," %8c%c %9c %8c%c",topo_hists_prefix[i],'i',topo_hists_prefix[i],'n',topo_hists_prefix[i]);
-    }
-    fprintf(hist_file,"\n");
-    long hi=0,pi=0,fi=0;
-    bool_t topo_flag=FALSE;
-    while(hi<UPPER_SERVER_HOPS || pi < UPPER_PATH_LENGTH || fi < upper_flows || topo_flag)
-    {
-        hi=print_hist_next(hist_file,server_hop_histogram,
-                           UPPER_SERVER_HOPS,hi,(double)connected);
-        pi=print_hist_next(hist_file,path_length_histogram,
-                           UPPER_PATH_LENGTH,pi,(double)connected);
-        fi=print_hist_next(hist_file,flows_histogram,upper_flows,fi,num_uni_dir_links);
-        //for each topo histogram, print_hist_next
-        topo_flag=FALSE;
+        double num_uni_dir_links = (double)size_hist_array(flows_histogram,upper_flows);
+        fprintf(hist_file,"%9s %9s %6s %9s %9s %6s %9s %9s %6s",
+                "hi", "h", "nh" ,"pi" ,"p", "np" ,"fi" ,"f", "nf");
+        //for each topo histogram, print ti t
         for(i=0; i<topo_nhists; i++)
         {
-            topo_hists_index[i]=print_hist_next(hist_file,topo_hists[i],
-                                                topo_hists_max[i],
-                                                topo_hists_index[i],
-                                                (double)topo_hists_norm[i]);
-            if(topo_hists_index[i]<topo_hists_max[i]) topo_flag=TRUE;
+            fprintf(hist_file," %8c%c %9c %8c%c",topo_hists_prefix[i],'i',topo_hists_prefix[i],'n',topo_hists_prefix[i]);
         }
         fprintf(hist_file,"\n");
+        long hi=0,pi=0,fi=0;
+        bool_t topo_flag=FALSE;
+        while(hi<UPPER_SERVER_HOPS || pi < UPPER_PATH_LENGTH || fi < upper_flows || topo_flag)
+        {
+            hi=print_hist_next(hist_file,server_hop_histogram,
+                               UPPER_SERVER_HOPS,hi,(double)connected);
+            pi=print_hist_next(hist_file,path_length_histogram,
+                               UPPER_PATH_LENGTH,pi,(double)connected);
+            fi=print_hist_next(hist_file,flows_histogram,upper_flows,fi,num_uni_dir_links);
+            //for each topo histogram, print_hist_next
+            topo_flag=FALSE;
+            for(i=0; i<topo_nhists; i++)
+            {
+                topo_hists_index[i]=print_hist_next(hist_file,topo_hists[i],
+                                                    topo_hists_max[i],
+                                                    topo_hists_index[i],
+                                                    (double)topo_hists_norm[i]);
+                if(topo_hists_index[i]<topo_hists_max[i]) topo_flag=TRUE;
+            }
+            fprintf(hist_file,"\n");
+        }
+        fclose(hist_file);
     }
-    fclose(hist_file);
 
 #ifdef DEBUG
     stats_consistency_check();
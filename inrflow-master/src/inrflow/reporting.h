@@ -48,6 +48,7 @@ void init_trace_matrix();
 void destroy_trace_matrix();
 void finish_stats();
 void update_statistics(long sh, long lh);
+void remove_statistics(long sh, long lh);
 void update_trace_matrix(long src, long dst);
 void capture_statistics();
 long create_latex_output();
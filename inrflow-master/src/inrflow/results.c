@@ -0,0 +1,193 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+
+#include "results.h"
+
+char results_file[200]; ///< Results store, or empty to write the text files of every run.
+
+static FILE *store = NULL;          ///< Results store being written.
+static long run;                    ///< Id of the run being written.
+static long record_start;           ///< Offset of the record being written.
+static results_record_t record;     ///< Header of the record being written.
+
+/**
+ * Writes an integer as a zigzag variable-length integer.
+ */
+static void put_varint(long x)
+{
+    unsigned long u = ((unsigned long)x << 1) ^ (unsigned long)(x >> (8 * sizeof(long) - 1));
+
+    while(u >= 0x80)
+    {
+        putc((u & 0x7f) | 0x80, store);
+        u >>= 7;
+    }
+    putc(u, store);
+}
+
+/**
+ * Writes the header of a record. The size of the payload is filled in by end_record().
+ */
+static void start_record(results_type_t type, char *name, long rows, long cols)
+{
+    memset(&record, 0, sizeof(record));
+    memcpy(record.magic, RESULTS_MAGIC, 4);
+    record.type = type;
+    record.run = run;
+    strncpy(record.name, name, RESULTS_NAME_LEN - 1);
+    record.rows = rows;
+    record.cols = cols;
+    record_start = ftell(store);
+    fwrite(&record, sizeof(record), 1, store);
+}
+
+static void end_record()
+{
+    long end = ftell(store);
+
+    record.size = end - record_start - sizeof(record);
+    fseek(store, record_start, SEEK_SET);
+    fwrite(&record, sizeof(record), 1, store);
+    fseek(store, end, SEEK_SET);
+}
+
+/**
+ * Opens (or creates) a results store and locks it until results_close(), so the records of this
+ * run are not interleaved with those of other runs.
+ */
+long results_open(char *file)
+{
+    int fd;
+
+    if((fd = open(file, O_RDWR | O_CREAT, 0644)) == -1 || flock(fd, LOCK_EX) == -1)
+    {
+        perror("Unable to open results store");
+        exit(-1);
+    }
+    store = fdopen(fd, "r+");
+    fseek(store, 0, SEEK_END);
+    run = ftell(store);
+    return run;
+}
+
+/**
+ * Stores the key-value pairs of the run. Pairs with no value (spacers) are skipped.
+ */
+void results_row(struct key_value *head)
+{
+    struct key_value *kv;
+    long n = 0;
+
+    for(kv = head; kv != NULL; kv = kv->next)
+        if(kv->value[0] != '\0')
+            n++;
+    start_record(RESULTS_ROW, "stats", n, 0);
+    for(kv = head; kv != NULL; kv = kv->next)
+    {
+        if(kv->value[0] != '\0')
+        {
+            fwrite(kv->key, strlen(kv->key) + 1, 1, store);
+            fwrite(kv->value, strlen(kv->value) + 1, 1, store);
+        }
+    }
+    end_record();
+}
+
+/**
+ * Stores a vector of integers, e.g. a histogram. Trailing zeros are not stored.
+ */
+void results_vector(char *name, long *v, long n)
+{
+    long i;
+
+    while(n > 0 && v[n - 1] == 0)
+        n--;
+    start_record(RESULTS_VECTOR, name, 1, n);
+    for(i = 0; i < n; i++)
+        put_varint(v[i]);
+    end_record();
+}
+
+/**
+ * Starts a matrix of integers, whose rows are given by results_matrix_row().
+ */
+void results_matrix_start(char *name, long rows, long cols)
+{
+    start_record(RESULTS_MATRIX, name, rows, cols);
+}
+
+/**
+ * Stores a row of the current matrix as (repetitions, value) pairs.
+ */
+void results_matrix_row(long *row)
+{
+    long i = 0, j;
+
+    while(i < record.cols)
+    {
+        for(j = i + 1; j < record.cols && row[j] == row[i]; j++);
+        put_varint(j - i);
+        put_varint(row[i]);
+        i = j;
+    }
+}
+
+/**
+ * Stores a sparse row of the current matrix, given as the columns (in increasing order) and values
+ * of its non-zero elements. It is encoded as the equivalent dense row.
+ */
+void results_matrix_sparse_row(long *col, long *v, long n)
+{
+    long i = 0, j, at = 0;
+
+    while(i < n)
+    {
+        if(col[i] > at)
+        {
+            put_varint(col[i] - at);
+            put_varint(0);
+        }
+        for(j = i + 1; j < n && col[j] == col[j - 1] + 1 && v[j] == v[i]; j++);
+        put_varint(j - i);
+        put_varint(v[i]);
+        at = col[j - 1] + 1;
+        i = j;
+    }
+    if(at < record.cols)
+    {
+        put_varint(record.cols - at);
+        put_varint(0);
+    }
+}
+
+void results_matrix_end()
+{
+    end_record();
+}
+
+/**
+ * Stores a matrix of doubles, row by row.
+ */
+void results_real_matrix(char *name, double *m, long rows, long cols)
+{
+    start_record(RESULTS_REAL_MATRIX, name, rows, cols);
+    fwrite(m, sizeof(double), rows * cols, store);
+    end_record();
+}
+
+/**
+ * Finishes the run and releases the results store.
+ */
+void results_close()
+{
+    if(fclose(store) != 0)
+    {
+        perror("Unable to write results store");
+        exit(-1);
+    }
+    store = NULL;
+}
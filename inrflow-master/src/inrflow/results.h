@@ -0,0 +1,60 @@
+#ifndef _results
+#define _results
+
+#include "reporting.h"
+
+/**
+ * Results store: a single append-only file collecting the results of many runs.
+ *
+ * The store is a sequence of records, each one a results_record_t header followed by its payload.
+ * The records written by a run share the same run id (the offset of its first record), and the
+ * whole run is written while holding a lock on the file, so concurrent runs of a sweep may share
+ * the same store. tools/results_dump.c lists the records, prints all the rows as a single CSV table
+ * and prints vectors and matrices as text.
+ *
+ * Integers are written as zigzag variable-length integers (7 bits per byte, lowest first), and
+ * every row of a matrix is run-length encoded as (repetitions, value) pairs, so the usual
+ * trace matrices (mostly zeros or constant rows) take a few bytes per row.
+ */
+
+#define RESULTS_MAGIC "RST1"    ///< First bytes of every record (also the format version).
+#define RESULTS_NAME_LEN 24
+
+/**
+ * Types of record.
+ */
+typedef enum results_type_t {
+    RESULTS_ROW = 1,        ///< Key-value pairs of a run: rows columns of "key\0value\0".
+    RESULTS_VECTOR,         ///< cols integers (e.g. a histogram), without trailing zeros.
+    RESULTS_MATRIX,         ///< rows x cols integers, every row run-length encoded.
+    RESULTS_REAL_MATRIX     ///< rows x cols doubles, as stored in memory.
+} results_type_t;
+
+typedef struct results_record_t {
+    char magic[4];
+    int type;       ///< results_type_t
+    long run;       ///< Offset of the first record of the run.
+    char name[RESULTS_NAME_LEN];
+    long rows;
+    long cols;
+    long size;      ///< Bytes of payload following the header.
+} results_record_t;
+
+long results_open(char *store);
+
+void results_row(struct key_value *head);
+
+void results_vector(char *name, long *v, long n);
+
+void results_matrix_start(char *name, long rows, long cols);
+
+void results_matrix_row(long *row);
+
+void results_matrix_sparse_row(long *col, long *v, long n);
+
+void results_matrix_end();
+
+void results_real_matrix(char *name, double *m, long rows, long cols);
+
+void results_close();
+#endif
@@ -2,12 +2,16 @@
 #include "applications.h"
 #include "mapping.h"
 #include "allocation.h"
+#include "core_index.h"
+#include "workloads.h"
 #include "../jellyfish/allocation_jellyfish.h"
 #include "list.h"
 #include "globals.h"
 #include <stdlib.h>
 #include <limits.h>
 #include <stdio.h>
+#include <string.h>
+#include <float.h>
 
 scheduling_t scheduling; ///< the scheduling policy we are using in the simulation
 char* scheduling_name; ///< the name of the used scheduling policy as a string
@@ -19,6 +23,19 @@ long scheduling_params[MAX_SCHEDULING_PARAMS];    ///< Parameters passed to the
 
 extern long ports_switches;
 
+/**
+ * Running application in the profile: estimated finish time and number of cores.
+ */
+typedef struct profile_app_t{
+    double end;
+    long cores;
+    long id;
+} profile_app_t;
+
+static profile_app_t *profile_apps; ///< Running applications started by easy or conservative, by estimated finish time.
+static long n_profile_apps;
+static long max_profile_apps;
+
 void init_scheduling(long nservers, long nswitches){
 
     long i, j;
@@ -31,7 +48,10 @@ void init_scheduling(long nservers, long nswitches){
     sched_info->free_cores = 0;
     sched_info->inactive_cores = 0;
     sched_info->stopped = 0;
-    sched_info->running_apps = calloc(MAX_CONCURRENT_APPS + 1, sizeof(long));
+    sched_info->next_arrival = ULLONG_MAX;
+    sched_info->total_cores = 0;
+    sched_info->running_apps = NULL;
+    sched_info->running_apps_size = 0;
 
     sched_info->servers = malloc(sizeof(server_t) * nservers);
     sched_info->san = malloc(sizeof(san_t));
@@ -64,6 +84,11 @@ void init_scheduling(long nservers, long nswitches){
     }
 
 
+    init_core_index(nservers, server_cores);
+    max_profile_apps = 16;
+    profile_apps = malloc(sizeof(profile_app_t) * max_profile_apps);
+    n_profile_apps = 0;
+
         list_initialize(&running_applications, sizeof(application));
 }
 
@@ -71,11 +96,18 @@ unsigned long long schedule_next_application(){
 
     unsigned long long time_next_app = ULLONG_MAX;
 
+    stream_workload(sched_info->makespan);
     if(!sched_info->stopped){
     switch(scheduling){
         case FCFS:
             time_next_app = fcfs();
             break;
+        case EASY_BACKFILLING:
+            time_next_app = easy_backfilling();
+            break;
+        case CONSERVATIVE_BACKFILLING:
+            time_next_app = conservative_backfilling();
+            break;
         default:
             printf("Unkwown scheluding policy.\n");
             exit(-1);
@@ -83,6 +115,14 @@ unsigned long long schedule_next_application(){
 
     }
     }
+    else if(scheduling != FCFS){
+        // Backfilling may start new arrivals while the queue is blocked.
+        if(sched_info->next_arrival <= sched_info->makespan){
+            sched_info->stopped = 0;
+            return(schedule_next_application());
+        }
+        time_next_app = sched_info->next_arrival;
+    }
     return(time_next_app);
 }
 
@@ -114,10 +154,308 @@ unsigned long long fcfs(){
     return(time_next_app);
 }
 
+/**
+ * Availability profile: free cores along time as a step function. free[i] cores are available
+ * from time[i] until time[i+1] (the last step lasts forever).
+ */
+typedef struct profile_t{
+    long n;
+    long max;
+    double *time;
+    long *free;
+} profile_t;
+
+/**
+ * Estimated duration of an application. Applications without estimate are considered endless.
+ */
+static double app_estimate(application *app){
+
+    return((app->estimate > 0) ? app->estimate : DBL_MAX);
+}
+
+/**
+ * Finish time of a running application of the profile according to its estimate. Applications
+ * exceeding their estimate are expected to finish now.
+ */
+static double profile_app_end(profile_app_t *a){
+
+    return((a->end < sched_info->makespan) ? sched_info->makespan : a->end);
+}
+
+/**
+ * Adds an application started by a backfilling policy to the running applications of the profile.
+ */
+static void add_profile_app(application *app){
+
+    long i;
+    double end;
+
+    if(n_profile_apps == max_profile_apps){
+        max_profile_apps *= 2;
+        profile_apps = realloc(profile_apps, sizeof(profile_app_t) * max_profile_apps);
+    }
+    end = (app->estimate > 0) ? app->start_makespan + app->estimate : DBL_MAX;
+    for(i = n_profile_apps; i > 0 && profile_apps[i - 1].end > end; i--);
+    memmove(&profile_apps[i + 1], &profile_apps[i], sizeof(profile_app_t) * (n_profile_apps - i));
+    profile_apps[i].end = end;
+    profile_apps[i].cores = app->size_tasks;
+    profile_apps[i].id = app->info.id;
+    n_profile_apps++;
+}
+
+/**
+ * Removes a finished application from the running applications of the profile, if it is there.
+ */
+void remove_profile_app(long app_id){
+
+    long i;
+
+    for(i = 0; i < n_profile_apps && profile_apps[i].id != app_id; i++);
+    if(i < n_profile_apps){
+        n_profile_apps--;
+        memmove(&profile_apps[i], &profile_apps[i + 1], sizeof(profile_app_t) * (n_profile_apps - i));
+    }
+}
+
+/**
+ * Builds the availability profile from the free cores and the running applications, which are
+ * kept sorted as they start and finish. Applications exceeding their estimate are expected to
+ * finish now.
+ */
+static void init_profile(profile_t *p){
+
+    long i;
+    double end;
+
+    p->max = n_profile_apps + 1;
+    p->time = malloc(sizeof(double) * p->max);
+    p->free = malloc(sizeof(long) * p->max);
+    p->n = 1;
+    p->time[0] = sched_info->makespan;
+    p->free[0] = sched_info->free_cores;
+    for(i = 0; i < n_profile_apps && profile_apps[i].end < DBL_MAX; i++){
+        end = profile_app_end(&profile_apps[i]);
+        if(end > p->time[p->n - 1]){
+            p->time[p->n] = end;
+            p->free[p->n] = p->free[p->n - 1];
+            p->n++;
+        }
+        p->free[p->n - 1] += profile_apps[i].cores;
+    }
+}
+
+static void finish_profile(profile_t *p){
+
+    free(p->time);
+    free(p->free);
+}
+
+/**
+ * Makes sure there is a step starting at time t.
+ *
+ * @return the index of the step starting at t.
+ */
+static long profile_split(profile_t *p, double t){
+
+    long i = p->n;
+
+    while(i > 0 && p->time[i - 1] > t){
+        i--;
+    }
+    if(i > 0 && p->time[i - 1] == t){
+        return(i - 1);
+    }
+    if(p->n == p->max){
+        p->max *= 2;
+        p->time = realloc(p->time, sizeof(double) * p->max);
+        p->free = realloc(p->free, sizeof(long) * p->max);
+    }
+    memmove(&p->time[i + 1], &p->time[i], sizeof(double) * (p->n - i));
+    memmove(&p->free[i + 1], &p->free[i], sizeof(long) * (p->n - i));
+    p->time[i] = t;
+    p->free[i] = p->free[i - 1];
+    p->n++;
+    return(i);
+}
+
+/**
+ * Looks for the earliest step, from step 'from' on, in which 'cores' cores are available
+ * during 'duration'.
+ *
+ * @return the index of the step, or -1 if there is no such step.
+ */
+static long profile_find(profile_t *p, long cores, double duration, long from){
+
+    long i, j;
+    double end;
+
+    for(i = from; i < p->n; i++){
+        if(p->free[i] < cores){
+            continue;
+        }
+        end = (duration == DBL_MAX) ? DBL_MAX : p->time[i] + duration;
+        for(j = i + 1; j < p->n && p->time[j] < end && p->free[j] >= cores; j++);
+        if(j == p->n || p->time[j] >= end){
+            return(i);
+        }
+        i = j;
+    }
+    return(-1);
+}
+
+/**
+ * Reserves 'cores' cores from step 'start' during 'duration'.
+ */
+static void profile_reserve(profile_t *p, long start, long cores, double duration){
+
+    long i, end;
+
+    end = p->n;
+    if(duration < DBL_MAX){
+        end = profile_split(p, p->time[start] + duration);
+    }
+    for(i = start; i < end; i++){
+        p->free[i] -= cores;
+    }
+}
+
+/**
+ * Tries to start an application that has already arrived.
+ * The application must be the last one returned by list_next on the workload.
+ *
+ * @return 1 if the application was started, 0 otherwise.
+ */
+static long start_application(application *app, long backfilled){
+
+    if(app->size_tasks > sched_info->free_cores || allocate_application(app) == 0){
+        return(0);
+    }
+    app->backfilled = backfilled;
+    metrics.scheduling.backfilled += backfilled;
+    list_current_to_head(&workload);
+    map_application(app);
+    init_running_application(app);
+    add_profile_app(app);
+    return(1);
+}
+
+/**
+ * EASY backfilling: applications start in order while they fit. When the first waiting
+ * application does not fit, it gets a reservation at the earliest time in which, according to
+ * the estimates of the running applications, there will be enough free cores (shadow time).
+ * Other waiting applications may start if they do not delay that reservation, i.e., if they
+ * are expected to finish before the shadow time or use the cores left over by the reservation.
+ */
+unsigned long long easy_backfilling(){
+
+    long i, blocked = 0;
+    long free_cores, extra = 0;
+    double shadow = DBL_MAX;
+    application *app = NULL;
+
+    sched_info->next_arrival = ULLONG_MAX;
+    list_reset(&workload);
+    while(list_next(&workload, (void*)&app)){
+        if(app->info.arrive_time > sched_info->makespan){
+            sched_info->next_arrival = app->info.arrive_time;
+            break;
+        }
+        if(!blocked){
+            if(start_application(app, 0)){
+                continue;
+            }
+            blocked = 1;
+            free_cores = sched_info->free_cores;
+            for(i = 0; i < n_profile_apps && profile_apps[i].end < DBL_MAX; i++){
+                free_cores += profile_apps[i].cores;
+                if(free_cores >= app->size_tasks){
+                    shadow = profile_app_end(&profile_apps[i]);
+                    extra = free_cores - app->size_tasks;
+                    break;
+                }
+            }
+            if(shadow == DBL_MAX){ // the reservation cannot be computed, so do not risk delaying it
+                break;
+            }
+        }
+        else if(sched_info->makespan + app_estimate(app) <= shadow){
+            start_application(app, 1);
+        }
+        else if(app->size_tasks <= extra && start_application(app, 1)){
+            extra -= app->size_tasks;
+        }
+    }
+    if(sched_info->next_arrival == ULLONG_MAX){
+        // keep looking for the next arrival if the loop stopped before reaching it
+        while(list_next(&workload, (void*)&app)){
+            if(app->info.arrive_time > sched_info->makespan){
+                sched_info->next_arrival = app->info.arrive_time;
+                break;
+            }
+        }
+    }
+    sched_info->stopped = 1;
+    return(sched_info->next_arrival);
+}
+
+/**
+ * Conservative backfilling: every waiting application, in arrival order, gets a reservation in
+ * the availability profile at the earliest time it fits. Applications whose reservation is now
+ * are started, so no application can be delayed by any younger one.
+ */
+unsigned long long conservative_backfilling(){
+
+    long start, blocked = 0;
+    long min_size = LONG_MAX;
+    double duration;
+    profile_t profile;
+    application *app = NULL;
+
+    // The smallest waiting application: when there are less free cores, no other one can start now.
+    sched_info->next_arrival = ULLONG_MAX;
+    list_reset(&workload);
+    while(list_next(&workload, (void*)&app)){
+        if(app->info.arrive_time > sched_info->makespan){
+            sched_info->next_arrival = app->info.arrive_time;
+            break;
+        }
+        if(app->size_tasks < min_size){
+            min_size = app->size_tasks;
+        }
+    }
+
+    init_profile(&profile);
+    list_reset(&workload);
+    while(profile.free[0] >= min_size && list_next(&workload, (void*)&app)){
+        if(app->info.arrive_time > sched_info->makespan){
+            break;
+        }
+        duration = app_estimate(app);
+        start = profile_find(&profile, app->size_tasks, duration, 0);
+        if(start == 0){
+            if(start_application(app, blocked)){
+                profile_reserve(&profile, start, app->size_tasks, duration);
+                continue;
+            }
+            // enough cores, but the allocation policy could not find a suitable partition
+            start = profile_find(&profile, app->size_tasks, duration, 1);
+        }
+        blocked = 1;
+        if(start != -1){
+            profile_reserve(&profile, start, app->size_tasks, duration);
+        }
+    }
+    finish_profile(&profile);
+    sched_info->stopped = 1;
+    return(sched_info->next_arrival);
+}
+
 void finish_scheduling(long nservers){
     long i;
 
     free(sched_info->running_apps);
+    free(profile_apps);
+    finish_core_index();
     
     for(i = 0; i < nservers;i++){
         free(sched_info->servers[i].cores);
@@ -139,6 +477,9 @@ long available_servers(long switch_id, long *av_servers, long ports_servers){
     long server_id = switch_id * ports_servers;
     long available = 0;
 
+    if(core_index_switch_free(switch_id) == 0){ // all the cores under this switch are busy
+        return(0);
+    }
     for(i = 0; i < ports_servers; i++){
         if(sched_info->servers[server_id + i].busy_cores == 0 || (sched_info->servers[server_id + i].free_cores > 0 && sched_info->servers[server_id + i].cont == 0)){
             av_servers[available++] = server_id + i;
@@ -175,6 +516,9 @@ long are_available_servers(long switch_id, long ports_servers){
     long server_id = switch_id * ports_servers;
     long available = 0;
 
+    if(core_index_switch_free(switch_id) == 0){ // all the cores under this switch are busy
+        return(0);
+    }
     for(i = 0; i < ports_servers; i++){
         if(sched_info->servers[server_id + i].busy_cores == 0 || (sched_info->servers[server_id + i].free_cores > 0 && sched_info->servers[server_id + i].cont == 0)){
             available++;
@@ -25,7 +25,8 @@ typedef struct scheduling_info{
     double makespan;
     double last_makespan;
     
-    long *running_apps;
+    long *running_apps;     ///< running flag of each application, indexed by id
+    long running_apps_size; ///< number of entries allocated in running_apps
     long total_servers;
     long cores_server;
     long total_cores;
@@ -33,6 +34,7 @@ typedef struct scheduling_info{
     long free_cores;
     long inactive_cores;
     long stopped;
+    unsigned long long next_arrival; ///< arrival time of the next application that has not arrived yet
     server_t *servers;
     struct san_t *san;
 } scheduling_info;
@@ -45,6 +47,12 @@ void finish_scheduling(long nservers);
 
 unsigned long long fcfs();
 
+unsigned long long easy_backfilling();
+
+unsigned long long conservative_backfilling();
+
+void remove_profile_app(long app_id);
+
 long available_servers(long switch_id, long *av_servers, long ports_servers);
 
 long available_cores(long server_id, long *available_cores, long ports_servers);
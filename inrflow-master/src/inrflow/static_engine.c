@@ -3,6 +3,8 @@
 #include "topologies.h"
 #include "placement.h"
 #include "reporting.h"
+#include "failures.h"
+#include "profiler.h"
 
 #include <time.h>
 #include <stdlib.h>
@@ -19,79 +21,37 @@ long max_path_length=16;    ///< the maximum length of the path. will need updat
 long current_path_length=0; ///< current hop
 long long traffic_npairs;
 
-#ifdef MEASURE_ROUTING_TIME
-struct timespec prerouting_start;   ///< stores the starting time for prerouting @see init_routing. To be used later on to measure routing computation time.
-struct timespec prerouting_end;     ///< stores the starting time for prerouting @see init_routing. To be used later on to measure routing computation time.
-long long total_prerouting_time=0;  ///< stores the aggregated prerouting time.
-long prerouting_count=0;              ///< stores how many times we have prerouted.
-
-struct timespec hoprouting_start;   ///< stores the starting time for per hop routing @see route. To be used later on to measure routing computation time.
-struct timespec hoprouting_end;     ///< stores the starting time for per hop routing @see route. To be used later on to measure routing computation time.
-long long total_hoprouting_time=0;  ///< stores the aggregated hoprouting time.
-long hoprouting_count=0;              ///< stores how many times we have hoprouted.
-
-bool_t measuring;   ///< 0 if any error occurred.
-long measured;      ///< measured time in nsecs.
-#endif
-
 /**
  * Follows the route between servers i & j and update flow counts.
  * Side effects: If a path exists, update link_hops and server_hops
  *
  * @return 1 if there is a path between them, 0 otherwise.
  */
-long mark_route(long src, long dst)
+static long route_flow(long src, long dst)
 {
 	long current=src;
 	long next_port;
 	long lh=0, sh=0; ///< link and server hops
 	long i;
-
-#ifdef MEASURE_ROUTING_TIME
-  measuring=1;
-  if(clock_gettime(CLOCK_MODE, &prerouting_start)!=0){
-    perror("Error Measuring routing time.");
-    measuring=0;
-  }
-#endif
+	long routed;
 
 #ifdef FINEGRAINOUTPUT
     printf("Sending message from %ld to %ld\n", src, dst);
 #endif // FINEGRAINOUTPUT
 
-	if (init_routing(src, dst)==-1){
+	PROF_START(PROF_INIT_ROUTING);
+	routed=init_routing(src, dst);
+	PROF_END(PROF_INIT_ROUTING);
+	if (routed==-1){
 		finish_route();
 		return 0; // this pair of servers are disconnected;
 	}
-#ifdef MEASURE_ROUTING_TIME
-  if(clock_gettime(CLOCK_MODE , &prerouting_end)!=0){
-    perror("Error Measuring routing time.");
-    measuring=0;
-  }
-
-  if (measuring!=0){
-    measured=((prerouting_end.tv_sec-prerouting_start.tv_sec)*1e9L) + (prerouting_end.tv_nsec-prerouting_start.tv_nsec);
-    if (measured<0)
-      printf("negative prerouting time read! (%ld) %ld:%ld - %ld:%ld\n", measured, prerouting_end.tv_sec,prerouting_end.tv_nsec, prerouting_start.tv_sec,prerouting_start.tv_nsec);
-    else {
-      total_prerouting_time+=measured;
-      prerouting_count++;
-      if (total_prerouting_time<0)
-        printf("possible prerouting overflow (%lld)\n",total_prerouting_time);
-    }
-  }
-#endif
 //    printf("travelling from %ld towards %ld [ ",src, dst);
 	current_path_length=0;
 	while(current!=dst) {	// not at destination yet
-#ifdef MEASURE_ROUTING_TIME
-    measuring=1;
-    if(clock_gettime(CLOCK_MODE , &hoprouting_start)!=0){
-      perror("Error Measuring routing time.");
-      measuring=0;
-    }
-#endif
+		PROF_START(PROF_ROUTE);
 		next_port=route(current,dst);
+		PROF_END(PROF_ROUTE);
 
 #ifdef FINEGRAINOUTPUT
     printf("  %ld.%ld\n", current, next_port);
@@ -104,25 +64,6 @@ long mark_route(long src, long dst)
             return 0;
         }
 #endif // DEBUG
-#ifdef MEASURE_ROUTING_TIME
-		if(clock_gettime(CLOCK_MODE , &hoprouting_end)!=0){
-      perror("Error Measuring routing time.");
-      measuring=0;
-    }
-
-    if (measuring!=0){
-      measured=(hoprouting_end.tv_sec-hoprouting_start.tv_sec)*1e9L + (hoprouting_end.tv_nsec-hoprouting_start.tv_nsec);
-      if (measured<0)
-        printf("negative reading (%ld) %ld:%ld - %ld:%ld\n", measured, hoprouting_end.tv_sec,hoprouting_end.tv_nsec, hoprouting_start.tv_sec,hoprouting_start.tv_nsec);
-      else{
-        total_hoprouting_time+=measured;
-        hoprouting_count++;
-        if (total_hoprouting_time<0)
-          printf("possible overflow (%lld)\n",total_hoprouting_time);
-
-      }
-    }
-#endif
 
     if (next_port==-1 ||
         network[current].port[next_port].faulty ||
@@ -172,11 +113,23 @@ long mark_route(long src, long dst)
 	finish_route();
 
 	update_statistics(sh, lh);
-  update_trace_matrix(node_to_server(src),node_to_server(dst));
 
 	return 1;
 }
 
+/**
+ * Marks the route between servers i & j (see route_flow()) and adds the flow to the trace matrix.
+ *
+ * @return 1 if there is a path between them, 0 otherwise.
+ */
+long mark_route(long src, long dst)
+{
+	if (!route_flow(src, dst))
+		return 0;
+  update_trace_matrix(node_to_server(src),node_to_server(dst));
+	return 1;
+}
+
 /**
 * Performs a static run in which all of the flows are placed in the network and
 * use statistics are captured. Dynamic evolution of the system is not
@@ -210,3 +163,279 @@ void run_static()
 }
 
 
+
+/**
+ * A flow placed during a failure sweep.
+ */
+typedef struct sweep_flow_t {
+	long src;       ///< source node
+	long dst;       ///< destination node
+	long *path;     ///< output ports of the path, NULL if disconnected
+	long length;    ///< number of hops of the path
+	long sh;        ///< server hops of the path
+	long version;   ///< incremented every time the flow is re-routed
+} sweep_flow_t;
+
+/**
+ * Reverse index entry: a flow crossing a port. Entries whose version does not match the one of
+ * the flow are stale (the flow was re-routed) and are ignored.
+ */
+typedef struct port_flow_t {
+	long flow;
+	long version;
+} port_flow_t;
+
+/**
+ * Flows crossing a port.
+ */
+typedef struct port_index_t {
+	long n;
+	long max;
+	port_flow_t *entry;
+} port_index_t;
+
+static sweep_flow_t *sweep_flows;   ///< all the flows of the sweep
+static long sweep_nflows;           ///< number of flows
+static port_index_t *port_index;    ///< reverse index from port to flows
+static long *port_base;             ///< identifier of the first port of each node in the index
+
+extern char time_started[26];
+
+/**
+ * Routes a flow of the sweep using mark_route() and, if it is connected, stores its path and
+ * adds it to the reverse index of every port it crosses.
+ */
+static long mark_route_indexed(long f)
+{
+	sweep_flow_t *fl = &sweep_flows[f];
+	port_index_t *pi;
+	long current, i;
+
+	fl->path = NULL;
+	fl->length = 0;
+	fl->sh = 0;
+	// re-routed flows are already in the trace matrix
+	if (!(fl->version == 0 ? mark_route(fl->src, fl->dst) : route_flow(fl->src, fl->dst)))
+		return 0;
+
+	fl->length = current_path_length;
+	fl->path = malloc(fl->length * sizeof(long));
+	current = fl->src;
+	for (i = 0; i < fl->length; i++) {
+		fl->path[i] = partial_path[i];
+		if (is_server(current))
+			fl->sh++;
+		pi = &port_index[port_base[current] + partial_path[i]];
+		if (pi->n == pi->max) {
+			pi->max = (pi->max == 0) ? 4 : 2 * pi->max;
+			pi->entry = realloc(pi->entry, pi->max * sizeof(port_flow_t));
+		}
+		pi->entry[pi->n].flow = f;
+		pi->entry[pi->n].version = fl->version;
+		pi->n++;
+		current = network[current].port[partial_path[i]].neighbour.node;
+	}
+	return 1;
+}
+
+/**
+ * Removes a connected flow from the network, undoing the updates done by mark_route().
+ * Index entries are not removed, they become stale when the version of the flow changes.
+ */
+static void unmark_route_indexed(long f)
+{
+	sweep_flow_t *fl = &sweep_flows[f];
+	long current, i;
+
+	current = fl->src;
+	for (i = 0; i < fl->length; i++) {
+		network[current].port[fl->path[i]].flows--;
+		current = network[current].port[fl->path[i]].neighbour.node;
+	}
+	remove_statistics(fl->sh, fl->length);
+	connected--;
+	free(fl->path);
+	fl->path = NULL;
+	fl->version++;
+}
+
+/**
+ * Collects the (non-stale) flows crossing a port that has just failed. The index of the port is
+ * emptied, as no flow will cross it again.
+ *
+ * @return the number of flows added to affected.
+ */
+static long collect_affected(long node, long port, long *affected, long n_affected, char *stamp)
+{
+	port_index_t *pi = &port_index[port_base[node] + port];
+	long i, f;
+
+	for (i = 0; i < pi->n; i++) {
+		f = pi->entry[i].flow;
+		if (pi->entry[i].version == sweep_flows[f].version && !stamp[f]) {
+			stamp[f] = 1;
+			affected[n_affected++] = f;
+		}
+	}
+	pi->n = 0;
+	return n_affected;
+}
+
+/**
+ * Computes the statistics of the current step of the sweep and adds them to the results.
+ */
+static void sweep_step_stats(FILE *fd, long step, long rerouted, double runtime)
+{
+	struct key_value *stats_head = NULL;
+	long i, j, links = 0, max_flows = 0;
+	long long flows = 0;
+
+	for (i = 0; i < servers + switches; i++)
+		for (j = 0; j < network[i].nports; j++)
+			if (!network[i].port[j].faulty && network[i].port[j].neighbour.node != -1) {
+				links++;
+				flows += network[i].port[j].flows;
+				if (network[i].port[j].flows > max_flows)
+					max_flows = network[i].port[j].flows;
+			}
+
+	add_key_value(&stats_head, "step", "%ld", step);
+	add_key_value(&stats_head, "n.cable.failures", "%ld", n_failures);
+	add_key_value(&stats_head, "failure.rate", "%f", n_failures / (ports / 2.0));
+	add_key_value(&stats_head, "n.rerouted", "%ld", rerouted);
+	add_key_value(&stats_head, "n.server.pairs.connected", "%lld", connected);
+	add_key_value(&stats_head, "n.server.pairs.disconnected", "%lld", traffic_npairs - connected);
+	add_key_value(&stats_head, "p.server.pairs.connected", "%f", (traffic_npairs > 0) ? 100.0 * connected / traffic_npairs : 0.0);
+	add_key_value(&stats_head, "max.flows.per.link", "%ld", max_flows);
+	add_key_value(&stats_head, "mean.flows.per.link", "%f", (links > 0) ? (double)flows / links : 0.0);
+	add_key_value(&stats_head, "mean.path.length", "%f", (connected > 0) ? (double)link_hops / connected : 0.0);
+	add_key_value(&stats_head, "runtime", "%f", runtime);
+	reverse_list(&stats_head);
+	if (step == 0) {
+		print_keys(stats_head, fd);
+		if (verbose)
+			print_keys(stats_head, stdout);
+	}
+	print_values(stats_head, fd);
+	if (verbose)
+		print_values(stats_head, stdout);
+	finish_stats(&stats_head);
+}
+
+/**
+ * Performs a static run in which failures are added progressively, in sweep_steps steps, until
+ * reaching the configured number of failures (or failure rate). After each step only the flows
+ * crossing the newly failed links are re-routed, so a single run produces the evolution of
+ * connectivity and bottleneck from no failures up to the target.
+ *
+ * Topologies whose routing is precomputed in init_topo() do not see the new failures, so their
+ * flows may become disconnected instead of being routed around the failures.
+ */
+void run_failure_sweep()
+{
+	long done = 0;
+	flow_t flow;
+	long total_failures, step, n, i, node, port, f, n_affected, rerouted;
+	long *affected;
+	char *stamp;
+	long max_flows = 1024;
+	struct timespec start, end;
+	char filename[400];
+	FILE *fd;
+
+	total_failures = target_failures();
+	n_failures = 0;
+
+	init_stats();
+	init_placement(servers);
+	init_pattern(servers, traffic_nparam, traffic_params);
+
+	port_base = malloc((servers + switches + 1) * sizeof(long));
+	port_base[0] = 0;
+	for (i = 0; i < servers + switches; i++)
+		port_base[i + 1] = port_base[i] + network[i].nports;
+	port_index = calloc(port_base[servers + switches], sizeof(port_index_t));
+	sweep_flows = malloc(max_flows * sizeof(sweep_flow_t));
+	sweep_nflows = 0;
+	// same prefix as the stats file written by capture_statistics()
+	snprintf(filename, 400, "%s/%s_%s_%s_%s_fr%.2f_seed%ld.%s_sweep.dat",
+			output_dir,
+			get_network_token(),
+			get_filename_params(),
+			get_routing_token(),
+			placement_name,
+			failure_rate,
+			r_seed,
+			time_started);
+	if ((fd = fopen(filename, "w")) == NULL) {
+		perror("Unable to open sweep file");
+		exit(-1);
+	}
+
+	clock_gettime(CLOCK_MODE, &start);
+	partial_path = malloc(max_path_length * sizeof(long));
+	while (!done) {
+		flow = next_flow();
+		if (flow.src == -1 || flow.dst == -1)
+			done = 1;
+		else {
+			traffic_npairs++;
+			if (sweep_nflows == max_flows) {
+				max_flows *= 2;
+				sweep_flows = realloc(sweep_flows, max_flows * sizeof(sweep_flow_t));
+			}
+			sweep_flows[sweep_nflows].src = get_server_i(task_to_server(flow.src));
+			sweep_flows[sweep_nflows].dst = get_server_i(task_to_server(flow.dst));
+			sweep_flows[sweep_nflows].version = 0;
+			connected += mark_route_indexed(sweep_nflows);
+			sweep_nflows++;
+		}
+	}
+	clock_gettime(CLOCK_MODE, &end);
+	sweep_step_stats(fd, 0, 0, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+
+	affected = malloc(sweep_nflows * sizeof(long));
+	stamp = calloc(sweep_nflows, sizeof(char));
+	for (step = 1; step <= sweep_steps; step++) {
+		clock_gettime(CLOCK_MODE, &start);
+		n_affected = 0;
+		for (n = total_failures * (step - 1) / sweep_steps; n < total_failures * step / sweep_steps; n++) {
+			fail_random_link(&node, &port);
+			n_failures++;
+			n_affected = collect_affected(node, port, affected, n_affected, stamp);
+			n_affected = collect_affected(network[node].port[port].neighbour.node,
+					network[node].port[port].neighbour.port, affected, n_affected, stamp);
+		}
+		// remove all the affected flows before re-routing, so that new paths do not see them
+		for (i = 0; i < n_affected; i++)
+			unmark_route_indexed(affected[i]);
+		rerouted = 0;
+		for (i = 0; i < n_affected; i++) {
+			f = affected[i];
+			stamp[f] = 0;
+			if (mark_route_indexed(f)) {
+				connected++;
+				rerouted++;
+			}
+		}
+		clock_gettime(CLOCK_MODE, &end);
+		sweep_step_stats(fd, step, rerouted, (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9);
+	}
+	free(partial_path);
+	fclose(fd);
+	printf("Wrote failure sweep to file: %s\n", filename);
+	capture_statistics();
+
+	for (f = 0; f < sweep_nflows; f++)
+		free(sweep_flows[f].path);
+	for (i = 0; i < port_base[servers + switches]; i++)
+		free(port_index[i].entry);
+	free(sweep_flows);
+	free(port_index);
+	free(port_base);
+	free(affected);
+	free(stamp);
+	destroy_trace_matrix();
+	finish_traffic(traffic_nparam);
+	finish_placement();
+}
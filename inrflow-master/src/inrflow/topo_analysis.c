@@ -0,0 +1,365 @@
+/**
+ * @file
+ * @brief Built-in topological analysis: all-pairs server distances using bit-parallel BFS.
+ *
+ * Every BFS is run from 64 servers at once, keeping one bit per source in each word of the
+ * visited/frontier arrays. A level of the 64 searches is computed with a single pass over the
+ * links of the network, and batches of sources are processed by several threads. Links that
+ * are disconnected or faulty are not used, so this can be used to assess the impact of
+ * failures on distances and connectivity.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "globals.h"
+#include "misc.h"
+#include "reporting.h"
+#include "topo_analysis.h"
+
+extern long servers; ///< The total number of servers
+extern long switches;///< The total number of switches
+extern long ports;	///< The total number of ports in the topology
+
+/**
+ * Data shared by all the threads of the analysis.
+ */
+typedef struct analysis_t {
+    adjacency_t adj;
+    long *server_node;  ///< node id of each server
+    long *node_server;  ///< server id of each node (-1 for switches)
+    long nbatches;      ///< number of batches of 64 sources
+    long next_batch;    ///< next batch to be processed, updated atomically
+    long *eccentricity; ///< eccentricity of each server (within its connected component)
+} analysis_t;
+
+/**
+ * Per-thread data.
+ */
+typedef struct analysis_thread_t {
+    analysis_t *an;
+    uint64_t *visited;
+    uint64_t *frontier;
+    uint64_t *next;
+    long long *dist_hist;   ///< number of server pairs at each distance
+} analysis_thread_t;
+
+/**
+ * Builds the adjacency of the network, in CSR format, considering only usable links.
+ * For each node we store the nodes that can reach it in a single hop, so that a BFS level
+ * can be computed by pulling the frontier of the neighbours.
+ */
+void build_adjacency(adjacency_t *adj)
+{
+    long i, j, n, k;
+    long *fill;
+
+    adj->nnodes = servers + switches;
+    adj->offset = calloc(adj->nnodes + 1, sizeof(long));
+
+    for (i = 0; i < adj->nnodes; i++) {
+        for (j = 0; j < network[i].nports; j++) {
+            n = network[i].port[j].neighbour.node;
+            if (n != -1 && !network[i].port[j].faulty)
+                adj->offset[n + 1]++;
+        }
+    }
+    for (i = 0; i < adj->nnodes; i++)
+        adj->offset[i + 1] += adj->offset[i];
+
+    adj->neighbour = malloc(adj->offset[adj->nnodes] * sizeof(int32_t));
+    fill = malloc(adj->nnodes * sizeof(long));
+    memcpy(fill, adj->offset, adj->nnodes * sizeof(long));
+    for (i = 0; i < adj->nnodes; i++) {
+        for (j = 0; j < network[i].nports; j++) {
+            n = network[i].port[j].neighbour.node;
+            if (n != -1 && !network[i].port[j].faulty) {
+                k = fill[n]++;
+                adj->neighbour[k] = (int32_t)i;
+            }
+        }
+    }
+    free(fill);
+}
+
+void finish_adjacency(adjacency_t *adj)
+{
+    free(adj->offset);
+    free(adj->neighbour);
+}
+
+/**
+ * Runs the BFS from the 'nsrc' servers starting at 'base'.
+ */
+static void bfs_batch(analysis_thread_t *th, long base, long nsrc)
+{
+    analysis_t *an = th->an;
+    adjacency_t *adj = &an->adj;
+    long v, k, s, level;
+    uint64_t acc, reached, full, any;
+    uint64_t *tmp;
+
+    full = (nsrc == 64) ? ~(uint64_t)0 : (((uint64_t)1 << nsrc) - 1);
+    memset(th->visited, 0, adj->nnodes * sizeof(uint64_t));
+    memset(th->frontier, 0, adj->nnodes * sizeof(uint64_t));
+    for (s = 0; s < nsrc; s++) {
+        v = an->server_node[base + s];
+        th->visited[v] |= (uint64_t)1 << s;
+        th->frontier[v] |= (uint64_t)1 << s;
+        an->eccentricity[base + s] = 0;
+    }
+    th->dist_hist[0] += nsrc;
+
+    level = 0;
+    do {
+        level++;
+        any = 0;
+        reached = 0;
+        for (v = 0; v < adj->nnodes; v++) {
+            if (th->visited[v] == full) { // all the sources have already been here
+                th->next[v] = 0;
+                continue;
+            }
+            acc = 0;
+            for (k = adj->offset[v]; k < adj->offset[v + 1]; k++)
+                acc |= th->frontier[adj->neighbour[k]];
+            acc &= ~th->visited[v];
+            th->next[v] = acc;
+            if (acc) {
+                any = 1;
+                th->visited[v] |= acc;
+                if (an->node_server[v] != -1) {
+                    th->dist_hist[level] += __builtin_popcountll(acc);
+                    reached |= acc;
+                }
+            }
+        }
+        while (reached) {
+            s = __builtin_ctzll(reached);
+            an->eccentricity[base + s] = level;
+            reached &= reached - 1;
+        }
+        tmp = th->frontier;
+        th->frontier = th->next;
+        th->next = tmp;
+    } while (any);
+}
+
+static void *analysis_worker(void *arg)
+{
+    analysis_thread_t *th = (analysis_thread_t *)arg;
+    analysis_t *an = th->an;
+    long b, nsrc;
+
+    while ((b = __sync_fetch_and_add(&an->next_batch, 1)) < an->nbatches) {
+        nsrc = min(64, servers - (b * 64));
+        bfs_batch(th, b * 64, nsrc);
+    }
+    return NULL;
+}
+
+/**
+ * Labels the connected components of the network and counts the servers in each of them.
+ *
+ * @param comp component of each node.
+ * @return the number of components containing at least one server.
+ */
+static long connected_components(adjacency_t *adj, long *node_server, long *comp, long *comp_servers)
+{
+    long i, k, v, n, ncomp = 0, nserver_comp = 0;
+    long *queue, head, tail;
+
+    queue = malloc(adj->nnodes * sizeof(long));
+    for (i = 0; i < adj->nnodes; i++)
+        comp[i] = -1;
+    for (i = 0; i < adj->nnodes; i++) {
+        if (comp[i] != -1)
+            continue;
+        comp_servers[ncomp] = 0;
+        head = tail = 0;
+        queue[tail++] = i;
+        comp[i] = ncomp;
+        while (head < tail) {
+            v = queue[head++];
+            if (node_server[v] != -1)
+                comp_servers[ncomp]++;
+            for (k = adj->offset[v]; k < adj->offset[v + 1]; k++) {
+                n = adj->neighbour[k];
+                if (comp[n] == -1) {
+                    comp[n] = ncomp;
+                    queue[tail++] = n;
+                }
+            }
+        }
+        if (comp_servers[ncomp] > 0)
+            nserver_comp++;
+        ncomp++;
+    }
+    free(queue);
+    return nserver_comp;
+}
+
+/**
+ * Computes the distance distribution among all pairs of servers, the diameter, the eccentricity
+ * of every server and the connectivity of the network (honouring faulty links). Results are
+ * written to <prefix>_analysis.dat, <prefix>_analysis_hist.dat and <prefix>_analysis_ecc.dat.
+ */
+void run_topo_analysis()
+{
+    analysis_t an;
+    analysis_thread_t *th;
+    pthread_t *tid;
+    long nthreads, t, i, diameter = 0, max_ecc_server = -1, nserver_comp;
+    long long *dist_hist, connected_pairs = 0, total_dist = 0;
+    long *comp, *comp_servers, largest_comp = 0;
+    struct timespec start, end;
+    double runtime;
+    char prefix[300], filename[sizeof(output_dir) + 320];  // output_dir, prefix and the longest suffix
+    FILE *fd;
+    struct key_value *stats_head = NULL;
+
+    clock_gettime(CLOCK_MODE, &start);
+
+    build_adjacency(&an.adj);
+    an.server_node = malloc(servers * sizeof(long));
+    an.node_server = malloc(an.adj.nnodes * sizeof(long));
+    an.eccentricity = malloc(servers * sizeof(long));
+    for (i = 0; i < an.adj.nnodes; i++)
+        an.node_server[i] = -1;
+    for (i = 0; i < servers; i++) {
+        an.server_node[i] = get_server_i(i);
+        an.node_server[an.server_node[i]] = i;
+    }
+    an.nbatches = (servers + 63) / 64;
+    an.next_batch = 0;
+
+    nthreads = analysis_threads;
+    if (nthreads <= 0)
+        nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nthreads > an.nbatches)
+        nthreads = an.nbatches;
+    if (nthreads < 1)
+        nthreads = 1;
+
+    th = malloc(nthreads * sizeof(analysis_thread_t));
+    tid = malloc(nthreads * sizeof(pthread_t));
+    for (t = 0; t < nthreads; t++) {
+        th[t].an = &an;
+        th[t].visited = malloc(an.adj.nnodes * sizeof(uint64_t));
+        th[t].frontier = malloc(an.adj.nnodes * sizeof(uint64_t));
+        th[t].next = malloc(an.adj.nnodes * sizeof(uint64_t));
+        th[t].dist_hist = calloc(an.adj.nnodes + 1, sizeof(long long));
+        if (pthread_create(&tid[t], NULL, analysis_worker, &th[t]) != 0) {
+            perror("Unable to create analysis thread");
+            exit(-1);
+        }
+    }
+    dist_hist = calloc(an.adj.nnodes + 1, sizeof(long long));
+    for (t = 0; t < nthreads; t++) {
+        pthread_join(tid[t], NULL);
+        for (i = 0; i <= an.adj.nnodes; i++)
+            dist_hist[i] += th[t].dist_hist[i];
+        free(th[t].visited);
+        free(th[t].frontier);
+        free(th[t].next);
+        free(th[t].dist_hist);
+    }
+    free(th);
+    free(tid);
+
+    for (i = 0; i <= an.adj.nnodes; i++) {
+        if (dist_hist[i] > 0) {
+            diameter = i;
+            connected_pairs += dist_hist[i];
+            total_dist += dist_hist[i] * i;
+        }
+    }
+    for (i = 0; i < servers; i++)
+        if (max_ecc_server == -1 || an.eccentricity[i] > an.eccentricity[max_ecc_server])
+            max_ecc_server = i;
+
+    comp = malloc(an.adj.nnodes * sizeof(long));
+    comp_servers = malloc(an.adj.nnodes * sizeof(long));
+    nserver_comp = connected_components(&an.adj, an.node_server, comp, comp_servers);
+    for (i = 0; i < an.adj.nnodes; i++)
+        if (comp_servers[comp[i]] > largest_comp)
+            largest_comp = comp_servers[comp[i]];
+
+    clock_gettime(CLOCK_MODE, &end);
+    runtime = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+
+    sprintf(prefix, "%s_%s_%s_fr%.2f_seed%ld",
+            get_network_token(),
+            get_filename_params(),
+            get_routing_token(),
+            failure_rate,
+            r_seed);
+
+    add_key_value(&stats_head, "topology", "%s", get_network_token());
+    for (i = 0; i < topo_nparam; i++)
+        add_key_value(&stats_head, get_topo_param_tokens(i), "%ld", topo_params[i]);
+    add_key_value(&stats_head, "n.servers", "%ld", servers);
+    add_key_value(&stats_head, "n.switches", "%ld", switches);
+    add_key_value(&stats_head, "n.cables", "%ld", ports / 2);
+    add_key_value(&stats_head, "n.cable.failures", "%ld", n_failures);
+    add_key_value(&stats_head, "n.server.pairs.NN", "%lld", ((long long)servers) * servers);
+    add_key_value(&stats_head, "n.server.pairs.connected", "%lld", connected_pairs);
+    add_key_value(&stats_head, "p.server.pairs.connected", "%f", 100.0 * connected_pairs / ((double)servers * servers));
+    add_key_value(&stats_head, "n.components", "%ld", nserver_comp);
+    add_key_value(&stats_head, "largest.component.servers", "%ld", largest_comp);
+    add_key_value(&stats_head, "diameter", "%ld", diameter);
+    add_key_value(&stats_head, "mean.distance", "%f",
+            (connected_pairs > servers) ? (double)total_dist / (connected_pairs - servers) : 0.0);
+    add_key_value(&stats_head, "max.eccentricity.server", "%ld", max_ecc_server);
+    add_key_value(&stats_head, "n.threads", "%ld", nthreads);
+    add_key_value(&stats_head, "r.seed", "%ld", r_seed);
+    add_key_value(&stats_head, "runtime", "%f", runtime);
+    reverse_list(&stats_head);
+
+    snprintf(filename, sizeof(filename), "%s/%s_analysis.dat", output_dir, prefix);
+    if ((fd = fopen(filename, "w")) == NULL) {
+        perror("Unable to open analysis file");
+        exit(-1);
+    }
+    print_keys(stats_head, fd);
+    print_values(stats_head, fd);
+    fclose(fd);
+    print_key_value_pairs(stats_head, stdout);
+    finish_stats(&stats_head);
+    printf("Wrote analysis to file: %s\n", filename);
+
+    snprintf(filename, sizeof(filename), "%s/%s_analysis_hist.dat", output_dir, prefix);
+    if ((fd = fopen(filename, "w")) == NULL) {
+        perror("Unable to open analysis histogram file");
+        exit(-1);
+    }
+    fprintf(fd, "#Distance histogram (link hops, number of server pairs, normalised over connected pairs)\n");
+    fprintf(fd, "%9s %12s %9s\n", "d", "pairs", "npairs");
+    for (i = 0; i <= diameter; i++)
+        if (dist_hist[i] > 0)
+            fprintf(fd, "%9ld %12lld %1.7f\n", i, dist_hist[i], (double)dist_hist[i] / connected_pairs);
+    fclose(fd);
+
+    snprintf(filename, sizeof(filename), "%s/%s_analysis_ecc.dat", output_dir, prefix);
+    if ((fd = fopen(filename, "w")) == NULL) {
+        perror("Unable to open eccentricity file");
+        exit(-1);
+    }
+    fprintf(fd, "#Eccentricity of each server within its connected component\n");
+    fprintf(fd, "%9s %12s %12s\n", "server", "eccentricity", "reachable");
+    for (i = 0; i < servers; i++)
+        fprintf(fd, "%9ld %12ld %12ld\n", i, an.eccentricity[i], comp_servers[comp[an.server_node[i]]]);
+    fclose(fd);
+
+    free(dist_hist);
+    free(comp);
+    free(comp_servers);
+    free(an.server_node);
+    free(an.node_server);
+    free(an.eccentricity);
+    finish_adjacency(&an.adj);
+}
@@ -0,0 +1,30 @@
+/**
+ * @file
+ * @brief Built-in topological analysis: all-pairs server distances using bit-parallel BFS.
+ *
+ * Sources are processed in batches of 64 (one bit per source in a machine word), so every
+ * BFS level is a sweep over the links of the network OR-ing the frontier words of the
+ * neighbours. Batches are distributed among several threads.
+ */
+#ifndef _topo_analysis
+#define _topo_analysis
+
+#include <stdint.h>
+
+/**
+ * Compressed (CSR) adjacency of the network considering only usable links,
+ * i.e., connected and not faulty.
+ */
+typedef struct adjacency_t {
+    long nnodes;        ///< number of nodes (servers + switches)
+    long *offset;       ///< neighbours of node i are in [offset[i], offset[i+1])
+    int32_t *neighbour; ///< nodes from which there is an usable link towards i
+} adjacency_t;
+
+void build_adjacency(adjacency_t *adj);
+
+void finish_adjacency(adjacency_t *adj);
+
+void run_topo_analysis();
+
+#endif
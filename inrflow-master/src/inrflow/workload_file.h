@@ -0,0 +1,63 @@
+#ifndef _workload_file
+#define _workload_file
+
+/**
+ * Binary (compiled) workload files.
+ *
+ * Produced by tools/wl_compile from the text workload format. The file is a header followed by
+ * one fixed-size record per job, sorted by arrival time, and a table with every distinct name
+ * (pattern, allocation, mapping...) found in the workload. Jobs refer to names by their index
+ * in the table, so the names are resolved once when the file is opened instead of once per job.
+ *
+ * Records are stored in the native byte order and type sizes of the machine that compiled them.
+ */
+
+#define WLF_MAGIC "INRFWL01"    ///< First bytes of a binary workload file (also the format version).
+#define WLF_MAGIC_LEN 8
+#define WLF_MAX_PARAMS 12       ///< Pattern parameters stored per job.
+#define WLF_NAME_LEN 50         ///< Length of a name, including the terminating null character.
+#define WLF_NO_NAME -1          ///< Name index of an absent field (pattern file of non-file patterns).
+
+/**
+ * Fields of a job that refer to a name.
+ */
+typedef enum wlf_field_t {
+    WLF_PATTERN,
+    WLF_PATTERN_FILE,
+    WLF_ALLOCATION,
+    WLF_MAPPING,
+    WLF_STORAGE,
+    WLF_MEM_STG_ACCESS,
+    WLF_STG_NODES_ACCESS,
+    WLF_DATA_ACCESS_MODE,
+    WLF_FIELDS
+} wlf_field_t;
+
+typedef struct wlf_header_t {
+    char magic[WLF_MAGIC_LEN];
+    long n_jobs;    ///< Records following the header.
+    long n_names;   ///< Entries of the name table following the records.
+} wlf_header_t;
+
+typedef struct wlf_job_t {
+    unsigned long long arrive_time;
+    long size_tasks;
+    long size_storage;
+    long pattern_nparam;
+    long pattern_params[WLF_MAX_PARAMS];
+    long mem_storage_access_read;
+    long mem_storage_access_write;
+    long stg_nodes_access;
+    double estimate;    ///< 0 if the text workload did not give it.
+    int name[WLF_FIELDS];   ///< Index in the name table of every wlf_field_t, or WLF_NO_NAME.
+} wlf_job_t;
+
+/**
+ * An entry of the name table. The same string used in two fields gets two entries.
+ */
+typedef struct wlf_name_t {
+    long field;     ///< wlf_field_t of the name.
+    char name[WLF_NAME_LEN];
+} wlf_name_t;
+
+#endif
@@ -7,15 +7,36 @@
 #include "metrics.h"
 #include "globals.h"
 #include "workloads.h"
+#include "workload_file.h"
 #include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 metrics_t metrics;
 workload_t auto_wl; ///< parameters of the workload
 
+static wlf_header_t *wl_file = NULL;    ///< mapped binary workload, NULL when the workload is not streamed
+static size_t wl_file_size;
+static wlf_job_t *wl_jobs;      ///< records of the binary workload
+static wlf_name_t *wl_names;    ///< name table of the binary workload
+static int *wl_values;          ///< literal value of every entry of the name table
+static long wl_next;            ///< next record to be appended to the workload
+static application wl_app;      ///< application being built from the records
+
+/**
+ * Literals and descriptions of the fields of a binary workload, indexed by wlf_field_t.
+ */
+static literal_t *wl_literals[WLF_FIELDS] = {tpatterns_l, NULL, allocation_l, mapping_l, storage_l,
+    memory_storage_access_l, stg_nodes_access_l, data_access_mode_l};
+static char *wl_fields[WLF_FIELDS] = {"traffic pattern", "pattern file", "allocation strategy", "mapping strategy",
+    "storage strategy", "memory storage access strategy", "storage nodes access strategy", "data access mode"};
+
 void init_workload(list_t *workload){
 
     list_initialize(workload, sizeof(application));
@@ -24,7 +45,12 @@ void init_workload(list_t *workload){
         case NONE_APP:
             break;
         case FILE_APP:
-            read_applications_from_file(applications_file);
+            if(open_workload_file(applications_file)){
+                stream_workload(0);
+            }
+            else{
+                read_applications_from_file(applications_file);
+            }
             break;
         case AUTO_APP:
             generate_automatic_application(applications_file);
@@ -42,6 +68,7 @@ void read_applications_from_file(char *file){
     char pattern[50];
     char mem_storage_access[50];
     char stg_nodes_access[50];
+    char line[1024];
     char *pattern_aux;
     char *mem_storage_access_aux;
     char *stg_nodes_access_aux;
@@ -55,6 +82,7 @@ void read_applications_from_file(char *file){
     app.running = 0;
     app.num_servers = 0;
     app.tasks_finished = 0;
+    app.backfilled = 0;
     app.info.id = 1;
 
     if((fd = fopen(file, "r")) == NULL){
@@ -62,8 +90,13 @@ void read_applications_from_file(char *file){
         exit(-1);
     }
 
-    while(!feof(fd)){  
-        if(fscanf(fd,"%llu %s %ld %ld %s %s %s %s %s %s\n",&app.info.arrive_time, pattern, &app.size_tasks, &app.size_storage, app.allocation_type, app.mapping_type, app.storage_type, mem_storage_access, stg_nodes_access,app.data_access_mode_type) < 9){
+    while(fgets(line, 1024, fd) != NULL){
+        if(strspn(line, " \t\r\n") == strlen(line)){ // skip empty lines
+            continue;
+        }
+        // The last field, the runtime estimate used by backfilling schedulers, is optional.
+        app.estimate = 0;
+        if(sscanf(line,"%llu %s %ld %ld %s %s %s %s %s %s %lf",&app.info.arrive_time, pattern, &app.size_tasks, &app.size_storage, app.allocation_type, app.mapping_type, app.storage_type, mem_storage_access, stg_nodes_access,app.data_access_mode_type, &app.estimate) < 9){
             printf("Format of workload file is not correct.\n");
             exit(-1);
         } 
@@ -134,6 +167,165 @@ void read_applications_from_file(char *file){
     fclose(fd);
 }
 
+/**
+ * Maps a binary workload file (see workload_file.h) and resolves its name table. The jobs are
+ * appended to the workload later, by stream_workload().
+ *
+ * @return 1 if the file is a binary workload, 0 if it is a text one.
+ */
+long open_workload_file(char *file){
+
+    int fd;
+    struct stat st;
+    long i;
+
+    if((fd = open(file, O_RDONLY)) == -1){
+        printf("Error opening the workload file.\n");
+        exit(-1);
+    }
+    if(fstat(fd, &st) == -1 || st.st_size < (off_t)sizeof(wlf_header_t)){
+        close(fd);
+        return(0);
+    }
+    wl_file = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(wl_file == MAP_FAILED){
+        wl_file = NULL;
+        return(0);
+    }
+    if(memcmp(wl_file->magic, WLF_MAGIC, WLF_MAGIC_LEN) != 0){
+        munmap(wl_file, st.st_size);
+        wl_file = NULL;
+        return(0);
+    }
+    wl_file_size = st.st_size;
+    if(wl_file->n_jobs < 0 || wl_file->n_names < 0 || wl_file_size != sizeof(wlf_header_t) +
+            (wl_file->n_jobs * sizeof(wlf_job_t)) + (wl_file->n_names * sizeof(wlf_name_t))){
+        printf("Binary workload file is truncated or corrupt.\n");
+        exit(-1);
+    }
+    madvise(wl_file, wl_file_size, MADV_SEQUENTIAL);
+    wl_jobs = (wlf_job_t*)(wl_file + 1);
+    wl_names = (wlf_name_t*)(wl_jobs + wl_file->n_jobs);
+
+    wl_values = malloc(sizeof(int) * max(wl_file->n_names, 1));
+    for(i = 0; i < wl_file->n_names; i++){
+        if(wl_names[i].field < 0 || wl_names[i].field >= WLF_FIELDS || wl_names[i].name[WLF_NAME_LEN - 1] != '\0'){
+            printf("Binary workload file is truncated or corrupt.\n");
+            exit(-1);
+        }
+        wl_values[i] = 0;
+        if(wl_literals[wl_names[i].field] != NULL &&
+                !literal_value(wl_literals[wl_names[i].field], wl_names[i].name, &wl_values[i])){
+            printf("Error: Unknown %s - %s\n", wl_fields[wl_names[i].field], wl_names[i].name);
+            exit(-1);
+        }
+    }
+
+    init_metrics_application(&(wl_app.info));
+    wl_app.packets = 1024000; // 100 MB
+    wl_app.comp_time = 10;
+    wl_app.running = 0;
+    wl_app.num_servers = 0;
+    wl_app.tasks_finished = 0;
+    wl_app.backfilled = 0;
+    wl_next = 0;
+    return(1);
+}
+
+/**
+ * Name table entry of a field of a job, checking that it belongs to that field.
+ */
+static wlf_name_t *job_name(wlf_job_t *job, wlf_field_t field){
+
+    long n = job->name[field];
+
+    if(n < 0 || n >= wl_file->n_names || wl_names[n].field != field){
+        printf("Binary workload file is truncated or corrupt.\n");
+        exit(-1);
+    }
+    return(&wl_names[n]);
+}
+
+/**
+ * Copies the name and literal value of a field of a job into the application.
+ */
+static void job_field(wlf_job_t *job, wlf_field_t field, int *value, char *type){
+
+    wlf_name_t *name = job_name(job, field);
+
+    *value = wl_values[name - wl_names];
+    strncpy(type, name->name, WLF_NAME_LEN);
+}
+
+/**
+ * Appends to the workload the jobs of the binary workload that have arrived by the given time,
+ * plus the first one arriving later, so that the schedulers always know the next arrival. Jobs
+ * are only read (and copied into the workload) when the simulation gets to them.
+ */
+void stream_workload(double time){
+
+    long i, servers;
+    wlf_job_t *job;
+
+    if(wl_file == NULL){
+        return;
+    }
+    servers = get_servers();
+    while(wl_next < wl_file->n_jobs && (wl_next == 0 || wl_jobs[wl_next - 1].arrive_time <= time)){
+        job = &wl_jobs[wl_next++];
+        wl_app.info.id = wl_next;
+        wl_app.info.arrive_time = job->arrive_time;
+        wl_app.size_tasks = job->size_tasks;
+        wl_app.size_storage = job->size_storage;
+        if(wl_app.size_tasks > servers || wl_app.size_storage > servers){
+            printf("WARNING: Application %ld with size %ld and storage %ld is larger than the network: %ld.\n",wl_app.info.id,wl_app.size_tasks, wl_app.size_storage,  servers);
+            exit(-1);
+        }
+        wl_app.size = wl_app.size_tasks + wl_app.size_storage;
+        wl_app.estimate = job->estimate;
+
+        wl_app.pattern = wl_values[job_name(job, WLF_PATTERN) - wl_names];
+        if(job->name[WLF_PATTERN_FILE] != WLF_NO_NAME){
+            strncpy(wl_app.pattern_file, job_name(job, WLF_PATTERN_FILE)->name, WLF_NAME_LEN);
+        }
+        else{
+            wl_app.pattern_file[0] = '\0'; // do not inherit the file of the previous job
+        }
+        wl_app.pattern_nparam = min(max(job->pattern_nparam, 0), min(WLF_MAX_PARAMS, MAX_TRAFFIC_PARAMS));
+        for(i = 0; i < wl_app.pattern_nparam; i++)
+            wl_app.pattern_params[i] = job->pattern_params[i];
+        for(; i < MAX_TRAFFIC_PARAMS; i++)
+            wl_app.pattern_params[i] = -1; // undefine values, should not be checking these anyway.
+
+        job_field(job, WLF_ALLOCATION, (int *) &wl_app.allocation, wl_app.allocation_type);
+        job_field(job, WLF_MAPPING, (int *) &wl_app.mapping, wl_app.mapping_type);
+        job_field(job, WLF_STORAGE, (int *) &wl_app.storage, wl_app.storage_type);
+        job_field(job, WLF_MEM_STG_ACCESS, (int *) &wl_app.mem_stg_access, wl_app.mem_storage_access_type);
+        wl_app.mem_storage_access_read = job->mem_storage_access_read;
+        wl_app.mem_storage_access_write = job->mem_storage_access_write;
+        job_field(job, WLF_STG_NODES_ACCESS, (int *) &wl_app.stg_nodes_access_mode, wl_app.stg_nodes_access_mode_type);
+        wl_app.stg_nodes_access = job->stg_nodes_access;
+        job_field(job, WLF_DATA_ACCESS_MODE, (int *) &wl_app.data_access_mode, wl_app.data_access_mode_type);
+
+        wl_app.phases = wl_app.pattern_params[0];
+        list_append(&workload, &wl_app);
+    }
+}
+
+/**
+ * Releases the binary workload, if any.
+ */
+void finish_workload(){
+
+    if(wl_file == NULL){
+        return;
+    }
+    munmap(wl_file, wl_file_size);
+    free(wl_values);
+    wl_file = NULL;
+}
+
 void generate_automatic_application(){
 
     long n_apps = 0;
@@ -146,6 +338,8 @@ void generate_automatic_application(){
     app.running = 0;
     app.num_servers = 0;
     app.tasks_finished = 0;
+    app.estimate = 0;
+    app.backfilled = 0;
 
     if(auto_wl.max_size > (servers * server_cores)){
         printf("WARNING: Max application size %ld is larger than the network: %ld.\n",auto_wl.max_size, servers);
@@ -26,6 +26,12 @@ void init_workload(list_t *list);
 
 void read_applications_from_file(char *file);
 
+long open_workload_file(char *file);
+
+void stream_workload(double time);
+
+void finish_workload();
+
 void generate_automatic_application();
 
 long next_arrival_time(long previous);
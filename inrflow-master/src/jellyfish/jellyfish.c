@@ -24,7 +24,7 @@ static long c_path;
 long n_kpaths;
 
 static long servers;   ///< The total number of servers
-static long switches;  ///< The total number of switches
+extern long switches; ///< The total number of switches, also used by routing_jellyfish.c
 static long ports_network;	///< The total number of links
 static long total_ports;
 static long ports_switches;
@@ -38,90 +38,148 @@ void load_graph_from_file(graph_t *rg, char *fname){
 }
 
 /**
- * Generate the random graph that represents the network.
+ * Links port p1 of node n1 with port p2 of node n2.
  */
-void generate(graph_t *rg, long n, long p, long seed)
+static void link_ports(graph_t *rg, long n1, long p1, long n2, long p2)
 {
 
-    long i, j, k, l;
-    char statenew[256];
-    char *stateold;
-
-    stateold = initstate(seed, statenew, 256);
-
-    total_nodes = n;
+    rg[n1].edge[p1].neighbour.node = n2;
+    rg[n1].edge[p1].neighbour.edge = p2;
+    rg[n2].edge[p2].neighbour.node = n1;
+    rg[n2].edge[p2].neighbour.edge = p1;
+}
 
-    while(total_nodes > 1) {
-        i = random() % n;
-        j = random() % n;
+/**
+ * Number of links between two nodes.
+ */
+static long count_links(graph_t *rg, long n1, long n2)
+{
 
-        if(i == j || rg[i].fedges == 0 || rg[j].fedges == 0)
-            continue;
+    long i;
+    long links = 0;
 
-        if(are_connected(rg, i, j)) {
-            if(is_full_connected(rg,n)) {
-                k = random() % n;
-                while(k == i || k == j || are_connected(rg, i, k) || !is_difference(rg, k, j ,i, n)) {
-                    k = random() % n;
-                }
-                l = rg[k].edge[random() % rg[k].nedges].neighbour.node;
-                while(l == -1 || l == i || l == j || are_connected(rg, l, j))
-                    l = rg[k].edge[random() % rg[k].nedges].neighbour.node;
-
-                disconnect_nodes(rg, k, l);
-                connect_nodes(rg, k, i);
-                connect_nodes(rg, l, j);
-            } 
-            else {
-                continue;
-            }
-        } else {
-            connect_nodes(rg, i, j);
-        }
+    for(i = 0; i < rg[n1].nedges; i++) {
+        if(rg[n1].edge[i].neighbour.node == n2)
+            links++;
     }
-    setstate(stateold);
+    return(links);
 }
 
 /**
- * Checks if a current subgraph is fully connected.
+ * Pairs the stubs in the (shuffled) order they are and removes the self-loops and multi-edges
+ * with degree-preserving edge switches: the bad link a-b and a random link c-d become a-c and
+ * b-d, provided that neither of them is a self-loop or already exists.
+ *
+ * @return 1 if the graph is simple, 0 if some bad link could not be switched.
  */
-long is_full_connected(graph_t *rg, long n)
+static long pair_stubs(graph_t *rg, long *stub_node, long *stub_port, long nstubs)
 {
 
-    long i, j;
+    long s, t, tries;
+    long a, pa, b, pb, c, pc, d, pd;
 
-    for(i = 0; i < n; i++) {
-        if(rg[i].fedges != 0) {
-            for(j = i + 1; j < n; j++) {
-                if(rg[j].fedges != 0) {
-                    if(!are_connected(rg, i,  j)) {
-                        return 0;
-                    }
-                }
-            }
+    for(s = 0; s < nstubs; s += 2)
+        link_ports(rg, stub_node[s], stub_port[s], stub_node[s + 1], stub_port[s + 1]);
+
+    for(s = 0; s < nstubs; s += 2) {
+        a = stub_node[s];
+        pa = stub_port[s];
+        b = rg[a].edge[pa].neighbour.node;
+        pb = rg[a].edge[pa].neighbour.edge;
+        if(a != b && count_links(rg, a, b) == 1)
+            continue;
+        for(tries = 0; tries < 100 * nstubs; tries++) {
+            // a random stub is a random link, in a random direction
+            t = random() % nstubs;
+            c = stub_node[t];
+            pc = stub_port[t];
+            d = rg[c].edge[pc].neighbour.node;
+            pd = rg[c].edge[pc].neighbour.edge;
+            if((c == a && pc == pa) || (c == b && pc == pb) ||
+               a == c || b == d || (a == b && c == d) || (a == d && b == c) ||
+               are_connected(rg, a, c) || are_connected(rg, b, d))
+                continue;
+            link_ports(rg, a, pa, c, pc);
+            link_ports(rg, b, pb, d, pd);
+            break;
         }
+        if(tries == 100 * nstubs)
+            return 0;
     }
     return 1;
 }
 
 /**
- * Check if the difference (A - B) is empty.
+ * Generate the random graph that represents the network.
+ *
+ * Uses the configuration model: every free port is a stub, the stubs are shuffled and paired,
+ * and the self-loops and multi-edges are removed with edge switches (see pair_stubs), which
+ * does not change the degree of any node. When the number of stubs is odd, one port is left
+ * unconnected.
  */
-long is_difference(graph_t *rg, long node_ref, long node_ref2, long node, long n)
+void generate(graph_t *rg, long n, long p, long seed)
 {
 
-    long i, j;
-    long node_ref_aux;
+    long i, j, s, tmp;
+    long nstubs, attempts;
+    long *stub_node, *stub_port;
+    char statenew[256];
+    char *stateold;
+
+    if(p >= n) {
+        printf("A random regular graph of %ld nodes cannot have degree %ld.\n", n, p);
+        exit(-1);
+    }
+    stateold = initstate(seed, statenew, 256);
 
-    for(i = 0; i < rg[node_ref].nedges; i++) {
-        node_ref_aux = rg[node_ref].edge[i].neighbour.node;
-        for(j = 0; j < rg[node_ref2].nedges; j++) {
-            if( node_ref_aux != -1 && node_ref_aux != node_ref2 && node_ref_aux != node && node_ref_aux != rg[node_ref].edge[j].neighbour.node) {
-                return 1;
+    nstubs = 0;
+    for(i = 0; i < n; i++)
+        nstubs += rg[i].fedges;
+    stub_node = malloc(sizeof(long) * nstubs);
+    stub_port = malloc(sizeof(long) * nstubs);
+    s = 0;
+    for(i = 0; i < n; i++) {
+        for(j = 0; j < rg[i].nedges; j++) {
+            if(rg[i].edge[j].neighbour.node == -1) {
+                stub_node[s] = i;
+                stub_port[s] = j;
+                s++;
             }
         }
     }
-    return 0;
+
+    for(attempts = 0; ; attempts++) {
+        if(attempts == 100) {
+            printf("Could not generate a random regular graph of %ld nodes and degree %ld.\n", n, p);
+            exit(-1);
+        }
+        for(s = nstubs - 1; s > 0; s--) {
+            j = random() % (s + 1);
+            tmp = stub_node[s];
+            stub_node[s] = stub_node[j];
+            stub_node[j] = tmp;
+            tmp = stub_port[s];
+            stub_port[s] = stub_port[j];
+            stub_port[j] = tmp;
+        }
+        if(pair_stubs(rg, stub_node, stub_port, nstubs - (nstubs % 2)))
+            break;
+        for(s = 0; s < nstubs; s++) {
+            rg[stub_node[s]].edge[stub_port[s]].neighbour.node = -1;
+            rg[stub_node[s]].edge[stub_port[s]].neighbour.edge = -1;
+        }
+    }
+
+    total_nodes = 0;
+    for(s = 0; s < nstubs - (nstubs % 2); s++)
+        rg[stub_node[s]].fedges--;
+    for(i = 0; i < n; i++) {
+        if(rg[i].fedges != 0)
+            total_nodes++;
+    }
+    free(stub_node);
+    free(stub_port);
+    setstate(stateold);
 }
 
 /**
@@ -33,10 +33,6 @@ void load_graph_from_file(graph_t *rg, char *fname);
 
 void generate(graph_t *rg, long n, long k, long seed);
 
-long is_full_connected(graph_t *rg, long n);
-
-long is_difference(graph_t *rg, long node_ref, long node_ref2, long node, long n);
-
 long are_connected(graph_t *rg, long n1, long n2);
 
 void connect_nodes(graph_t *rg, long n1, long n2);
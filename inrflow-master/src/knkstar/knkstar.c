@@ -29,7 +29,7 @@ static char* topo_version="v0.2.0";
 static char* topo_param_tokens[3]= {"k", "n", "retries"};
 static char filename_params[100]; ///< a substring of the output filenames
 
-static struct path_t *path=NULL, *path_tail=NULL, *path_penultimate;
+static struct path_t path; ///< route built by init_routing and consumed by route
 
 /**
  * Compute and store route from 'src' to 'dst', if it exists, in
@@ -130,6 +130,7 @@ long init_topo_knkstar(long nparam, long* params)
 	servers=switches*(param_n-1)*param_k;
 
 	RA = malloc(param_k*param_n*sizeof(long));
+	init_path(&path, 8*(param_k+1));
 
 	construct_labels();
 
@@ -138,6 +139,7 @@ long init_topo_knkstar(long nparam, long* params)
 
 void finish_topo_knkstar()
 {
+	free_path(&path);
 	//I SHOULD FREE LABELS
 	//for i in labels free(label[i]);
 	//free(label);
@@ -281,12 +283,12 @@ long init_routing_knkstar(long src, long dst)
 	long route_result =  route_full(src,dst,retries);
 
 #ifdef DEBUG
-	if(route_result!=1 && !path_is_null(path)) {
+	if(route_result!=1 && !path_is_null(&path)) {
 		printf("route_result %ld,i=%ld and j=%ld but path is not null\n",route_result, src,dst);
-		print_path(path);
+		print_path(&path);
 		exit(-1);
 	}
-	if(route_result == 1 && src != dst && path_is_null(path)) {
+	if(route_result == 1 && src != dst && path_is_null(&path)) {
 		printf("Path is connected but null, i=%ld, j=%ld\n",src,dst);
 		exit(-1);
 	}
@@ -296,31 +298,28 @@ long init_routing_knkstar(long src, long dst)
 	//don't need to check that route_result==1, since the path MUST be
 	//valid if it is non-null.
 	long current=global_src;
-	struct path_t *current_path = path;
-	while(current_path!=NULL) {
-		if(network[current].port[current_path->port].faulty) {
+	long h;
+	for(h=path.head; h<path.length; h++) {
+		if(network[current].port[path.port[h]].faulty) {
 			//There are no disconnected ports in knkstar ||
-			//network[current].port[current_path->port].neighbour.node ==
+			//network[current].port[path.port[h]].neighbour.node ==
 			//-1){
 			current=global_src;
 			printf("      Node  is_server       port  is_faulty  neighbour\n");
-			current_path=path;
-			while(current_path!=NULL) {
+			for(h=path.head; h<path.length; h++) {
 				printf( "%10ld %10ld %10ld %10ld %10ld\n",
-				        current, is_server_knkstar(current),current_path->port,
-				        network[current].port[current_path->port].faulty,
-				        network[current].port[current_path->port].neighbour.node);
-				current = network[current].port[current_path->port].neighbour.node;
-				current_path=current_path->next;
+				        current, is_server_knkstar(current),path.port[h],
+				        network[current].port[path.port[h]].faulty,
+				        network[current].port[path.port[h]].neighbour.node);
+				current = network[current].port[path.port[h]].neighbour.node;
 			}
 			printf("Using a bad port in a reportedly good path in knkstar (but check the output above).\n"
 			       "src=%ld dst=%ld.\n",global_src,global_dst);
-			print_path(path);
+			print_path(&path);
 
 			exit(-1);
 		}
-		current = network[current].port[current_path->port].neighbour.node;
-		current_path=current_path->next;
+		current = network[current].port[path.port[h]].neighbour.node;
 	}
 #endif //DEBUG
 
@@ -329,13 +328,13 @@ long init_routing_knkstar(long src, long dst)
 
 void finish_route_knkstar()
 {
-	empty_path(&path,&path_tail);
+	empty_path(&path);
 
 }
 
 long route_knkstar(long current, long destination)
 {
-	return path_dequeue(&path,&path_tail);
+	return path_dequeue(&path);
 }
 
 ///< End of knkstar.h functions.  Begin static functions
@@ -346,7 +345,7 @@ static long route_full(long src, long dst, long retries)
 	long intermediate;
 
 #ifdef DEBUG
-	struct path_t *t1=path_tail;
+	long t1 = path_mark(&path);
 #endif
 
 	if(route_recursive(src, dst,0)==1)
@@ -356,8 +355,8 @@ static long route_full(long src, long dst, long retries)
 		return 1;
 
 #ifdef DEBUG
-	if(t1!=path_tail) {
-		printf("path_tail has changed after failing route_recursive");
+	if(t1!=path_mark(&path)) {
+		printf("path has changed after failing route_recursive");
 
 		exit(-1);
 	}
@@ -371,7 +370,7 @@ static long route_full(long src, long dst, long retries)
 		} else //we don't do any retries while retrying, so this is correct.
 			//may have to empty the path from src to intermediate for next
 			//iteration of loop.
-			empty_path(&path,&path_tail);
+			empty_path(&path);
 	}
 	return -1;
 }
@@ -380,8 +379,8 @@ static long route_recursive(long src, long dst, long retry)
 {
 	long i=-1,j=-1,found_one=-1;
 	long next_node=-1,port=-1,p=-1,tryport=-1,node_up=-1,node_vp=-1,node_u=-1,ua=-1,tmp=-1;
-	struct path_t *t1, *t2;
-	t1 = path_tail;
+	long t1, t2; // bookmarks in the path
+	t1 = path_mark(&path);
 	if(src==dst)
 		return 1;
 	if((next_node = switchOf(src)) ==switchOf(dst)) {
@@ -390,8 +389,7 @@ static long route_recursive(long src, long dst, long retry)
 		        (next_node=append_to_path(next_node,p))!=-1) {
 			return 1;
 		} else {
-			path_tail = t1;
-			delete_tail(&path,path_tail);
+			delete_tail(&path,t1);
 			if(!retry) {
 				return -1;
 			} else {
@@ -399,7 +397,7 @@ static long route_recursive(long src, long dst, long retry)
 					//first try the node_up to node_vp path.
 
 					i=label[src][param_k];
-					t2 = path_tail;
+					t2 = path_mark(&path);
 					node_u = switchOf(src);
 					//node_v = switchOf(dst);// not needed since node_v == node_u;
 					node_up = switchOf(network[src].port[1].neighbour.node);
@@ -430,8 +428,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 						return 1;
 					} else {
-						path_tail=t2;
-						delete_tail(&path,path_tail);
+						delete_tail(&path,t2);
 					}// short case failed, so continue
 					//short case failed, so do case XDR or XDY or XDJ
 					if (network[src].port[0].faulty != 0 && network[switchOf(dst)].port[network[dst].port[0].neighbour.port].faulty == 0) {
@@ -440,7 +437,7 @@ static long route_recursive(long src, long dst, long retry)
 						init_RA(param_n);
 						rand_RA(param_n);
 						for(ua = 0; ua < param_n; ua++) {
-							t2 = path_tail;
+							t2 = path_mark(&path);
 							node_u = switchOf(src);
 							//node_v = switchOf(dst);// not needed since node_v == node_u;
 							node_up = switchOf(network[src].port[1].neighbour.node);
@@ -466,8 +463,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 								return 1;
 							} else {
-								path_tail = t2;
-								delete_tail(&path,path_tail);
+								delete_tail(&path,t2);
 							}
 						}
 					}
@@ -477,7 +473,7 @@ static long route_recursive(long src, long dst, long retry)
 						init_RA(param_n);
 						rand_RA(param_n);
 						for(ua = 0; ua < param_n; ua++) {
-							t2 = path_tail;
+							t2 = path_mark(&path);
 							node_u = switchOf(src);
 							//node_v = switchOf(dst);// not needed since node_v == node_u;
 							node_up = switchOf(network[src].port[1].neighbour.node);
@@ -503,8 +499,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 								return 1;
 							} else {
-								path_tail = t2;
-								delete_tail(&path,path_tail);
+								delete_tail(&path,t2);
 							}
 						}
 
@@ -516,7 +511,7 @@ static long route_recursive(long src, long dst, long retry)
 					rand_RA(param_n);
 					i=label[src][param_k];
 					for(ua = 0; ua < param_n; ua++) {
-						t2 = path_tail;
+						t2 = path_mark(&path);
 						node_u = switchOf(src);
 						//node_v = switchOf(dst);// not needed since node_v == node_u;
 						node_up = switchOf(network[src].port[1].neighbour.node);
@@ -543,8 +538,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 							return 1;
 						} else {
-							path_tail = t2;
-							delete_tail(&path,path_tail);
+							delete_tail(&path,t2);
 						}
 					}
 					return -1;// we won't try anything else.
@@ -559,7 +553,7 @@ static long route_recursive(long src, long dst, long retry)
 						init_RA(param_n);
 						rand_RA(param_n);
 						for(ua = 0; ua < param_n; ua++) {
-							t2 = path_tail;
+							t2 = path_mark(&path);
 							node_u = switchOf(src);
 							//node_v = switchOf(dst);// not needed since node_v == node_u;
 							node_up = switchOf(network[src].port[1].neighbour.node);
@@ -583,8 +577,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 								return 1;
 							} else {
-								path_tail = t2;
-								delete_tail(&path,path_tail);
+								delete_tail(&path,t2);
 							}
 						}
 					}
@@ -595,7 +588,7 @@ static long route_recursive(long src, long dst, long retry)
 						init_RA(param_n);
 						rand_RA(param_n);
 						for(ua = 0; ua < param_n; ua++) {
-							t2 = path_tail;
+							t2 = path_mark(&path);
 							node_u = switchOf(src);
 							node_vp = switchOf(network[dst].port[1].neighbour.node);
 							if(RA[ua] != label[node_vp][j] &&
@@ -618,8 +611,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 								return 1;
 							} else {
-								path_tail = t2;
-								delete_tail(&path,path_tail);
+								delete_tail(&path,t2);
 							}
 						}
 
@@ -630,7 +622,7 @@ static long route_recursive(long src, long dst, long retry)
 
 					i=label[src][param_k];
 					j=label[dst][param_k];
-					t2 = path_tail;
+					t2 = path_mark(&path);
 					node_u = switchOf(src);
 					//node_v = switchOf(dst);// not needed since node_v == node_u;
 					node_up = switchOf(network[src].port[1].neighbour.node);
@@ -654,8 +646,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 						return 1;
 					} else {
-						path_tail=t2;
-						delete_tail(&path,path_tail);
+						delete_tail(&path,t2);
 					}// short case failed, so continue
 
 
@@ -666,7 +657,7 @@ static long route_recursive(long src, long dst, long retry)
 					init_RA(param_n);
 					rand_RA(param_n);
 					for(ua = 0; ua < param_n; ua++) {
-						t2 = path_tail;
+						t2 = path_mark(&path);
 						node_u = switchOf(src);
 						//node_v = switchOf(dst);// not needed since node_v == node_u;
 						node_up = switchOf(network[src].port[1].neighbour.node);
@@ -695,8 +686,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 							return 1;
 						} else {
-							path_tail=t2;
-							delete_tail(&path,path_tail);
+							delete_tail(&path,t2);
 						}
 					}
 					//caase LKV kyoto
@@ -705,7 +695,7 @@ static long route_recursive(long src, long dst, long retry)
 					init_RA(param_n);
 					rand_RA(param_n);
 					for(ua = 0; ua < param_n; ua++) {
-						t2 = path_tail;
+						t2 = path_mark(&path);
 						node_u = switchOf(src);
 						//node_v = switchOf(dst);// not needed since node_v == node_u;
 						node_up = switchOf(network[src].port[1].neighbour.node);
@@ -734,8 +724,7 @@ static long route_recursive(long src, long dst, long retry)
 #endif
 							return 1;
 						} else {
-							path_tail=t2;
-							delete_tail(&path,path_tail);
+							delete_tail(&path,t2);
 						}
 					}
 					return -1;
@@ -751,8 +740,7 @@ static long route_recursive(long src, long dst, long retry)
 			if(label[src][param_k]==i &&
 			        (label[dst][i]==label[src][param_k+1])) {
 				if((next_node = append_to_path(src,1))==-1) {
-					path_tail = t1;
-					delete_tail(&path,path_tail);
+					delete_tail(&path,t1);
 					if(retry) {
 						//WARNING: THIS BIT OF CODE WILL INTRODUCE AN EXTRA SERVER HOP
 						//UNNECESSARILY if at the end, next_node is not equal to dst.
@@ -792,8 +780,7 @@ static long route_recursive(long src, long dst, long retry)
 								found_one = 1;
 								break;
 							} else {
-								path_tail = t1;
-								delete_tail(&path,path_tail);
+								delete_tail(&path,t1);
 								return -1;
 							}
 						}
@@ -804,17 +791,16 @@ static long route_recursive(long src, long dst, long retry)
 			} else {
 				//-src-(dimension i)-u--server--server.  u is a switch
 				if((next_node=append_to_path(src,0))==-1) {
-					path_tail = t1;
-					delete_tail(&path,path_tail);
+					delete_tail(&path,t1);
 					j = label[src][param_k];
-					if(path_is_null(path)) { // && i!=j){
+					if(path_is_null(&path)) { // && i!=j){
 						//we need to reroute to the switch through other dimensions.  a few special cases to consider.  It only makes sense to do this at the top level, since otherwise we would backtrack to try other approaches.
 						init_RA(param_n);
 						rand_RA(param_n);
 						for(ua=0; ua<param_n; ua++) {
 							//CASE YVR SYDNEY
 							found_one = 0;
-							t1=path_tail;
+							t1 = path_mark(&path);
 							tmp = network[
 							          network[switchOf(src)].port[
 							              get_port_to_server(switchOf(src),i,label[dst][i])
@@ -857,9 +843,8 @@ static long route_recursive(long src, long dst, long retry)
 									if(route_recursive(next_node,dst,retry)==1) {
 										return 1;
 									} else {
-										path_tail = t1;
-										delete_tail(&path,path_tail);
-										if(!path_is_null(path)) {
+										delete_tail(&path,t1);
+										if(!path_is_null(&path)) {
 											printf("boo");
 											exit(-1);
 										}
@@ -870,8 +855,7 @@ static long route_recursive(long src, long dst, long retry)
 								found_one = 1;
 								break;
 							} else {
-								path_tail = t1;
-								delete_tail(&path,path_tail);
+								delete_tail(&path,t1);
 							}
 						}
 						if (found_one==0) {
@@ -886,14 +870,13 @@ static long route_recursive(long src, long dst, long retry)
 				//to server (u,i,uip), where u is switchOf(src) and uip is
 				//ith pos of switchOf(dst), via port "port"
 				port = get_port_to_server(next_node,i,label[dst][i]);
-				t2 = path_tail;//bookmark our place in the list
+				t2 = path_mark(&path);//bookmark our place in the list
 				if((next_node = append_to_path(next_node,port))!=-1 &&
 				        (next_node = append_to_path(next_node,1))!=-1) {
 					found_one = 1;
 				} else {
 					//undo what was done in the if statement
-					path_tail = t2;
-					delete_tail(&path,path_tail);
+					delete_tail(&path,t2);
 					//set next_node.
 					next_node = switchOf(src);//network[src].port[0].neighbour.node;
 					// we need this here because next_node=-1
@@ -907,7 +890,7 @@ static long route_recursive(long src, long dst, long retry)
 						for(tryport=0; tryport<param_n-1; tryport++) {
 							//bookmark our place
 							//found_one = 0;
-							t2=path_tail;
+							t2 = path_mark(&path);
 							next_node = network[src].port[0].neighbour.node;//already appended up to here
 							if((RA[tryport] + i*(param_n-1)) != port &&
 							        (next_node = append_to_path(next_node, RA[tryport] + i*(param_n-1))) != -1 &&
@@ -922,8 +905,7 @@ static long route_recursive(long src, long dst, long retry)
 								found_one = 1;
 								break;
 							} else {
-								path_tail = t2;
-								delete_tail(&path,path_tail);
+								delete_tail(&path,t2);
 							}
 						}
 					}
@@ -932,14 +914,11 @@ static long route_recursive(long src, long dst, long retry)
 			if(found_one == 1 && route_recursive(next_node,dst,retry)==1)
 				return 1;
 			else {
-				path_tail = t1;
-				delete_tail(&path,path_tail);
-				t1 = path_tail;
+				delete_tail(&path,t1);
 			}
 		}
 	}
-	path_tail = t1;
-	delete_tail(&path,path_tail);
+	delete_tail(&path,t1);
 	return -1;
 }
 
@@ -964,7 +943,7 @@ static long append_to_path(long node, long port)
 #endif
 	if(network[node].port[port].faulty!=0)
 		return -1;
-	path_enqueue(&path,&path_tail, &path_penultimate,port);
+	path_enqueue(&path,port);
 	return network[node].port[port].neighbour.node;
 }
 
@@ -26,7 +26,7 @@ static char* topo_version="v0.2.1";
 static char* topo_param_tokens[2]= {"k", "n"};
 static char filename_params[100]; ///< a substring of the output filenames
 
-static struct path_t *path=NULL, *path_tail=NULL, *path_penultimate;
+static struct path_t path; ///< route built by init_routing and consumed by route
 
 /**
  * Compute and store route from 'src' to 'dst', if it exists, in
@@ -155,6 +155,7 @@ long init_topo_swcube(long nparam, long* params)
 	n_choose_2 = param_n*(param_n-1)/2;
 	switches=n_pow[param_k];
 	servers=switches*(param_n-1)*param_k/2;
+	init_path(&path, 4*(param_k+1));
 
 	construct_labels();
 
@@ -164,6 +165,8 @@ long init_topo_swcube(long nparam, long* params)
 void finish_topo_swcube()
 {
 	long i;
+
+	free_path(&path);
 	for(i=0; i<switches+servers; i++) {
 		free(label[i]);
 	}
@@ -309,12 +312,12 @@ long init_routing_swcube(long src, long dst)
 {
 	long route_result =  route_full(src,dst);
 #ifdef DEBUG
-	if(route_result!=1 && !path_is_null(path)) {
+	if(route_result!=1 && !path_is_null(&path)) {
 		printf("route_result %ld,src=%ld and dst=%ld but path is not null\n",route_result, src,dst);
-		print_path(path);
+		print_path(&path);
 		exit(-1);
 	}
-	if(route_result == 1 && src != dst && path_is_null(path)) {
+	if(route_result == 1 && src != dst && path_is_null(&path)) {
 		printf("Path is connected but null, src=%ld, dst=%ld\n",src,dst);
 		exit(-1);
 	}
@@ -327,9 +330,9 @@ long init_routing_swcube(long src, long dst)
 void finish_route_swcube()
 {
 #ifdef DEBUG
-	if(!path_is_null(path)) {
+	if(!path_is_null(&path)) {
 		printf("mark_route failed to empty the path\n");
-		print_path(path);
+		print_path(&path);
 		exit(-1);
 	}
 #endif //DEBUG
@@ -337,7 +340,7 @@ void finish_route_swcube()
 
 long route_swcube(long current, long destination)
 {
-	return path_dequeue(&path,&path_tail);
+	return path_dequeue(&path);
 }
 
 ///< End swcube.h functions
@@ -386,7 +389,7 @@ static long route_full(long src, long dst)
 				   )
 				        == -1
 				  ) {
-					empty_path(&path,&path_tail);
+					empty_path(&path);
 					return -1;
 				}
 				//next_node is now a switch and we need to get to the server
@@ -409,7 +412,7 @@ static long route_full(long src, long dst)
 				if((next_node = append_to_path(next_node,rand()%2))==-1)
 #endif
 				{
-					empty_path(&path,&path_tail);
+					empty_path(&path);
 					return -1;
 				}
 
@@ -439,13 +442,13 @@ static long route_full(long src, long dst)
 			                    label[dst][i]
 			                )
 			            ))==-1) {
-				empty_path(&path,&path_tail);
+				empty_path(&path);
 				return -1;
 			}
 		}
 #ifdef DEBUG
 		if(coordinates_intersect(next_node,dst,i)==-1) {
-			empty_path(&path,&path_tail);
+			empty_path(&path);
 			return -1;
 		}
 #endif
@@ -471,7 +474,7 @@ static long route_full(long src, long dst)
 		              append_to_path(next_node,
 		                             network[dst].port[tmp2].neighbour.port))==-1)
 		  ) {
-			empty_path(&path,&path_tail);
+			empty_path(&path);
 			return -1;
 		}
 		return 1;
@@ -489,7 +492,7 @@ static long append_to_path(long node, long port)
 #endif
 	if(network[node].port[port].faulty!=0)
 		return -1;
-	path_enqueue(&path,&path_tail, &path_penultimate,port);
+	path_enqueue(&path,port);
 	return network[node].port[port].neighbour.node;
 }
 
@@ -0,0 +1,178 @@
+#!/bin/bash
+# Benchmark suite of the simulator (make bench).
+#
+# Builds an optimised copy of the simulator (out of the source tree, so build/ is left alone)
+# with an allocation counter (tools/alloc_count.c), and runs a fixed set of cases: static all2all
+# on dragonfly, jellyfish and fattree at two sizes, a mixed workload with both dynamic electric
+# engines and a trace-driven run. The inputs of the dynamic cases are generated, so the suite
+# does not depend on any local file.
+#
+# For every case it records the best wall time of BENCH_REPEAT runs, the work done (flows routed
+# or event steps) and its rate, the peak RSS and the number of allocations, in a tab-separated
+# file (BENCH_OUT, bench.tsv by default), and compares them with the baseline (tools/bench.baseline).
+# Cases whose time, memory or allocations grow more than BENCH_TOLERANCE (0.15 by default) are
+# regressions, and make the script fail. Wall times are only checked against a baseline recorded
+# on the same kind of machine. A change in the work done means the simulation itself changed.
+#
+# Usage: tools/bench.sh [--save] [case ...]
+#   --save   record the results as the new baseline (make bench-baseline)
+#   case     run only these cases, e.g. tools/bench.sh static.fattree.small dynamic.fast.mixed
+
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BASELINE="$SRC_DIR/tools/bench.baseline"
+OUT="${BENCH_OUT:-$PWD/bench.tsv}"
+REPEAT="${BENCH_REPEAT:-3}"
+TOLERANCE="${BENCH_TOLERANCE:-0.15}"
+SEED=13
+
+SAVE=0
+if [ "$1" = "--save" ]; then
+    SAVE=1
+    shift
+fi
+
+# Name, mode and arguments of every case
+CASES=(
+    "static.dragonfly.small" "static" "topo=dragonfly_4_8_4 routing=dragonfly-min tpattern=all2all"
+    "static.dragonfly.large" "static" "topo=dragonfly_6_12_6 routing=dragonfly-min tpattern=all2all"
+    "static.jellyfish.small" "static" "topo=jellyfish_64_16_8_1 routing=jellyfish-sp tpattern=all2all"
+    "static.jellyfish.large" "static" "topo=jellyfish_256_24_12_1 routing=jellyfish-sp tpattern=all2all"
+    "static.fattree.small" "static" "topo=fattree_8_3 tpattern=all2all"
+    "static.fattree.large" "static" "topo=fattree_16_3 tpattern=all2all"
+    "dynamic.fast.mixed" "dynamic-fast" "topo=fattree_8_3 workload=file_WORK/mixed.wl"
+    "dynamic.accurate.mixed" "dynamic-accurate" "topo=fattree_8_3 workload=file_WORK/mixed.wl"
+    "trace.fast.ring" "dynamic-fast" "topo=fattree_8_3 workload=file_WORK/trace.wl"
+)
+
+# INRFlow splits file names at '_', so the work directory must not have any
+WORK_DIR="$(mktemp -d /tmp/bench.XXXXXX)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+cp -r "$SRC_DIR/src" "$SRC_DIR/Makefile" "$WORK_DIR/"
+cd "$WORK_DIR" || exit 1
+mkdir -p build/obj build/bin out
+if ! { gcc -O2 -c "$SRC_DIR/tools/alloc_count.c" -o alloc_count.o &&
+       make -j"$(nproc)" CFLAGS="-O2 -fcommon" LIB="$WORK_DIR/alloc_count.o" \
+           LDFLAGS="-lm -lpthread -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc"; } > build.log 2>&1; then
+    cat build.log
+    echo "Build failed"
+    exit 1
+fi
+
+# Workloads of the dynamic cases: a mix of applications arriving over time, and a trace of
+# 256 tasks exchanging with their ring and opposite neighbours, in fsin trc format
+awk -v n=256 -v iters=200 'BEGIN {
+    for (i = 0; i < iters; i++) {
+        for (t = 0; t < n; t++)
+            print "c", t, 100
+        for (t = 0; t < n; t++) {
+            print "s", t, (t + 1) % n, i, 65536
+            print "s", t, (t + n / 2) % n, i, 65536
+        }
+        for (t = 0; t < n; t++) {
+            print "r", (t + n - 1) % n, t, i, 65536
+            print "r", (t + n / 2) % n, t, i, 65536
+        }
+    }
+}' > ring.trc
+for ((a = 0; a < 4; a++)); do
+    t=$((a * 20))
+    echo "$t all2all_1_1000 128 0 sequential consecutive local random_0_0 random_0 random"
+    echo "$t allreduce_10_100000 64 0 sequential consecutive local random_0_0 random_0 random"
+    echo "$((t + 5)) bisection_10_100000 128 0 sequential consecutive local random_0_0 random_0 random"
+    echo "$((t + 10)) mesh2d_8_8_10_100000 64 0 sequential consecutive local random_0_0 random_0 random"
+done > mixed.wl
+echo "0 file_$WORK_DIR/ring.trc 256 0 sequential consecutive local random_0_0 random_0 random" > trace.wl
+
+machine="$(uname -sm) $(awk -F': ' '/^model name/ { print $2; exit }' /proc/cpuinfo 2>/dev/null)"
+
+run_case() {
+    # Runs the case $1 (mode $2, arguments $3) and prints its row
+    local name="$1" mode="$2" best="" start end wall work unit
+    local args=(${3//WORK/$WORK_DIR} mode=$mode rseed=$SEED output=out)
+
+    for ((r = 0; r < REPEAT; r++)); do
+        rm -rf out stats && mkdir out
+        start=$(date +%s%N)
+        BENCH_STATS=stats ./build/bin/inrflow "${args[@]}" > run.log 2>&1
+        end=$(date +%s%N)
+        # some topologies exit with an error after reporting, so look for the stats instead
+        [ -s stats ] || return 1
+        [ -z "$best" ] || [ $((end - start)) -lt "$best" ] && best=$((end - start))
+    done
+    if [ "$mode" = "static" ]; then
+        work=$(awk '$1 == "p" { n += $3 } END { print n + 0 }' run.log)
+        unit="flows"
+    else
+        work=$(awk '/^Number of steps:/ { print $4 }' out/*.execution 2>/dev/null)
+        unit="steps"
+    fi
+    [ -n "$work" ] && [ "$work" != 0 ] || return 1
+    awk -v name="$name" -v ns="$best" -v work="$work" -v unit="$unit" \
+        -v rss="$(awk '$1 == "rss.kb" { print $2 }' stats)" \
+        -v allocs="$(awk '$1 == "allocs" { print $2 }' stats)" \
+        'BEGIN { printf "%s\t%.3f\t%s\t%s\t%.1f\t%s\t%s\n", name, ns / 1e9, work, unit, work / (ns / 1e9), rss, allocs }'
+}
+
+{
+    echo "#machine	$machine"
+    printf "#case\twall.s\twork\twork.unit\twork.per.s\trss.kb\tallocs\n"
+} > "$OUT"
+failed=0
+for ((c = 0; c < ${#CASES[@]}; c += 3)); do
+    name="${CASES[c]}"
+    if [ $# -gt 0 ] && [[ " $* " != *" $name "* ]]; then
+        continue
+    fi
+    if ! run_case "$name" "${CASES[c+1]}" "${CASES[c+2]}" >> "$OUT"; then
+        echo "$name failed, see the output below"
+        tail -20 run.log
+        failed=1
+    fi
+done
+
+if [ $SAVE -eq 1 ]; then
+    cp "$OUT" "$BASELINE"
+    echo "Baseline written to $BASELINE"
+    cat "$BASELINE"
+    exit $failed
+fi
+
+if [ ! -f "$BASELINE" ]; then
+    cat "$OUT"
+    echo "No baseline to compare with, record one with: make bench-baseline"
+    exit $failed
+fi
+
+# Compare with the baseline, case by case
+awk -F'\t' -v tol="$TOLERANCE" -v machine="$machine" '
+    FNR == NR && $1 == "#machine" { same = ($2 == machine); next }
+    FNR == NR && $1 !~ /^#/ { wall[$1] = $2; work[$1] = $3; rss[$1] = $6; allocs[$1] = $7; next }
+    $1 ~ /^#/ { next }
+    {
+        status = "ok"
+        if (!($1 in wall))
+            status = "new"
+        else {
+            if (same && $2 > wall[$1] * (1 + tol)) status = "SLOWER"
+            if ($6 > rss[$1] * (1 + tol)) status = "MORE-MEMORY"
+            if ($7 > allocs[$1] * (1 + tol)) status = "MORE-ALLOCS"
+            if ($3 != work[$1]) status = status " (work changed)"
+            if (status ~ /^[A-Z]/) regressions++
+        }
+        if (n++ == 0)
+            printf "%-24s %10s %10s %8s %12s %8s %12s %8s  %s\n", "case", "wall.s", "base.s", "ratio",
+                   "work.per.s", "rss.kb", "allocs", "ratio", "status"
+        printf "%-24s %10.3f %10.3f %8.2f %12.1f %8d %12d %8.2f  %s\n", $1, $2, wall[$1],
+               ($1 in wall) ? $2 / wall[$1] : 0, $5, $6, $7, ($1 in wall) ? $7 / allocs[$1] : 0, status
+    }
+    END {
+        if (!same)
+            print "The baseline was recorded on another machine, wall times are not checked."
+        if (regressions) {
+            printf "%d regression(s) over the baseline (tolerance %.0f%%)\n", regressions, 100 * tol
+            exit 1
+        }
+    }' "$BASELINE" "$OUT" || failed=1
+echo "Results written to $OUT"
+exit $failed
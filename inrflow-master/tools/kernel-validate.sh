@@ -0,0 +1,124 @@
+#!/bin/bash
+# Validation of the bandwidth solvers of the dynamic-fast mode (make validate-kernels).
+#
+# Builds an optimised copy of the simulator (out of the source tree) and runs a fixed set of
+# dynamic-fast cases with every bandwidth kernel and with the parallel solver (4 threads, or one
+# per online core if there are fewer; not run on a single core): the mixed workload of
+# tools/bench.sh on a fat tree, a dragonfly and a thin tree with multipath routing, on the fat
+# tree again with the ttp and stp flow priorities, and the ring trace. The
+# outputs of every solver must be identical, byte by byte, to those of the scalar kernel; solvers
+# that do not match make the script fail. Kernels the CPU does not support are skipped. It also
+# prints the flows per second of every solver.
+#
+# Usage: tools/kernel-validate.sh [case ...]
+#   case     run only these cases, e.g. tools/kernel-validate.sh fattree.ftp
+
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+SEED=13
+
+# Name and arguments of every solver, the scalar kernel first
+SOLVERS=(
+    "scalar" "bw_kernel=scalar"
+    "avx2" "bw_kernel=avx2"
+    "avx512" "bw_kernel=avx512"
+)
+THREADS=$(nproc)
+if [ "$THREADS" -gt 4 ]; then
+    THREADS=4
+fi
+if [ "$THREADS" -gt 1 ]; then
+    SOLVERS+=("threads.$THREADS" "bandwidth_threads=$THREADS")
+fi
+
+# Name and arguments of every case
+CASES=(
+    "fattree.ftp" "topo=fattree_8_3 workload=file_WORK/mixed.wl"
+    "fattree.ttp" "topo=fattree_8_3 workload=file_WORK/mixed.wl flows_priority=ttp_2_70_30"
+    "fattree.stp" "topo=fattree_8_3 workload=file_WORK/mixed.wl flows_priority=stp"
+    "dragonfly.ftp" "topo=dragonfly_4_8_4 routing=dragonfly-min workload=file_WORK/mixed.wl"
+    "thintree.ftp" "topo=thintree_4_2_3 routing=tree-rr workload=file_WORK/small.wl"
+    "fattree.trace" "topo=fattree_8_3 workload=file_WORK/trace.wl"
+)
+
+# INRFlow splits file names at '_', so the work directory must not have any
+WORK_DIR="$(mktemp -d /tmp/kernels.XXXXXX)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+cp -r "$SRC_DIR/src" "$SRC_DIR/Makefile" "$WORK_DIR/"
+cd "$WORK_DIR" || exit 1
+mkdir -p build/obj build/bin
+if ! make -j"$(nproc)" CFLAGS="-O2 -fcommon" > build.log 2>&1; then
+    cat build.log
+    echo "Build failed"
+    exit 1
+fi
+
+# Workloads: those of tools/bench.sh, and a smaller mix for the thin tree
+awk -v n=256 -v iters=50 'BEGIN {
+    for (i = 0; i < iters; i++) {
+        for (t = 0; t < n; t++)
+            print "c", t, 100
+        for (t = 0; t < n; t++) {
+            print "s", t, (t + 1) % n, i, 65536
+            print "s", t, (t + n / 2) % n, i, 65536
+        }
+        for (t = 0; t < n; t++) {
+            print "r", (t + n - 1) % n, t, i, 65536
+            print "r", (t + n / 2) % n, t, i, 65536
+        }
+    }
+}' > ring.trc
+for ((a = 0; a < 4; a++)); do
+    t=$((a * 20))
+    echo "$t all2all_1_1000 128 0 sequential consecutive local random_0_0 random_0 random"
+    echo "$t allreduce_10_100000 64 0 sequential consecutive local random_0_0 random_0 random"
+    echo "$((t + 5)) bisection_10_100000 128 0 sequential consecutive local random_0_0 random_0 random"
+    echo "$((t + 10)) mesh2d_8_8_10_100000 64 0 sequential consecutive local random_0_0 random_0 random"
+done > mixed.wl
+echo "0 all2all_1_1000 16 0 sequential consecutive local random_0_0 random_0 random" > small.wl
+echo "5 bisection_10_100000 16 0 sequential consecutive local random_0_0 random_0 random" >> small.wl
+echo "0 file_$WORK_DIR/ring.trc 256 0 sequential consecutive local random_0_0 random_0 random" > trace.wl
+
+run_solver() {
+    # Runs the case (arguments $1) with the solver $2 (arguments $3) in out.$2, and prints its
+    # flows per second
+    local args=(${1//WORK/$WORK_DIR} $3 mode=dynamic-fast rseed=$SEED output=out.$2)
+
+    rm -rf "out.$2" && mkdir "out.$2"
+    ./build/bin/inrflow "${args[@]}" > "run.$2.log" 2>&1
+    grep -q "does not support" "run.$2.log" && { echo "unsupported"; return 0; }
+    awk '$1 == "Flows:" { print $6; found = 1 } END { exit !found }' "run.$2.log"
+}
+
+printf "%-16s" "case"
+for ((s = 0; s < ${#SOLVERS[@]}; s += 2)); do
+    printf " %17s" "${SOLVERS[s]}.flows/s"
+done
+printf "  %s\n" "status"
+failed=0
+for ((c = 0; c < ${#CASES[@]}; c += 2)); do
+    name="${CASES[c]}"
+    if [ $# -gt 0 ] && [[ " $* " != *" $name "* ]]; then
+        continue
+    fi
+    status="ok"
+    printf "%-16s" "$name"
+    for ((s = 0; s < ${#SOLVERS[@]}; s += 2)); do
+        k="${SOLVERS[s]}"
+        if ! rate=$(run_solver "${CASES[c+1]}" $k "${SOLVERS[s+1]}"); then
+            rate="failed"
+            status="FAILED"
+        elif [ "$rate" != "unsupported" ] && [ $k != scalar ] && ! diff -r -q out.scalar out.$k > /dev/null; then
+            status="MISMATCH ($k)"
+        fi
+        printf " %17s" "$rate"
+    done
+    printf "  %s\n" "$status"
+    if [ "$status" != "ok" ]; then
+        failed=1
+    fi
+done
+if [ $failed -ne 0 ]; then
+    echo "The bandwidth solvers do not match the scalar kernel"
+fi
+exit $failed
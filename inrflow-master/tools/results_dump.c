@@ -0,0 +1,213 @@
+/**
+ * Reads a results store written by INRFlow or INSEE (results=<store> option, see
+ * src/inrflow/results.h for the format).
+ *
+ * Compile: gcc -O2 -o results_dump results_dump.c
+ * Usage:   ./results_dump <store>                  list the records
+ *          ./results_dump <store> rows             all the rows as CSV (union of the columns of every run)
+ *          ./results_dump <store> <run> <name>     a vector ("i value"), or a matrix ("i j value")
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/inrflow/results.h"
+
+FILE *store;
+results_record_t record;
+char *payload;      ///< Payload of the last record read
+long pos;           ///< Next byte of the payload to decode
+
+char **columns;     ///< Columns of the CSV table, in order of appearance
+long n_columns, columns_size;
+
+/**
+ * Reads the next record of the store.
+ *
+ * @return 0 at the end of the store.
+ */
+long next_record(){
+
+    if(fread(&record, sizeof(record), 1, store) != 1){
+        return(0);
+    }
+    if(memcmp(record.magic, RESULTS_MAGIC, 4) != 0 || record.size < 0){
+        printf("Results store is corrupt.\n");
+        exit(-1);
+    }
+    payload = realloc(payload, record.size + 1);
+    if(fread(payload, 1, record.size, store) != (size_t)record.size){
+        printf("Results store is truncated.\n");
+        exit(-1);
+    }
+    pos = 0;
+    return(1);
+}
+
+long get_varint(){
+
+    unsigned long u = 0;
+    long shift = 0;
+    unsigned char c;
+
+    do{
+        if(pos >= record.size){
+            printf("Results store is corrupt.\n");
+            exit(-1);
+        }
+        c = payload[pos++];
+        u |= (unsigned long)(c & 0x7f) << shift;
+        shift += 7;
+    } while(c & 0x80);
+    return((long)(u >> 1) ^ -(long)(u & 1));
+}
+
+char *get_string(){
+
+    char *s = payload + pos;
+
+    pos += strlen(s) + 1;
+    return(s);
+}
+
+long column(char *key){
+
+    long i;
+
+    for(i = 0; i < n_columns; i++){
+        if(strcmp(columns[i], key) == 0){
+            return(i);
+        }
+    }
+    if(n_columns == columns_size){
+        columns_size = 2 * columns_size + 16;
+        columns = realloc(columns, columns_size * sizeof(char*));
+    }
+    columns[n_columns] = strdup(key);
+    return(n_columns++);
+}
+
+/**
+ * Prints the rows in two passes: the first one finds all the columns.
+ */
+void print_rows(){
+
+    char **values = NULL;
+    char *key;
+    long i, c;
+
+    while(next_record()){
+        if(record.type == RESULTS_ROW){
+            for(i = 0; i < record.rows; i++){
+                column(get_string());
+                get_string();
+            }
+        }
+    }
+    printf("run.id");
+    for(c = 0; c < n_columns; c++){
+        printf(",%s", columns[c]);
+    }
+    printf("\n");
+
+    values = malloc(n_columns * sizeof(char*));
+    rewind(store);
+    while(next_record()){
+        if(record.type != RESULTS_ROW){
+            continue;
+        }
+        for(c = 0; c < n_columns; c++){
+            values[c] = NULL;
+        }
+        for(i = 0; i < record.rows; i++){
+            key = get_string();
+            values[column(key)] = get_string();
+        }
+        printf("%ld", record.run);
+        for(c = 0; c < n_columns; c++){
+            printf(",%s", values[c] ? values[c] : "");
+        }
+        printf("\n");
+    }
+    free(values);
+}
+
+void print_block(long run, char *name){
+
+    long i, j, n, v;
+
+    while(next_record()){
+        if(record.run != run || strcmp(record.name, name) != 0){
+            continue;
+        }
+        switch(record.type){
+            case RESULTS_ROW:
+                for(i = 0; i < record.rows; i++){
+                    printf("%s ", get_string());
+                    printf("%s\n", get_string());
+                }
+                break;
+            case RESULTS_VECTOR:
+                for(i = 0; i < record.cols; i++){
+                    printf("%ld %ld\n", i, get_varint());
+                }
+                break;
+            case RESULTS_MATRIX:
+                for(i = 0; i < record.rows; i++){
+                    for(j = 0; j < record.cols;){
+                        n = get_varint();
+                        v = get_varint();
+                        for(; n > 0 && j < record.cols; n--, j++){
+                            printf("%ld %ld %ld\n", i, j, v);
+                        }
+                    }
+                }
+                break;
+            case RESULTS_REAL_MATRIX:
+                for(i = 0; i < record.rows; i++){
+                    for(j = 0; j < record.cols; j++){
+                        printf("%ld %ld %f\n", i, j, ((double*)payload)[(i * record.cols) + j]);
+                    }
+                }
+                break;
+        }
+        return;
+    }
+    printf("There is no record %s in run %ld.\n", name, run);
+    exit(-1);
+}
+
+int main(int argc, char *argv[]){
+
+    char *types[] = {"", "row", "vector", "matrix", "real_matrix"};
+
+    if(argc != 2 && argc != 3 && argc != 4){
+        printf("Usage: %s <store> [rows | <run> <name>]\n", argv[0]);
+        exit(-1);
+    }
+    if((store = fopen(argv[1], "r")) == NULL){
+        printf("Error opening %s\n", argv[1]);
+        exit(-1);
+    }
+    if(argc == 2){
+        printf("%12s %-12s %-24s %10s %10s %12s\n", "run", "type", "name", "rows", "cols", "bytes");
+        while(next_record()){
+            printf("%12ld %-12s %-24s %10ld %10ld %12ld\n", record.run,
+                    (record.type >= RESULTS_ROW && record.type <= RESULTS_REAL_MATRIX) ? types[record.type] : "?",
+                    record.name, record.rows, record.cols, record.size);
+        }
+    }
+    else if(argc == 3 && strcmp(argv[2], "rows") == 0){
+        print_rows();
+    }
+    else if(argc == 4){
+        print_block(atol(argv[2]), argv[3]);
+    }
+    else{
+        printf("Usage: %s <store> [rows | <run> <name>]\n", argv[0]);
+        exit(-1);
+    }
+    fclose(store);
+    return(0);
+}
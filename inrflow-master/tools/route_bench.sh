@@ -0,0 +1,62 @@
+#!/bin/bash
+# All-to-all routing time of the source-routed server-centric topologies.
+#
+# Builds a copy of the simulator with the profiler (-DPROFILE, out of the source
+# tree, so build/ is left alone) and runs a static all2all on every topology.
+# init_routing.ns is the mean time spent computing a route in init_routing and
+# route.ns the mean time spent per hop in route, both in nanoseconds.
+#
+# Usage: tools/route_bench.sh [topology routing ...]
+#   e.g. tools/route_bench.sh knkstar_3_6_2 - hcnbcn_4_4_2 hcnbcn-newbdim
+
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+WORK_DIR="$(mktemp -d /tmp/route_bench.XXXXXX)"
+SEED=13
+
+# Pairs of topology and routing ('-' for the default routing of the topology)
+if [ $# -gt 0 ]; then
+    CASES=("$@")
+else
+    CASES=(
+        "knkstar_3_6_2" "-"
+        "swcube_3_6" "-"
+        "hcnbcn_4_4_2" "hcnbcn-fdim"
+        "hcnbcn_4_4_2" "hcnbcn-newbdim"
+    )
+fi
+
+cp -r "$SRC_DIR/src" "$SRC_DIR/Makefile" "$WORK_DIR/"
+cd "$WORK_DIR" || exit 1
+mkdir -p build/obj build/bin out
+if ! make -j"$(nproc)" CFLAGS="-O2 -fcommon -DPROFILE" > build.log 2>&1; then
+    echo "Build failed, see $WORK_DIR/build.log"
+    exit 1
+fi
+
+get_mean() {
+    # mean.ns of the zone $1 in the profile of the output $2
+    awk -v zone="prof.$1" '$1 == zone { print $4 }' "$2"
+}
+
+printf "%-16s %-16s %12s %16s %14s\n" "topology" "routing" "wall.s" "init_routing.ns" "route.ns"
+for ((c = 0; c < ${#CASES[@]}; c += 2)); do
+    topo="${CASES[c]}"
+    routing="${CASES[c+1]}"
+    args=(topo="$topo" tpattern=all2all mode=static rseed=$SEED output=out/$c)
+    [ "$routing" != "-" ] && args+=(routing="$routing")
+    mkdir -p out/$c
+    start=$(date +%s.%N)
+    ./build/bin/inrflow "${args[@]}" > out/$c.log 2>&1
+    end=$(date +%s.%N)
+    # some topologies exit with an error after reporting, so look for the timings
+    if [ -z "$(get_mean init_routing out/$c.log)" ]; then
+        printf "%-16s %-16s %12s\n" "$topo" "$routing" "failed"
+        continue
+    fi
+    printf "%-16s %-16s %12.3f %16s %14s\n" "$topo" "$routing" \
+        "$(awk -v s="$start" -v e="$end" 'BEGIN { print e - s }')" \
+        "$(get_mean init_routing out/$c.log)" \
+        "$(get_mean route out/$c.log)"
+done
+
+rm -rf "$WORK_DIR"
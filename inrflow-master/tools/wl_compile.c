@@ -0,0 +1,169 @@
+/**
+ * Compiles a text workload (as written by gen_workloads) into the binary workload format read by
+ * INRFlow (see src/inrflow/workload_file.h). Binary workloads are detected automatically when given
+ * as workload file, and their jobs are streamed into the simulation as they arrive.
+ *
+ * Compile: gcc -O2 -o wl_compile wl_compile.c
+ * Usage:   ./wl_compile <text workload | -> <binary workload>
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/inrflow/workload_file.h"
+
+#define HASH_SIZE 4096
+
+wlf_name_t *names;  ///< Name table
+long n_names, names_size;
+long hash[HASH_SIZE];   ///< First name of every hash bucket, or -1
+long *hash_next;        ///< Next name in the same bucket, or -1
+
+void error(long line, char *msg, char *s){
+
+    printf("Error in line %ld: %s%s\n", line, msg, s);
+    exit(-1);
+}
+
+/**
+ * Index of a name of a field in the name table, adding it if it is new.
+ */
+int intern(long line, wlf_field_t field, char *s){
+
+    unsigned long h = field;
+    char *c;
+    long i;
+
+    if(s == NULL){
+        error(line, "missing field", "");
+    }
+    if(strlen(s) >= WLF_NAME_LEN){
+        error(line, "name too long - ", s);
+    }
+    for(c = s; *c != '\0'; c++){
+        h = (h * 31) + (unsigned char)*c;
+    }
+    h %= HASH_SIZE;
+    for(i = hash[h]; i != -1; i = hash_next[i]){
+        if(names[i].field == field && strcmp(names[i].name, s) == 0){
+            return(i);
+        }
+    }
+    if(n_names == names_size){
+        names_size = 2 * names_size;
+        names = realloc(names, names_size * sizeof(wlf_name_t));
+        hash_next = realloc(hash_next, names_size * sizeof(long));
+    }
+    memset(&names[n_names], 0, sizeof(wlf_name_t));
+    names[n_names].field = field;
+    strcpy(names[n_names].name, s);
+    hash_next[n_names] = hash[h];
+    hash[h] = n_names;
+    return(n_names++);
+}
+
+/**
+ * Numeric part of a composite field (e.g. the read percentage of random_50_50).
+ */
+long number(long line, char *s){
+
+    if(s == NULL){
+        error(line, "missing field", "");
+    }
+    return(atol(s));
+}
+
+int main(int argc, char *argv[]){
+
+    FILE *in, *out;
+    char line[1024];
+    char pattern[1024], allocation[1024], mapping[1024], storage[1024];
+    char mem_storage_access[1024], stg_nodes_access[1024], data_access_mode[1024];
+    char *tok;
+    long l = 0, i;
+    wlf_header_t header;
+    wlf_job_t job;
+    unsigned long long last_arrival = 0;
+
+    if(argc != 3){
+        printf("Usage: %s <text workload | -> <binary workload>\n", argv[0]);
+        exit(-1);
+    }
+    if(strcmp(argv[1], "-") == 0){
+        in = stdin;
+    }
+    else if((in = fopen(argv[1], "r")) == NULL){
+        printf("Error opening %s\n", argv[1]);
+        exit(-1);
+    }
+    if((out = fopen(argv[2], "w")) == NULL){
+        printf("Error opening %s\n", argv[2]);
+        exit(-1);
+    }
+
+    names_size = 64;
+    names = malloc(names_size * sizeof(wlf_name_t));
+    hash_next = malloc(names_size * sizeof(long));
+    for(i = 0; i < HASH_SIZE; i++){
+        hash[i] = -1;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, WLF_MAGIC, WLF_MAGIC_LEN);
+    fwrite(&header, sizeof(header), 1, out); // rewritten at the end, with the counts
+
+    while(fgets(line, 1024, in) != NULL){
+        l++;
+        if(strspn(line, " \t\r\n") == strlen(line)){ // skip empty lines
+            continue;
+        }
+        memset(&job, 0, sizeof(job));
+        if(sscanf(line, "%llu %s %ld %ld %s %s %s %s %s %s %lf", &job.arrive_time, pattern, &job.size_tasks,
+                    &job.size_storage, allocation, mapping, storage, mem_storage_access, stg_nodes_access,
+                    data_access_mode, &job.estimate) < 9){
+            error(l, "format of workload file is not correct", "");
+        }
+        if(header.n_jobs > 0 && job.arrive_time < last_arrival){
+            error(l, "jobs must be sorted by arrival time", "");
+        }
+        last_arrival = job.arrive_time;
+
+        tok = strtok(pattern, "_");
+        job.name[WLF_PATTERN] = intern(l, WLF_PATTERN, tok);
+        job.name[WLF_PATTERN_FILE] = WLF_NO_NAME;
+        if(strcmp(tok, "file") == 0){
+            job.name[WLF_PATTERN_FILE] = intern(l, WLF_PATTERN_FILE, strtok(NULL, "_"));
+        }
+        while((tok = strtok(NULL, "_")) && job.pattern_nparam < WLF_MAX_PARAMS){
+            job.pattern_params[job.pattern_nparam++] = atol(tok);
+        }
+
+        job.name[WLF_ALLOCATION] = intern(l, WLF_ALLOCATION, allocation);
+        job.name[WLF_MAPPING] = intern(l, WLF_MAPPING, mapping);
+        job.name[WLF_STORAGE] = intern(l, WLF_STORAGE, storage);
+        job.name[WLF_MEM_STG_ACCESS] = intern(l, WLF_MEM_STG_ACCESS, strtok(mem_storage_access, "_"));
+        job.mem_storage_access_read = number(l, strtok(NULL, "_"));
+        job.mem_storage_access_write = number(l, strtok(NULL, "_"));
+        job.name[WLF_STG_NODES_ACCESS] = intern(l, WLF_STG_NODES_ACCESS, strtok(stg_nodes_access, "_"));
+        job.stg_nodes_access = number(l, strtok(NULL, "_"));
+        job.name[WLF_DATA_ACCESS_MODE] = intern(l, WLF_DATA_ACCESS_MODE, data_access_mode);
+
+        fwrite(&job, sizeof(job), 1, out);
+        header.n_jobs++;
+    }
+
+    header.n_names = n_names;
+    fwrite(names, sizeof(wlf_name_t), n_names, out);
+    fseek(out, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, out);
+    if(fclose(out) != 0){
+        printf("Error writing %s\n", argv[2]);
+        exit(-1);
+    }
+    if(in != stdin){
+        fclose(in);
+    }
+    printf("%ld jobs, %ld names\n", header.n_jobs, n_names);
+    return(0);
+}
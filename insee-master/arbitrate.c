@@ -20,11 +20,6 @@
 
 #include "globals.h"
 
-/**
-* An array of input ports that are requesting the output port under arbitration.
-*/
-static bool_t * candidates;
-
 /**
 * Used when in_transit_priority is ON. It limits how often an injection port is assigned to an output port.
 * When using timeout-based congestion detection ipr_l[0] is the value of ipr when the router is not congested and
@@ -41,7 +36,6 @@ port_type last_port_arb_con;
 * Initialization of the structures needed to perform arbitration.
 */
 void arbitrate_init(void) {
-	candidates = alloc(sizeof(bool_t) * n_ports);
 	ipr_l[1] = (long) (intransit_pr * RAND_MAX);
 
 	if (timeout_upper_limit>0)
@@ -59,7 +53,6 @@ void arbitrate_init(void) {
 * Frees the data structures used for arbitration
 */
 void arbitrate_finish(void) {
-    free(candidates);
 }
 
 /**
@@ -96,18 +89,16 @@ void arbitrate_cons_single(long i) {
 */
 void arbitrate_cons_multiple(long i) {
 	port_type s_p;
+	uint64_t *m = network[i].p[p_con].req_mask;
 
-	for (s_p=0; s_p<last_port_arb_con; s_p++) {
-		if (network[i].p[p_con].req[s_p]) {
-			// Has input port "s_p" requested consumption port?
-			if (!queue_len(&network[i].p[s_p].q)){
-				printf("node %ld, p_con %ld, s_p %ld\n",i,p_con,s_p);
-				panic("Trying to assign consumption port to empty input queue - multiple");
-			}
-			network[i].p[s_p].aop = p_con;
-			network[i].p[s_p].bet = B_TRIAL_0; // Success reserving!! Reset my next bet -- Only for adaptive
-			continue;
+	// Only the input ports that have requested the consumption port are visited.
+	for (s_p=req_mask_next(m, 0, last_port_arb_con); s_p!=-1; s_p=req_mask_next(m, s_p+1, last_port_arb_con)) {
+		if (!queue_len(&network[i].p[s_p].q)){
+			printf("node %ld, p_con %ld, s_p %ld\n",i,p_con,s_p);
+			panic("Trying to assign consumption port to empty input queue - multiple");
 		}
+		network[i].p[s_p].aop = p_con;
+		network[i].p[s_p].bet = B_TRIAL_0; // Success reserving!! Reset my next bet -- Only for adaptive
 	}
 }
 
@@ -261,7 +252,8 @@ void arbitrate_arbitrary (long i, port_type d_p) {
 * Select the port that requested the port first of all the given ports.
 *
 * Given a range of input-injection ports, select the one that requested the output port first
-* Time of request is stored in network[i].p[d_p].req[s_p].
+* Time of request is stored in network[i].p[d_p].req[s_p]. Only the requesting ports are visited,
+* in increasing order, so ties are broken as before in favour of the lowest port.
 *
 * @param i The node in which the arbitration is performed.
 * @param d_p The destination port for which the arbitration is performed.
@@ -275,16 +267,15 @@ void arbitrate_arbitrary (long i, port_type d_p) {
 port_type arbitrate_select_fifo(long i, port_type d_p, port_type first, port_type last) {
 	port_type s_p, selected_port=NULL_PORT;
 	CLOCK_TYPE time_of_selected, min;
+	uint64_t *m = network[i].p[d_p].req_mask;
 
 	time_of_selected = CLOCK_MAX;
 
-	for (s_p=first; s_p<last; s_p++) {
+	for (s_p=req_mask_next(m, first, last); s_p!=-1; s_p=req_mask_next(m, s_p+1, last)) {
 		min = network[i].p[d_p].req[s_p];
-		if (min!=0) {
-			if (min < time_of_selected) {
-				time_of_selected = min;
-				selected_port = s_p;
-			}
+		if (min < time_of_selected) {
+			time_of_selected = min;
+			selected_port = s_p;
 		}
 	}
 
@@ -312,24 +303,47 @@ port_type arbitrate_select_fifo(long i, port_type d_p, port_type first, port_typ
 * @see arbitrate_select
 */
 port_type arbitrate_select_longest(long i, port_type d_p, port_type first, port_type last) {
-	port_type s_p, selected_port=NULL_PORT, visited;
+	port_type s_p, selected_port=NULL_PORT, start, visited;
 	long len_of_selected, pl;
 	long dif=last-first;
+	uint64_t *m = network[i].p[d_p].req_mask;
 
-	s_p = first + ((network[i].p[d_p].ri + 1) % dif);
-	if (s_p >= last) s_p = first;
+	start = first + ((network[i].p[d_p].ri + 1) % dif);
+	if (start >= last) start = first;
 	len_of_selected = -1;
 
-	for (visited=first; visited<last; visited++) {
-		if (network[i].p[d_p].req[s_p]) {
+	if (first % dif == 0) {
+		// The visiting order is [start, last) and then [first, start): only the requesting ports are visited.
+		for (s_p=req_mask_next(m, start, last); s_p!=-1; s_p=req_mask_next(m, s_p+1, last)) {
+			pl = queue_len(&network[i].p[s_p].q);
+			if (pl > len_of_selected) {
+				len_of_selected = pl;
+				selected_port = s_p;
+			}
+		}
+		for (s_p=req_mask_next(m, first, start); s_p!=-1; s_p=req_mask_next(m, s_p+1, start)) {
 			pl = queue_len(&network[i].p[s_p].q);
 			if (pl > len_of_selected) {
 				len_of_selected = pl;
 				selected_port = s_p;
 			}
 		}
-		s_p = first + ((s_p + 1) % (dif));
-		if (s_p >= last) s_p = first;
+	}
+	else if (req_mask_count(m, first, last)) {
+		// Otherwise the ports are visited with a stride of first+1 (mod dif), so they are walked
+		// one by one to keep the tie-breaking of this policy.
+		s_p = start;
+		for (visited=first; visited<last; visited++) {
+			if (req_mask_test(m, s_p)) {
+				pl = queue_len(&network[i].p[s_p].q);
+				if (pl > len_of_selected) {
+					len_of_selected = pl;
+					selected_port = s_p;
+				}
+			}
+			s_p = first + ((s_p + 1) % (dif));
+			if (s_p >= last) s_p = first;
+		}
 	}
 	if (len_of_selected != -1) return(selected_port);
 	else return(NULL_PORT);
@@ -356,14 +370,20 @@ port_type arbitrate_select_highest(long i, port_type d_p, port_type first, port_
 	port_type s_p, selected_port=NULL_PORT, visited;
 	long cv_of_selected, pl;
 	long dif=last-first;
+	uint64_t *m = network[i].p[d_p].req_mask;
+
+	if (!req_mask_count(m, first, last))
+		return(NULL_PORT);
 
 	s_p = ((network[i].p[d_p].ri + 1) % dif);
 	if (s_p >= last || s_p<first)
 		s_p = first;
 	cv_of_selected = -1;
 
+	// The visiting order is only a rotation of [first, last) when first is 0, so the ports are still
+	// walked one by one here to keep the tie-breaking of this policy.
 	for (visited=first; visited<last; visited++) {
-		if (network[i].p[d_p].req[s_p]) {
+		if (req_mask_test(m, s_p)) {
 			pl = s_p%nchan;
 			if (pl > cv_of_selected) {
 				cv_of_selected = pl;
@@ -382,7 +402,9 @@ port_type arbitrate_select_highest(long i, port_type d_p, port_type first, port_
 * Select the next occupied port using round-robin.
 *
 * Given a range of input-injection ports, select one in a round-robin fashion. The last used is stored
-* in network[i].p[d_p].ri
+* in network[i].p[d_p].ri. When first is a multiple of the length of the range, the ports are visited
+* in the range rotated to start after it, so the first requester is found with find-first-set on the
+* request mask. Otherwise they are visited with a stride of first+1, and walked one by one.
 *
 * @param i The node in which the arbitration is performed.
 * @param d_p The destination port for which the arbitration is performed.
@@ -394,12 +416,23 @@ port_type arbitrate_select_highest(long i, port_type d_p, port_type first, port_
 * @see arbitrate_select
 */
 port_type arbitrate_select_round_robin(long i, port_type d_p, port_type first, port_type last) {
-	port_type s_p, visited;
+	port_type s_p, start, visited;
 	long dif=last - first;
-	s_p = first + ((network[i].p[d_p].ri + 1) % dif);
-	if (s_p >= last) s_p = first;
+	uint64_t *m = network[i].p[d_p].req_mask;
+
+	start = first + ((network[i].p[d_p].ri + 1) % dif);
+	if (start >= last) start = first;
+	if (first % dif == 0) {
+		if ((s_p = req_mask_next(m, start, last)) == -1)
+			s_p = req_mask_next(m, first, start);
+		return((s_p == -1) ? NULL_PORT : s_p);
+	}
+	// The ports are visited with a stride of first+1 (mod dif), see arbitrate_select_longest.
+	if (!req_mask_count(m, first, last))
+		return(NULL_PORT);
+	s_p = start;
 	for (visited=first; visited<last; visited++) {
-		if (network[i].p[d_p].req[s_p])
+		if (req_mask_test(m, s_p))
 			return(s_p);
 		s_p = first + ((s_p + 1) % dif);
 		if (s_p >= last) s_p = first;
@@ -410,7 +443,8 @@ port_type arbitrate_select_round_robin(long i, port_type d_p, port_type first, p
 /**
 * Random selection of a port.
 *
-* Given a range of input-injection ports, select one of them randomly.
+* Given a range of input-injection ports, select one of them randomly. The requesters are counted
+* with popcount and the lucky one is picked from the request mask.
 *
 * @param i The node in which the arbitration is performed.
 * @param d_p The destination port for which the arbitration is performed.
@@ -422,25 +456,14 @@ port_type arbitrate_select_round_robin(long i, port_type d_p, port_type first, p
 port_type arbitrate_select_random(long i, port_type d_p, port_type first, port_type last) {
 	port_type s_p;
 	long rp, ncand;
+	uint64_t *m = network[i].p[d_p].req_mask;
 
 	// First we calculate the number of input ports requesting this output
-	ncand = 0;
-	for(s_p=first; s_p<last; s_p++) {
-		if (!network[i].p[d_p].req[s_p])
-			candidates[s_p] = B_FALSE; // s_p is not requesting
-		else {
-			candidates[s_p] = B_TRUE;
-			ncand++;
-		}
-	}
+	ncand = req_mask_count(m, first, last);
 	// Now throw the dice and select the lucky one
 	rp = ztm(ncand);
- 	for (s_p=first; s_p<last; s_p++) {
-		if (!candidates[s_p]) continue;
-		if (rp-- == 0)
-			return(s_p);
-	}
-	return(NULL_PORT);
+	s_p = req_mask_select(m, first, last, rp);
+	return((s_p == -1) ? NULL_PORT : s_p);
 }
 
 /**
@@ -461,11 +484,11 @@ port_type arbitrate_select_age(long i, port_type d_p, port_type first, port_type
 	CLOCK_TYPE time_of_selected, min;
 	phit *p;
 
+	uint64_t *m = network[i].p[d_p].req_mask;
+
 	time_of_selected = CLOCK_MAX;
 
-	for (s_p=first; s_p<last; s_p++) {
-		if (!network[i].p[d_p].req[s_p])
-			continue;
+	for (s_p=req_mask_next(m, first, last); s_p!=-1; s_p=req_mask_next(m, s_p+1, last)) {
 		p = head_queue(&network[i].p[s_p].q);
 		min = pkt_space[p->packet].inj_time;
 		if (min < time_of_selected) {
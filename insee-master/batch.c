@@ -37,7 +37,40 @@ double prev_latency;
 /** Number of convergences occurred in a row (during convergency checking phase).
  * When it is three we move to the result capturing phase.
  */
-static long convergence;
+long convergence;
+
+/** Has the convergency phase ended converging? */
+bool_t converged;
+
+/** Cycle in which the convergency phase started, for the #max_conv_time timeout. */
+CLOCK_TYPE conv_start;
+
+/** Current phase of the run. */
+batch_phase_t batch_phase = WARM_UP_PHASE;
+
+/** Search of the saturation load, instead of a run at a given load. */
+load_search_t load_search;
+
+/** Load increment between the probes of the ramp. */
+double search_step;
+
+/** Width of the load interval in which the bisection stops. */
+double search_tol;
+
+/** Maximum load probed in the ramp. */
+double search_max;
+
+/** If positive, a probe is saturated when its delay exceeds this factor times the delay of the first (lowest load) probe. */
+double search_latency;
+
+/** The probes of the load search, sorted by load when it ends. */
+probe_t *probes;
+
+/** Number of probes done, and the maximum that fits in #probes. */
+long n_probes, max_probes;
+
+/** Highest load found stable & lowest load found saturated (negative if none saturated). */
+double saturation_low, saturation_high;
 
 /**
 * Print the results of a batch in an Human Readable Style (not very dense).
@@ -108,26 +141,39 @@ void print_batch_results(batch_t *b){
 * maximum injection delay.
 */
 void save_batch_results(){
+	fill_batch(&batch[reseted]);
+}
+
+/**
+* Fill a batch with the stats taken since the last reset.
+*
+* @param b a pointer to the batch to fill.
+* @see save_batch_results()
+*/
+void fill_batch(batch_t *b){
 	CLOCK_TYPE copyclock;
 	double rcvd;
 	copyclock = sim_clock - last_reset_time; // time taken for this batch.
 
-	batch[reseted].clock = copyclock;
-	batch[reseted].sent_count = sent_count;
-	batch[reseted].rcvd_count = rcvd = rcvd_count-last_rcvd_count;
-	batch[reseted].avDist = (1.0 * acum_hops) / rcvd;
-	batch[reseted].dropped_count = dropped_count + transit_dropped_count - last_tran_drop_count;
-	batch[reseted].sent_phit_count = sent_phit_count;
-	batch[reseted].rcvd_phit_count = rcvd_phit_count;
-	batch[reseted].dropped_phit_count = dropped_phit_count;
-	batch[reseted].inj_load = (double) (sent_phit_count) / (1.0 * nprocs * copyclock);
-	batch[reseted].acc_load = (double) (rcvd_phit_count) / (1.0 * nprocs * copyclock);
-	batch[reseted].avg_delay = acum_delay/rcvd;
-	batch[reseted].stDev_delay = sqrt(fabs((acum_sq_delay-(acum_delay*acum_delay)/rcvd)/(rcvd-1)));
-	batch[reseted].max_delay = max_delay;
-	batch[reseted].avg_inj_delay = acum_inj_delay/rcvd;
-	batch[reseted].stDev_inj_delay = sqrt(fabs((acum_sq_inj_delay-(acum_inj_delay*acum_inj_delay)/rcvd)/(rcvd-1)));
-	batch[reseted].max_inj_delay = max_inj_delay;
+	if (plevel & 8)
+		flush_histograms();
+
+	b->clock = copyclock;
+	b->sent_count = sent_count;
+	b->rcvd_count = rcvd = rcvd_count-last_rcvd_count;
+	b->avDist = (1.0 * acum_hops) / rcvd;
+	b->dropped_count = dropped_count + transit_dropped_count - last_tran_drop_count;
+	b->sent_phit_count = sent_phit_count;
+	b->rcvd_phit_count = rcvd_phit_count;
+	b->dropped_phit_count = dropped_phit_count;
+	b->inj_load = (double) (sent_phit_count) / (1.0 * nprocs * copyclock);
+	b->acc_load = (double) (rcvd_phit_count) / (1.0 * nprocs * copyclock);
+	b->avg_delay = acum_delay/rcvd;
+	b->stDev_delay = sqrt(fabs((acum_sq_delay-(acum_delay*acum_delay)/rcvd)/(rcvd-1)));
+	b->max_delay = max_delay;
+	b->avg_inj_delay = acum_inj_delay/rcvd;
+	b->stDev_inj_delay = sqrt(fabs((acum_sq_inj_delay-(acum_inj_delay*acum_inj_delay)/rcvd)/(rcvd-1)));
+	b->max_inj_delay = max_inj_delay;
 }
 
 /**
@@ -140,6 +186,8 @@ void save_batch_results(){
 */
 void warm_up(void){
 	while (sim_clock < warm_up_period && !interrupted && !aborted){
+		if (checkpoint_cycle > 0 && sim_clock == checkpoint_cycle)
+			checkpoint_save();
 		data_movement(B_TRUE);
 		sim_clock++;
 
@@ -181,15 +229,22 @@ bool_t system_converges(void){
 * This phase ends when they are 3 converged samples in a row or when it spends more
 * than #max_conv_time cycles without reach the stationary state.
 * A message stating the reason of leaving this phase is printed.
+* Then the network is warm, and the checkpoint is written, unless it is written at a given cycle.
 *
 * @see system_converges()
 * @see run_network_batch()
 */
 void convergency(void){
-	long converged=B_FALSE;
+	if (batch_phase == WARM_UP_PHASE){
+		batch_phase = CONVERGENCY_PHASE;
+		converged = B_FALSE;
+		conv_start = sim_clock;
+	}
 
 	go_on=B_TRUE;
-	while (go_on && !interrupted  && !aborted){
+	while (batch_phase == CONVERGENCY_PHASE && go_on && !interrupted  && !aborted){
+		if (checkpoint_cycle > 0 && sim_clock == checkpoint_cycle)
+			checkpoint_save();
 		data_movement(B_TRUE);
 		sim_clock++;
 		if ((pheaders > 0) && (sim_clock % pinterval == 0))
@@ -212,12 +267,15 @@ void convergency(void){
 			global_q_u = global_q_u_current;
 			global_q_u_current = injected_count - rcvd_count - transit_dropped_count;
 		}
-		if (sim_clock - warm_up_period >= max_conv_time)
+		if (sim_clock - conv_start >= max_conv_time)
 			go_on=B_FALSE;
 	}
 
 	// Adjust for equal sample acquiring
+	batch_phase = ALIGN_PHASE;
 	while (sim_clock % batch_time != 0 && !interrupted  && !aborted){
+		if (checkpoint_cycle > 0 && sim_clock == checkpoint_cycle)
+			checkpoint_save();
 		data_movement(B_TRUE);
 		sim_clock++;
 		if ((pheaders > 0) && (sim_clock % pinterval == 0))
@@ -231,6 +289,9 @@ void convergency(void){
 	warmed_up = sim_clock;
 	reseted=-1;
 	reset_stats();
+	batch_phase = STATIONARY_PHASE;
+	if (checkpoint_cycle == 0 && !interrupted && !aborted)
+		checkpoint_save();
 
     if (!interrupted && !aborted){
         if (converged){
@@ -257,6 +318,8 @@ void convergency(void){
 void stationary(void){
 	go_on=B_TRUE;
 	while (go_on && !interrupted  && !aborted){
+		if (checkpoint_cycle > 0 && sim_clock == checkpoint_cycle)
+			checkpoint_save();
 		data_movement(B_TRUE);
 		sim_clock++;
 		if ((pheaders > 0) && (sim_clock % pinterval == 0))
@@ -282,17 +345,188 @@ void stationary(void){
 *
 * The simulation is split in three phases:
 * Warm-up, Convergency checking & Stationary state.
+* When restoring a checkpoint, the run goes on from the phase in which it was written.
 *
 * @see warm_up()
 * @see convergency()
 * @see stationary()
+* @see checkpoint_restore()
 */
 void run_network_batch(void){
-	warm_up();
-	convergency();
+	if (restore_file[0] != '\0')
+		checkpoint_restore();
+	if (batch_phase == WARM_UP_PHASE)
+		warm_up();
+	if (batch_phase != STATIONARY_PHASE)
+		convergency();
 	stationary();
 }
 
+/**
+* Run the simulation for some cycles.
+*
+* @param cycles the number of cycles to run.
+*/
+static void run_cycles(CLOCK_TYPE cycles){
+	CLOCK_TYPE end = sim_clock + cycles;
+
+	while (sim_clock < end && !interrupted && !aborted){
+		data_movement(B_TRUE);
+		sim_clock++;
+		if ((pheaders > 0) && (sim_clock % pinterval == 0))
+			print_partials();
+
+		if (sim_clock % update_period == 0){
+			global_q_u = global_q_u_current;
+			global_q_u_current = injected_count - rcvd_count - transit_dropped_count;
+		}
+	}
+}
+
+/**
+* The packets offered per node & cycle at the current load.
+*
+* Counted in packets, as generated by the independent sources, so they can be compared with the
+* packets received. Long messages of the bimodal injection are #msglength packets.
+*
+* @return the offered packet rate.
+*/
+static double offered_rate(void){
+#if (BIMODAL_SUPPORT != 0)
+	return (aload + lm_load * (msglength - 1)) / (double) RAND_MAX;
+#else
+	return aload / (double) RAND_MAX;
+#endif /* BIMODAL */
+}
+
+/**
+* The tolerance of a rate measured in some cycles.
+*
+* The convergency threshold, or the sampling noise of the packets received if it is larger
+* (3 standard deviations of a count of Poisson arrivals).
+*
+* @param cycles the cycles of the measure.
+* @return the relative tolerance.
+*/
+static double rate_tolerance(CLOCK_TYPE cycles){
+	double noise = 3.0 / sqrt(offered_rate() * nprocs * cycles);
+
+	return (noise > threshold) ? noise : threshold;
+}
+
+/**
+* Probe a load, in the network as it is.
+*
+* Changes the load on the fly, and runs #conv_period windows until the network settles at the new
+* load: two converged windows in a row (see system_converges()), two windows in a row receiving
+* less packets than offered, three windows in a row with growing latency, or #max_conv_time cycles.
+* Then a batch of #batch_time cycles (and at least #min_batch_size packets) is measured.
+*
+* The load is saturated if the network diverged while settling, if the batch received less
+* packets than offered, or if #search_latency is set and the delay of the batch exceeds
+* #search_latency times the delay of the first probe.
+*
+* @param l the load to probe.
+* @return TRUE if the network is saturated at this load or FALSE in other case.
+*/
+static bool_t probe(double l){
+	probe_t *p = &probes[n_probes];
+	CLOCK_TYPE start = sim_clock;
+	long conv = 0, div = 0, grow = 0;
+	double tol, rate;
+
+	set_load(l);
+	tol = rate_tolerance(conv_period);
+	reset_stats();
+	prev_cons_load = prev_latency = 0.0;
+	while (conv < 2 && div < 2 && grow < 3 && sim_clock - start < max_conv_time && !interrupted && !aborted){
+		run_cycles(conv_period);
+		if (rcvd_count - last_rcvd_count == 0)
+			continue;
+		rate = (rcvd_count - last_rcvd_count) / (1.0 * nprocs * conv_period);
+		conv = system_converges() ? conv + 1 : 0;
+		div = (rate < offered_rate() * (1 - tol)) ? div + 1 : 0;
+		grow = (prev_latency > 0.0 && latency > prev_latency * (1 + tol)) ? grow + 1 : 0;
+		prev_cons_load = cons_load;
+		prev_latency = latency;
+		reset_stats();
+	}
+
+	reset_stats();
+	do
+		run_cycles(batch_time);
+	while ((rcvd_count - last_rcvd_count) < min_batch_size && sim_clock - start < max_conv_time && !interrupted && !aborted);
+	fill_batch(&p->b);
+	p->load = l;
+	p->cycles = sim_clock - start;
+	rate = p->b.rcvd_count / (1.0 * nprocs * p->b.clock);
+	p->saturated = (bool_t)(div >= 2 || grow >= 3 || rate < offered_rate() * (1 - rate_tolerance(p->b.clock)) ||
+			(search_latency > 0.0 && n_probes > 0 && p->b.avg_delay > search_latency * probes[0].b.avg_delay));
+	printf("Probe %ld, load %1.5f: inj %1.5f, acc %1.5f, delay %10.2f, %"PRINT_CLOCK" cycles, %s\n",
+			n_probes, l, p->b.inj_load, p->b.acc_load, p->b.avg_delay, p->cycles,
+			p->saturated ? "saturated" : "stable");
+	fflush(stdout);
+	n_probes++;
+	return p->saturated;
+}
+
+/**
+* Compares two probes by load, for qsort.
+*/
+static int probe_cmp(const void *a, const void *b){
+	double la = ((const probe_t *)a)->load, lb = ((const probe_t *)b)->load;
+
+	return (la > lb) - (la < lb);
+}
+
+/**
+* Search the saturation load, in one run.
+*
+* After the warm-up, the load is increased by #search_step until a probe saturates (or
+* #search_max is reached). Bisecting, the interval between the last stable and the first
+* saturated load is halved while it is wider than #search_tol. The network is never emptied
+* between probes, so each one starts from the state left by the previous. #load is not used:
+* the ramp always starts at #search_step. At most #max_probes loads are probed.
+*
+* The batches of the probes, sorted by load, are the load-latency curve of the run.
+*
+* @see probe()
+*/
+void run_network_search(void){
+	long k;
+	double mid;
+
+	set_load(search_step);
+	warm_up();
+	warmed_up = sim_clock;
+	reseted = -1;
+	reset_stats();
+
+	saturation_low = 0.0;
+	saturation_high = -1.0;
+	for (k = 1; k * search_step <= search_max * (1 + 1e-9) && n_probes < max_probes && !interrupted && !aborted; k++){
+		if (probe(k * search_step)){
+			saturation_high = k * search_step;
+			break;
+		}
+		saturation_low = k * search_step;
+	}
+
+	if (load_search == BISECT_SEARCH && saturation_high > 0.0)
+		while (saturation_high - saturation_low > search_tol && n_probes < max_probes && !interrupted && !aborted){
+			mid = (saturation_low + saturation_high) / 2;
+			if (probe(mid))
+				saturation_high = mid;
+			else
+				saturation_low = mid;
+		}
+
+	qsort(probes, n_probes, sizeof(probe_t), probe_cmp);
+	for (k = 0; k < n_probes; k++)
+		batch[k] = probes[k].b;
+	reseted = n_probes;
+}
+
 /**
 * Run the simulation in shotmode.
 *
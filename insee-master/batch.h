@@ -51,5 +51,27 @@ typedef struct batch_t {
 	double stDev_inj_delay;		///< Standard deviation of injection delay.
 	long max_inj_delay;			///< Maximum delay.
 } batch_t;
+
+/**
+* Phases of a batch run.
+*
+* Kept in the checkpoints, so a restored run goes on in the same phase.
+*/
+typedef enum batch_phase_t {
+	WARM_UP_PHASE = 0,		///< Warm-up, for #warm_up_period cycles.
+	CONVERGENCY_PHASE,		///< Convergency checking.
+	ALIGN_PHASE,			///< Aligning the clock to the sampling period, before the first batch.
+	STATIONARY_PHASE		///< Capturing the batches.
+} batch_phase_t;
+
+/**
+* A probe of the load search: a batch measured at a given load, once the network has settled.
+*/
+typedef struct probe_t {
+	double load;			///< Provided load.
+	bool_t saturated;		///< Is the network saturated at this load?
+	CLOCK_TYPE cycles;		///< Cycles taken by the probe, settling included.
+	batch_t b;				///< The batch measured.
+} probe_t;
 #endif
 
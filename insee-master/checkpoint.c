@@ -0,0 +1,407 @@
+/**
+* @file
+* @brief	Warm-state checkpoints of batch runs.
+*
+* With checkpoint=<file>, the whole state of a batch run is written to a binary file: the queues
+* and port reservations of every router, the injection queues, the packets in use and the free
+* list, the random sequence, the clock, the statistics and the phase of the run. It is written when
+* the network is warm, before the first batch, or at the start of cycle checkpoint_cycle.
+*
+* With restore=<file>, a run of the same network (same topology, buffers, packets & seed) resumes
+* from a checkpoint instead of from an empty network. If the load and the traffic pattern did not
+* change, the run goes on exactly as the run that wrote the checkpoint. Otherwise the run goes back
+* to the convergency phase, so each point of a load sweep starts warm from the previous one. The
+* number of samples and the sampling period may also change.
+*
+* Only the parts of the queues in use and the packets in use are written. The random sequence is
+* written as the state of the generator, which is kept in #rand_state (see initstate()). This relies
+* on rand() drawing from the state of random(), as it does in glibc.
+*
+* @see batch.c
+
+FSIN Functional Simulator of Interconnection Networks
+Copyright (2003-2011) J. Miguel-Alonso, A. Gonzalez, J. Navaridas
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <string.h>
+
+#include "globals.h"
+
+#ifdef WIN32
+#define rr_bytes(p) _msize(p)
+#else
+#include <malloc.h>
+#define rr_bytes(p) malloc_usable_size(p)	///< Size of a routing record, whose length depends on the topology.
+#endif
+
+#define CHECKPOINT_MAGIC "FSINCKPT"
+#define CHECKPOINT_VERSION 2
+#define CHECKPOINT_PARAMS 20		///< Parameters of the network that must match to restore a checkpoint.
+
+char checkpoint_file[256];		///< File to write the checkpoint to, or empty for none.
+CLOCK_TYPE checkpoint_cycle;	///< Cycle to write the checkpoint at, or 0 to write it when the network is warm.
+char restore_file[256];			///< Checkpoint to resume the run from, or empty to start from an empty network.
+int rand_state[32];				///< State of the random sequence, as set by initstate() in main().
+
+static char *param_names[CHECKPOINT_PARAMS] = {"version", "nodes", "processors", "ports", "radix",
+		"virtual channels", "injectors", "buffer capacity", "injection buffer capacity", "transit queue length",
+		"injection queue length", "packet length", "packets", "topology", "routing", "random seed",
+		"print level", "distance histogram length", "packet size", "topology links"};
+
+static FILE *ck;		///< Checkpoint being written or read.
+
+static void put(void *p, size_t size) {
+	if (size > 0 && fwrite(p, size, 1, ck) != 1)
+		panic("Unable to write the checkpoint");
+}
+
+static void get(void *p, size_t size) {
+	if (size > 0 && fread(p, size, 1, ck) != 1)
+		panic("The checkpoint is truncated");
+}
+
+/**
+* Gets the parameters of the network that must match to restore a checkpoint.
+*
+* The links of the topology are checked with a hash of the neighbours of every router, so random
+* topologies must be built the same way.
+*/
+static void network_params(long *v) {
+	unsigned long links = 0;
+	long i, j;
+
+	for (i=0; i<NUMNODES; i++)
+		for (j=0; j<radix; j++)
+			links = (links * 31) + (network[i].nbor[j] * radix) + network[i].nborp[j];
+
+	v[0] = CHECKPOINT_VERSION;
+	v[1] = NUMNODES;
+	v[2] = nprocs;
+	v[3] = n_ports;
+	v[4] = radix;
+	v[5] = nchan;
+	v[6] = ninj;
+	v[7] = buffer_cap;
+	v[8] = binj_cap;
+	v[9] = tr_ql;
+	v[10] = inj_ql;
+	v[11] = pkt_len;
+	v[12] = pkt_max;
+	v[13] = topo;
+	v[14] = routing;
+	v[15] = r_seed;
+	v[16] = plevel & (1 | 4 | 8);	// maps & histograms kept in the checkpoint
+	v[17] = (plevel & 4) ? max_dst : 0;
+	v[18] = sizeof(packet_t);
+	v[19] = links;
+}
+
+/**
+* Writes the phits in use of a queue, from its head to its tail.
+*/
+static void put_phits(phit *pos, long head, long tail, long ql) {
+	long len = tail - head;
+
+	if (len < 0)
+		len += ql;
+	put(&len, sizeof(long));
+	if (head + len < ql)
+		put(pos + head + 1, sizeof(phit) * len);
+	else {
+		put(pos + head + 1, sizeof(phit) * (ql - head - 1));
+		put(pos, sizeof(phit) * (len - (ql - head - 1)));
+	}
+}
+
+static void get_phits(phit *pos, long head, long tail, long ql) {
+	long len;
+
+	get(&len, sizeof(long));
+	if (head < 0 || head >= ql || tail < 0 || tail >= ql || len != (((tail - head) + ql) % ql))
+		panic("Inconsistent queue in the checkpoint");
+	if (head + len < ql)
+		get(pos + head + 1, sizeof(phit) * len);
+	else {
+		get(pos + head + 1, sizeof(phit) * (ql - head - 1));
+		get(pos, sizeof(phit) * (len - (ql - head - 1)));
+	}
+}
+
+/**
+* Writes or reads the state of a router: its ports, with their queues and reservations, and its injectors.
+*/
+static void router_state(long i, void (*io)(void *, size_t), void (*phits)(phit *, long, long, long)) {
+	port *p;
+	packet_t saved;
+	port_type e, s_p;
+	long j;
+
+	io(&network[i].samples, sizeof(CLOCK_TYPE));
+	io(network[i].req_masks, sizeof(uint64_t) * req_words * (n_ports+1));
+	io(network[i].op_i, sizeof(long) * radix);
+	for (e=0; e<n_ports; e++) {
+		p = &network[i].p[e];
+		io(&p->q.head, sizeof(long));
+		io(&p->q.tail, sizeof(long));
+		phits(p->q.pos, p->q.head, p->q.tail, tr_ql);
+		io(&p->q.since, sizeof(CLOCK_TYPE));
+		io(&p->q.level, sizeof(long));
+		io(&p->bet, sizeof(bet_type));
+		io(&p->aop, sizeof(port_type));
+		io(&p->tor, sizeof(CLOCK_TYPE));
+		// Only the requests in the mask are valid.
+		for (s_p=req_mask_next(p->req_mask, 0, n_ports); s_p!=-1; s_p=req_mask_next(p->req_mask, s_p+1, n_ports))
+			io(&p->req[s_p], sizeof(CLOCK_TYPE));
+		io(&p->ri, sizeof(port_type));
+		io(&p->sip, sizeof(port_type));
+		if (plevel & 8)
+			io(p->histo, sizeof(CLOCK_TYPE) * (buffer_cap + 1));
+		io(&p->utilization, sizeof(CLOCK_TYPE));
+		io(&p->faulty, sizeof(bool_t));
+	}
+
+	if (i < nprocs)
+		for (j=0; j<ninj; j++) {
+			io(&network[i].qi[j].head, sizeof(long));
+			io(&network[i].qi[j].tail, sizeof(long));
+			phits(network[i].qi[j].pos, network[i].qi[j].head, network[i].qi[j].tail, inj_ql);
+		}
+	io(&network[i].injecting_port, sizeof(port_type));
+	io(&network[i].next_port, sizeof(port_type));
+	// The routing record of the saved packet is not in use: a new one is calculated when it is injected.
+	saved = network[i].saved_packet;
+	saved.rr.rr = NULL;
+	io(&saved, sizeof(packet_t));
+	saved.rr = network[i].saved_packet.rr;
+	network[i].saved_packet = saved;
+	io(&network[i].pending_packet, sizeof(long));
+	io(&network[i].triggered, sizeof(long));
+#if (PCOUNT!=0)
+	io(&network[i].pcount, sizeof(long));
+#endif
+	io(&network[i].timeout_counter, sizeof(CLOCK_TYPE));
+	io(&network[i].timeout_packet, sizeof(unsigned long));
+	io(&network[i].congested, sizeof(bool_t));
+	io(&network[i].source, sizeof(source_t));
+	if (routing == CAM_ROUTING && i >= nprocs)
+		for (j=0; j<nswitches; j++)
+			io(&network[i].cam[j].l_path, sizeof(long));
+}
+
+/**
+* Writes or reads the statistics of the run.
+*/
+static void stats_state(void (*io)(void *, size_t)) {
+	long i;
+
+	io(&sent_count, sizeof(double));
+	io(&injected_count, sizeof(double));
+	io(&rcvd_count, sizeof(double));
+	io(&last_rcvd_count, sizeof(double));
+	io(&dropped_count, sizeof(double));
+	io(&transit_dropped_count, sizeof(double));
+	io(&last_tran_drop_count, sizeof(double));
+	io(&inj_phit_count, sizeof(double));
+	io(&sent_phit_count, sizeof(double));
+	io(&rcvd_phit_count, sizeof(double));
+	io(&dropped_phit_count, sizeof(double));
+	io(&acum_delay, sizeof(double));
+	io(&acum_inj_delay, sizeof(double));
+	io(&acum_sq_delay, sizeof(double));
+	io(&acum_sq_inj_delay, sizeof(double));
+	io(&max_delay, sizeof(long));
+	io(&max_inj_delay, sizeof(long));
+	io(&acum_hops, sizeof(double));
+	io(&global_q_u, sizeof(double));
+	io(&global_q_u_current, sizeof(double));
+	io(&reseted, sizeof(long));
+	io(&last_reset_time, sizeof(CLOCK_TYPE));
+	io(&warmed_up, sizeof(CLOCK_TYPE));
+#if (BIMODAL_SUPPORT != 0)
+	io(msg_sent_count, sizeof(msg_sent_count));
+	io(msg_injected_count, sizeof(msg_injected_count));
+	io(msg_rcvd_count, sizeof(msg_rcvd_count));
+	io(msg_acum_delay, sizeof(msg_acum_delay));
+	io(msg_acum_inj_delay, sizeof(msg_acum_inj_delay));
+	io(msg_max_delay, sizeof(msg_max_delay));
+	io(msg_max_inj_delay, sizeof(msg_max_inj_delay));
+	io(msg_acum_sq_delay, sizeof(msg_acum_sq_delay));
+	io(msg_acum_sq_inj_delay, sizeof(msg_acum_sq_inj_delay));
+#endif /* BIMODAL */
+	io(port_utilization, sizeof(CLOCK_TYPE) * n_ports);
+	io(source_ports, sizeof(long) * n_ports);
+	io(dest_ports, sizeof(long) * n_ports);
+	if (plevel & 1)
+		for (i=0; i<nprocs; i++) {
+			io(destinations[i], sizeof(long) * nprocs);
+			io(sources[i], sizeof(long) * nprocs);
+		}
+	if (plevel & 4) {
+		io(inj_dst, sizeof(long) * max_dst);
+		io(con_dst, sizeof(long) * max_dst);
+	}
+	io(next_dest, sizeof(long) * nprocs);
+
+	// Convergency
+	io(&convergence, sizeof(long));
+	io(&converged, sizeof(bool_t));
+	io(&conv_start, sizeof(CLOCK_TYPE));
+	io(&prev_cons_load, sizeof(double));
+	io(&prev_latency, sizeof(double));
+}
+
+/**
+* Writes the checkpoint of the run, if requested.
+*
+* Called at the start of a cycle, or when the network is warm.
+*/
+void checkpoint_save(void) {
+	long v[CHECKPOINT_PARAMS];
+	char *in_use;
+	long i, n, bytes;
+
+	if (checkpoint_file[0] == '\0')
+		return;
+	if ((ck = fopen(checkpoint_file, "wb")) == NULL)
+		panic("Unable to open the checkpoint");
+
+	put(CHECKPOINT_MAGIC, 8);
+	network_params(v);
+	put(v, sizeof(v));
+	put(&load, sizeof(double));
+	put(&pattern, sizeof(traffic_pattern_t));
+	put(&batch_time, sizeof(CLOCK_TYPE));
+	put(&batch_phase, sizeof(batch_phase_t));
+	put(&sim_clock, sizeof(CLOCK_TYPE));
+	setstate((char *)rand_state);	// stores the position of the sequence in the state
+	put(rand_state, sizeof(rand_state));
+
+	for (i=0; i<NUMNODES; i++)
+		router_state(i, put, put_phits);
+
+	// Packets: the free list, in order, and the packets in use with their routing records.
+	put(&last, sizeof(long));
+	put(f_pkt, sizeof(long) * (last + 1));
+	in_use = alloc(pkt_max);
+	memset(in_use, 1, pkt_max);
+	for (i=0; i<=last; i++)
+		in_use[f_pkt[i]] = 0;
+	for (n=0; n<pkt_max; n++) {
+		if (!in_use[n])
+			continue;
+		put(&pkt_space[n], sizeof(packet_t));
+		bytes = (pkt_space[n].rr.rr != NULL) ? rr_bytes(pkt_space[n].rr.rr) : 0;
+		put(&bytes, sizeof(long));
+		put(pkt_space[n].rr.rr, bytes);
+	}
+	free(in_use);
+
+	stats_state(put);
+	if (batch_phase == STATIONARY_PHASE)
+		put(batch, sizeof(batch_t) * reseted);
+
+	if (fclose(ck) != 0)
+		panic("Unable to write the checkpoint");
+	printf("Checkpoint written to %s at cycle %"PRINT_CLOCK"\n", checkpoint_file, sim_clock);
+}
+
+/**
+* Restores the run from a checkpoint.
+*
+* The network must be initialized, as the checkpoint only has the state that changes while running.
+* If the load or the traffic pattern have changed, the run goes back to the convergency phase; if the
+* sampling period has changed, the stats of the batches are discarded and the samples are aligned again.
+*/
+void checkpoint_restore(void) {
+	long v[CHECKPOINT_PARAMS], cv[CHECKPOINT_PARAMS];
+	char magic[8], *in_use;
+	double ck_load;
+	traffic_pattern_t ck_pattern;
+	CLOCK_TYPE ck_batch_time;
+	int state[32];
+	long i, n, bytes;
+
+	if ((ck = fopen(restore_file, "rb")) == NULL)
+		panic("Unable to open the checkpoint to restore");
+
+	get(magic, 8);
+	if (memcmp(magic, CHECKPOINT_MAGIC, 8) != 0)
+		panic("Not an INSEE checkpoint");
+	network_params(v);
+	get(cv, sizeof(cv));
+	for (i=0; i<CHECKPOINT_PARAMS; i++)
+		if (v[i] != cv[i]) {
+			printf("The checkpoint has %s %ld, but this run has %ld\n", param_names[i], cv[i], v[i]);
+			panic("The checkpoint is not from this network");
+		}
+	get(&ck_load, sizeof(double));
+	get(&ck_pattern, sizeof(traffic_pattern_t));
+	get(&ck_batch_time, sizeof(CLOCK_TYPE));
+	get(&batch_phase, sizeof(batch_phase_t));
+	get(&sim_clock, sizeof(CLOCK_TYPE));
+	get(state, sizeof(state));
+
+	// The random sequence goes on from the same point. setstate() first stores the position in the
+	// state being left, so the state read is taken before it is copied to #rand_state.
+	setstate((char *)state);
+	memcpy(rand_state, state, sizeof(rand_state));
+	setstate((char *)rand_state);
+
+	for (i=0; i<NUMNODES; i++)
+		router_state(i, get, get_phits);
+
+	get(&last, sizeof(long));
+	if (last < -1 || last >= pkt_max)
+		panic("Inconsistent free packets in the checkpoint");
+	get(f_pkt, sizeof(long) * (last + 1));
+	in_use = alloc(pkt_max);
+	memset(in_use, 1, pkt_max);
+	for (i=0; i<=last; i++) {
+		if (f_pkt[i] < 0 || f_pkt[i] >= pkt_max)
+			panic("Inconsistent free packets in the checkpoint");
+		in_use[f_pkt[i]] = 0;
+	}
+	for (n=0; n<pkt_max; n++) {
+		if (!in_use[n])
+			continue;
+		get(&pkt_space[n], sizeof(packet_t));
+		get(&bytes, sizeof(long));
+		pkt_space[n].rr.rr = (bytes > 0) ? alloc(bytes) : NULL;
+		get(pkt_space[n].rr.rr, bytes);
+	}
+	free(in_use);
+
+	stats_state(get);
+	if (batch_phase == STATIONARY_PHASE) {
+		if (reseted >= samples)
+			panic("The checkpoint already has all the samples requested");
+		get(batch, sizeof(batch_t) * reseted);
+	}
+	fclose(ck);
+
+	printf("Restored from %s at cycle %"PRINT_CLOCK"\n", restore_file, sim_clock);
+	if (batch_phase != WARM_UP_PHASE && (ck_load != load || ck_pattern != pattern)) {
+		printf("The traffic has changed, the run goes back to the convergency phase\n");
+		batch_phase = CONVERGENCY_PHASE;
+		convergence = 0;
+		converged = B_FALSE;
+		conv_start = sim_clock;
+		prev_cons_load = prev_latency = 0.0;
+		reset_stats();
+	} else if (batch_phase == STATIONARY_PHASE && ck_batch_time != batch_time) {
+		printf("The sampling period has changed, the samples start again\n");
+		batch_phase = ALIGN_PHASE;
+	}
+}
@@ -289,9 +289,31 @@ void generate_phits(unsigned long packet, port_type iport) {
 * @param i The node in which the injection is performed.
 */
 void generate_pkt(long i) {
+	double aux = 0.0;
+
+	if ((drop_packets || network[i].pending_packet == 0) && network[i].triggered == 0 &&
+			network[i].source == INDEPENDENT_SOURCE){
+		aux=rand();
+		if (aux > aload )
+			return;
+	}
+	generate_pkt_now(i, aux);
+}
+
+/**
+* Generate a packet to inject, once the source has decided to.
+*
+* As generate_pkt(), without the random choice of injecting in this cycle. Used directly by the
+* event-driven engine, which draws the time between packets instead.
+*
+* @see generate_pkt
+*
+* @param i The node in which the injection is performed.
+* @param aux The random number (up to #aload) that decided the injection, used to choose the message type.
+*/
+void generate_pkt_now(long i, double aux) {
 	long d=-1, n;
 	unsigned long pkt;
-	double aux;
 	inj_queue *qi;
 	port_type iport;
 	packet_t packet;
@@ -304,17 +326,12 @@ void generate_pkt(long i) {
 	else{
 		if (network[i].triggered==0){
 			if (network[i].source==INDEPENDENT_SOURCE){
-				aux=rand();
-				if (aux > aload )
-					return;
 #if (BIMODAL_SUPPORT != 0)
-				else{
-					// Long or Short messages are generated.
-					if ( aux < lm_load )
-						packet.mtype = LONG_MSG;
-					else
-						packet.mtype = SHORT_MSG;
-				}
+				// Long or Short messages are generated.
+				if ( aux < lm_load )
+					packet.mtype = LONG_MSG;
+				else
+					packet.mtype = SHORT_MSG;
 #endif /* BIMODAL */
 			}
 		}
@@ -135,6 +135,18 @@ static literal_t options_l[] = {
 	{ PAR_SIMICS_SER, "serv_addr"},
 	{ PAR_SIMICS_WAIT, "num_wait_periods"},
 	{ PAR_SIMICS_WAIT, "num_periodos_espera"},
+	{ PAR_RESULTS, "results"},	/* Results store, instead of output files per run. */
+	{ PAR_PROFILE_SAMPLE, "profile_sample"},	/* Only when built with -DPROFILE. */
+	{ PAR_PROFILE_TRACE, "profile_trace"},
+	{ PAR_CHECKPOINT, "checkpoint"},	/* Warm-state checkpoints of batch runs. */
+	{ PAR_CHECKPOINT_CYCLE, "checkpoint_cycle"},
+	{ PAR_RESTORE, "restore"},
+	{ PAR_LOAD_SEARCH, "load_search"},	/* Saturation search, instead of a run at a given load. */
+	{ PAR_SEARCH_STEP, "search_step"},
+	{ PAR_SEARCH_TOL, "search_tol"},
+	{ PAR_SEARCH_MAX, "search_max"},
+	{ PAR_SEARCH_LATENCY, "search_latency"},
+	{ PAR_ENGINE, "engine"},	/* Cycle-driven or event-driven simulation engine. */
 	LITERAL_END
 };
 
@@ -405,6 +417,27 @@ literal_t injmode_l[] = {
 	LITERAL_END
 };
 
+/**
+* All the load searches are specified here.
+* @see literal.c
+*/
+literal_t search_l[] = {
+	{ NO_SEARCH,		"none"},
+	{ RAMP_SEARCH,		"ramp"},
+	{ BISECT_SEARCH,	"bisect"},
+	LITERAL_END
+};
+
+/**
+* All the simulation engines are specified here.
+* @see literal.c
+*/
+literal_t engine_l[] = {
+	{ CYCLE_ENGINE,		"cycle"},
+	{ EVENT_ENGINE,		"event"},
+	LITERAL_END
+};
+
 /**
 * All the placement strategies are specified here.
 * @see literal.c
@@ -449,6 +482,28 @@ void get_conf_file(char * fname) {
 	fclose(fdesc);
 }
 
+/**
+* Sets the provided injected load.
+*
+* Calculates the load as used in injection, so it can also be changed while running.
+*
+* @param l The load, in phits per node & cycle.
+*/
+void set_load(double l) {
+	load = l;
+#if (BIMODAL_SUPPORT != 0)
+	lm_prob = lm_percent/(msglength-(lm_percent*(msglength-1)));
+	aload = (long) (load * RAND_MAX * (msglength * (1-lm_prob) + lm_prob) / (pkt_len * msglength));
+	lm_load = aload * lm_prob ;
+#else
+	// is the same as above when msglength=1 & lm_percent=0 (bimodal: off)
+	aload = (long) ( (load/pkt_len) * RAND_MAX);
+#endif /* BIMODAL */
+
+	if (aload<0) //Because an overflow
+		aload = RAND_MAX;
+}
+
 /**
 * Get the configuration for the simulation.
 *
@@ -725,6 +780,48 @@ void get_option(char * option) {
 	case PAR_TRCFILE:
 		sscanf(value, "%s", trcfile);
 		break;
+	case PAR_RESULTS:
+		sscanf(value, "%s", results_file);
+		break;
+	case PAR_PROFILE_SAMPLE:
+		sscanf(value, "%ld", &profile_sample);
+		break;
+	case PAR_PROFILE_TRACE:
+		sscanf(value, "%s", profile_trace);
+		break;
+	case PAR_CHECKPOINT:
+		sscanf(value, "%s", checkpoint_file);
+		break;
+	case PAR_CHECKPOINT_CYCLE:
+		sscanf(value, "%"SCAN_CLOCK, &checkpoint_cycle);
+		break;
+	case PAR_RESTORE:
+		sscanf(value, "%s", restore_file);
+		break;
+	case PAR_LOAD_SEARCH:
+		if(!literal_value(search_l, value, (int*) &load_search)){
+			sprintf(message, "get_conf: Unknown load search: %s", value);
+			panic(message);
+		}
+		break;
+	case PAR_SEARCH_STEP:
+		sscanf(value, "%lf", &search_step);
+		break;
+	case PAR_SEARCH_TOL:
+		sscanf(value, "%lf", &search_tol);
+		break;
+	case PAR_SEARCH_MAX:
+		sscanf(value, "%lf", &search_max);
+		break;
+	case PAR_SEARCH_LATENCY:
+		sscanf(value, "%lf", &search_latency);
+		break;
+	case PAR_ENGINE:
+		if(!literal_value(engine_l, value, (int*) &engine)){
+			sprintf(message, "get_conf: Unknown simulation engine: %s", value);
+			panic(message);
+		}
+		break;
 	case PAR_PINT:
 		sscanf(value, "%"SCAN_CLOCK, &pinterval);
 		break;
@@ -1202,6 +1299,7 @@ void verify_conf(void) {
 	}
 
 	n_ports = radix*nchan + ninj + 1;
+	req_words = req_mask_words(n_ports);
 
 	if (topo == MIDIMEW){
 		if (ndim != 1)
@@ -1350,17 +1448,28 @@ void verify_conf(void) {
 	if (max_conv_time==0)
 		max_conv_time = (CLOCK_TYPE) 1000000L; // Should have converged in less than a million cycles.
 
-#if (BIMODAL_SUPPORT != 0)
-	lm_prob = lm_percent/(msglength-(lm_percent*(msglength-1)));
-	aload = (long) (load * RAND_MAX * (msglength * (1-lm_prob) + lm_prob) / (pkt_len * msglength));
-	lm_load = aload * lm_prob ;
-#else
-	// is the same as above when msglength=1 & lm_percent=0 (bimodal: off)
-	aload = (long) ( (load/pkt_len) * RAND_MAX);
-#endif /* BIMODAL */
+	if ((checkpoint_file[0] != '\0' || restore_file[0] != '\0') && (shotmode || pattern == TRACE || load_search != NO_SEARCH))
+		panic("Checkpoints are only supported in batch runs");
+	if (load_search != NO_SEARCH) {
+		if (shotmode || pattern == TRACE)
+			panic("The load search is only supported with independent sources");
+		if (search_step <= 0.0 || search_tol <= 0.0 || search_max < search_step)
+			panic("The load search requires 0 < search_step <= search_max and search_tol > 0");
+	}
+#if (EXECUTION_DRIVEN != 0)
+	if (engine == EVENT_ENGINE)
+		panic("The event-driven engine does not support execution-driven simulation");
+#endif
+	if (engine == EVENT_ENGINE) {
+		if (shotmode || pattern == TRACE)
+			panic("The event-driven engine is only supported with independent sources");
+		if (checkpoint_file[0] != '\0' || restore_file[0] != '\0')
+			panic("Checkpoints are not supported by the event-driven engine");
+		if (!parallel_injection || timeout_upper_limit > 0 || trigger_rate > 0.0)
+			panic("The event-driven engine requires par_inj=1, no timeouts and no triggered traffic");
+	}
 
-	if (aload<0) //Because an overflow
-		aload = RAND_MAX;
+	set_load(load);
 
 	trigger = trigger_rate * RAND_MAX;
 	trigger_dif = 1 + trigger_max - trigger_min;
@@ -1439,6 +1548,18 @@ void verify_conf(void) {
 */
 void set_default_conf (void) {
 	r_seed = 17;
+	results_file[0] = '\0';
+	profile_sample = 1024;
+	profile_trace[0] = '\0';
+	checkpoint_file[0] = '\0';
+	checkpoint_cycle = 0;
+	restore_file[0] = '\0';
+	load_search = NO_SEARCH;
+	search_step = 0.05;
+	search_tol = 0.01;
+	search_max = 1.0;
+	search_latency = 0.0;
+	engine = CYCLE_ENGINE;
 
 	pkt_len = 8;
 	phit_len = 8;
@@ -35,6 +35,7 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 #include "batch.h"
 #include "graph.h"
 #include "spanning_tree.h"
+#include "profiler.h"
 
 #include <math.h>
 #include <time.h>
@@ -51,6 +52,7 @@ extern long NUMNODES;
 extern long nprocs;
 extern long nnics;
 extern long n_ports;
+extern long req_words;
 
 extern long r_seed;
 extern long nodes_x, nodes_y, nodes_z;
@@ -225,10 +227,13 @@ extern void (* run_network)(void);
 
 void run_network_shotmode(void);
 void run_network_batch(void);
+void run_network_search(void);
 
 void report_receiving_tasks(void);
 
 /* In data_generation.c */
+extern long *next_dest;
+
 void init_injection(void);
 void injection_finish(void);
 void data_generation(long i);
@@ -236,6 +241,7 @@ void data_injection(long i);
 void datagen_oneshot(bool_t reset);
 
 void generate_pkt(long i);
+void generate_pkt_now(long i, double aux);
 port_type select_input_port_shortest(long i, long dest);
 port_type select_input_port_dor_only(long i, long dest);
 port_type select_input_port_dor_shortest(long i, long dest);
@@ -317,6 +323,7 @@ void phit_away(long, port_type, phit);
 void consume_single(long i);
 void consume_multiple(long i);
 void advance(long n, long p);
+void header_moved(long i, long n_n, port_type s_p, port_type d_p, phit ph);
 void data_movement_direct(bool_t inject);
 void data_movement_indirect(bool_t inject);
 
@@ -326,6 +333,7 @@ void finish_functions (void);
 
 /* In stats.c */
 void stats(long i);
+void flush_histograms(void);
 void reset_stats(void);
 
 /* In router.c */
@@ -403,8 +411,11 @@ extern literal_t cpu_units_l[];
 extern literal_t topology_l[];
 extern literal_t injmode_l[];
 extern literal_t placement_l[];
+extern literal_t search_l[];
+extern literal_t engine_l[];
 
 void get_conf(long, char **);
+void set_load(double l);
 
 /* In print_results.c */
 void print_headers(void);
@@ -412,11 +423,59 @@ void print_partials(void);
 void print_results(time_t, time_t);
 void results_partial(void);
 
+/* In results.c */
+extern char results_file[256];
+
+void results_open(void);
+void results_add(char *key, char *format, ...);
+void results_row(char *name);
+void results_vector(char *name, long *v, long n);
+void results_matrix_start(char *name, long rows, long cols);
+void results_matrix_row(long *v);
+void results_matrix_end(void);
+void results_real_matrix(char *name, double *m, long rows, long cols);
+void results_close(void);
+
+/* In profiler.c */
+extern long profile_sample;
+extern char profile_trace[256];
+
+void prof_init(void);
+void prof_finish(void);
+
+/* In checkpoint.c */
+extern char checkpoint_file[256];
+extern CLOCK_TYPE checkpoint_cycle;
+extern char restore_file[256];
+extern int rand_state[32];
+
+void checkpoint_save(void);
+void checkpoint_restore(void);
+
 /* In batch.c */
+extern batch_phase_t batch_phase;
+extern long convergence;
+extern bool_t converged;
+extern CLOCK_TYPE conv_start;
+extern double prev_cons_load, prev_latency;
+extern load_search_t load_search;
+extern double search_step, search_tol, search_max, search_latency;
+extern probe_t *probes;
+extern long n_probes, max_probes;
+extern double saturation_low, saturation_high;
+
 void save_batch_results();
+void fill_batch(batch_t *b);
 void print_batch_results(batch_t *b);
 void print_batch_results_vast(batch_t *b);
 
+/* In vct.c */
+extern engine_t engine;
+
+void vct_init(void);
+void vct_finish(void);
+void data_movement_vct(bool_t inject);
+
 /* In circulant.c */
 extern long step;	// 2nd dimension of a circulant graph
 extern long twist;
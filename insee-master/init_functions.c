@@ -47,6 +47,7 @@ void init_functions (void) {
 #if (TRACE_SUPPORT != 0)
     else if (pattern == TRACE) run_network = run_network_trc;
 #endif
+    else if (load_search != NO_SEARCH) run_network = run_network_search;
     else run_network = run_network_batch;
 
 #if (EXECUTION_DRIVEN != 0)
@@ -55,7 +56,15 @@ void init_functions (void) {
     run_network = run_network_exd;
 #endif
 
-    batch = alloc(sizeof(batch_t)*(samples+1));
+    if (load_search != NO_SEARCH) {
+        // The ramp, and the bisection of its last step (none if the step is within the tolerance)
+        max_probes = (long)(search_max / search_step + 1e-9) + 1;
+        if (search_step > search_tol)
+            max_probes += (long)ceil(log2(search_step / search_tol));
+        probes = alloc(sizeof(probe_t)*max_probes);
+        batch = alloc(sizeof(batch_t)*max_probes);
+    } else
+        batch = alloc(sizeof(batch_t)*(samples+1));
     source_ports = alloc(sizeof(long)*n_ports);
     dest_ports = alloc(sizeof(long)*n_ports);
     port_utilization = alloc(sizeof(CLOCK_TYPE)*n_ports);
@@ -467,6 +476,10 @@ void init_functions (void) {
         else
             arbitrate = arbitrate_arbitrary;
     }
+    if (engine == EVENT_ENGINE) {
+        data_movement = data_movement_vct;
+        vct_init();
+    }
 
 	fflush(stdout);
 }
@@ -476,6 +489,10 @@ void finish_functions(void){
     long i;
 
     free(batch);
+    if (load_search != NO_SEARCH)
+        free(probes);
+    if (engine == EVENT_ENGINE)
+        vct_finish();
     free(source_ports);
     free(dest_ports);
     free(port_utilization);
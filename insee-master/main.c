@@ -60,6 +60,7 @@ long stDown;		///< Number of links down in a slim/thin tree. It also refeers to
 long stUp;			///< Number of links up in a slim tree.
 long NUMNODES;		///< Total number of nodes.
 long n_ports;		///< Total number of ports in each router.
+long req_words;		///< Number of words of the request mask of every port.
 long nprocs;		///< Total number nodes that are able to inject.
 long nnics;
 
@@ -622,7 +623,8 @@ int main(int argc, char *argv[]) {
 	get_conf((long)(argc - 1), argv + 1);
 	sim_clock = (CLOCK_TYPE) 1L; // HAS TO BE ONE for arbitrate to work
 
-	srand(r_seed);
+	// Same sequence as srand(), in a state that the checkpoints can save.
+	initstate((unsigned int)r_seed, (char *)rand_state, sizeof(rand_state));
 
 	router_init();
 	pkt_init();
@@ -636,9 +638,11 @@ int main(int argc, char *argv[]) {
 	if (pheaders > 0)
 		print_headers();
 
+	prof_init();
 	run_network();
 	time(&end_time);
 	print_results(start_time, end_time);
+	prof_finish();
 
         finish_network();
         injection_finish();
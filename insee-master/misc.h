@@ -251,6 +251,23 @@ typedef enum inj_mode_t {
 	DOR_INJ, DOR_SHORTEST_INJ, SHORTEST_PROFITABLE_INJ, LONGEST_PATH_INJ
 } inj_mode_t;
 
+/**
+* Definition of the load searches for the saturation point.
+*/
+typedef enum load_search_t {
+	NO_SEARCH,		// A run at the given load.
+	RAMP_SEARCH,	// Increase the load by steps until the network saturates.
+	BISECT_SEARCH	// Ramp up, then bisect between the last two loads.
+} load_search_t;
+
+/**
+* Definition of the simulation engines.
+*/
+typedef enum engine_t {
+	CYCLE_ENGINE,	// Every router is visited in every cycle, phit by phit.
+	EVENT_ENGINE	// Only the routers with something to do are visited, packet by packet.
+} engine_t;
+
 /**
 * Definition of task placement types for trace driven.
 */
@@ -334,7 +351,19 @@ PAR_VCINJ,
 PAR_SIMICS_REL1,
 PAR_SIMICS_REL2,
 PAR_SIMICS_SER,
-PAR_SIMICS_WAIT
+PAR_SIMICS_WAIT,
+PAR_RESULTS,
+PAR_PROFILE_SAMPLE,
+PAR_PROFILE_TRACE,
+PAR_CHECKPOINT,
+PAR_CHECKPOINT_CYCLE,
+PAR_RESTORE,
+PAR_LOAD_SEARCH,
+PAR_SEARCH_STEP,
+PAR_SEARCH_TOL,
+PAR_SEARCH_MAX,
+PAR_SEARCH_LATENCY,
+PAR_ENGINE
 } parameters_t;
 
 // Some declarations.
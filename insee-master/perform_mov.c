@@ -130,28 +130,31 @@ void consume_multiple(long i) {
 */
 void data_movement_direct(bool_t inject) {
 	long i,	// Node id
-		 e,	// port number
-		 ee;// port requested by port 'e'
+		 e;	// port number
 	dim j;
 
 	for (i=0; i<NUMNODES; i++) {
 		if (plevel & 8)
 			stats(i);
+		PROF_START(PROF_INJECTION);
 		if (inject)
 			data_generation(i);
 		data_injection(i);
+		PROF_END(PROF_INJECTION);
 
 #if (PCOUNT!=0)
 		if (network[i].pcount){
 #endif
-			for (e=0; e<=p_con; e++)
-				for (ee=0; ee<p_con; ee++)
-					network[i].p[e].req[ee] = (CLOCK_TYPE) 0L;
+			PROF_START(PROF_REQUEST_PORT);
+			clear_requests(i);
 			for (e=0; e<p_con; e++)
 				request_port(i, e);
+			PROF_END(PROF_REQUEST_PORT);
+			PROF_START(PROF_ARBITRATE);
 			arbitrate_cons(i);
 			for (e=0; e<p_con; e++)
 				arbitrate(i, e);
+			PROF_END(PROF_ARBITRATE);
 
 			// Congestion with timeouts.
 			if (timeout_upper_limit>0) {
@@ -171,9 +174,13 @@ void data_movement_direct(bool_t inject) {
 #if (PCOUNT!=0)
 		if (network[i].pcount){
 #endif
+			PROF_START(PROF_CONSUME);
 			consume(i);
+			PROF_END(PROF_CONSUME);
+			PROF_START(PROF_ADVANCE);
 			for (j=D_X; j<radix; j++)
 				advance(i, j);
+			PROF_END(PROF_ADVANCE);
 		}
 #if (PCOUNT!=0)
 	}
@@ -190,8 +197,7 @@ void data_movement_direct(bool_t inject) {
 */
 void data_movement_indirect(bool_t inject) {
 	long i,		// Node id
-		 e,		// port number
-		 ee;	// port requested by port 'e'
+		 e;		// port number
 
 	dim j;
 
@@ -199,29 +205,31 @@ void data_movement_indirect(bool_t inject) {
 		if (plevel & 8)
 			stats(i);
 		if (i<nprocs){	// This is a NIC. There are only ports for injection/consumption and 1 output port.
+			PROF_START(PROF_INJECTION);
 			if (inject)
 				data_generation(i);
 			data_injection(i);
+			PROF_END(PROF_INJECTION);
 
 #if (PCOUNT!=0)
 			if (network[i].pcount){
 #endif
-				for (e = 0; e < (nchan * nnics); e++)	// only injection can ask for the output port.
-					for (ee=p_inj_first; ee<p_con; ee++)
-						network[i].p[e].req[ee] = (CLOCK_TYPE) 0L;
-				for (ee = 0; ee < (nchan * nnics); ee++)	// Only the output port can ask for the consumption port.
-					network[i].p[p_con].req[ee] = (CLOCK_TYPE) 0L;
+				PROF_START(PROF_REQUEST_PORT);
+				clear_requests(i);
 
 				for (e = 0; e < (nchan * nnics); e++)	// output port requesting
 					request_port(i, e);
 				for (e = p_inj_first; e<p_con; e++)	// injection port requesting
 					request_port(i, e);
+				PROF_END(PROF_REQUEST_PORT);
 
+				PROF_START(PROF_ARBITRATE);
 				arbitrate_cons(i);
 				for (e = 0; e < (nchan * nnics); e++)	// output port arbitration
 					arbitrate(i, e);
 				for (e=p_inj_first; e<p_con; e++)	// injection port arbitration
 					arbitrate(i, e);
+				PROF_END(PROF_ARBITRATE);
 #if (PCOUNT!=0)
 			}
 #endif
@@ -230,15 +238,17 @@ void data_movement_indirect(bool_t inject) {
 #if (PCOUNT!=0)
 			if (network[i].pcount){
 #endif
-				for (e=0; e<=p_con; e++)
-					for (ee=0; ee<p_con; ee++)
-						network[i].p[e].req[ee] = (CLOCK_TYPE) 0L;
+				PROF_START(PROF_REQUEST_PORT);
+				clear_requests(i);
 				for (e=0; e<=p_inj_last; e++)
 					request_port(i, e);
+				PROF_END(PROF_REQUEST_PORT);
 
+				PROF_START(PROF_ARBITRATE);
 				arbitrate_cons(i);
 				for (e=0; e<p_inj_last; e++)
 					arbitrate(i, e);
+				PROF_END(PROF_ARBITRATE);
 #if (PCOUNT!=0)
 			}
 #endif
@@ -260,9 +270,13 @@ void data_movement_indirect(bool_t inject) {
 #if (PCOUNT!=0)
 		if (network[i].pcount){
 #endif
+			PROF_START(PROF_CONSUME);
 			consume(i);
+			PROF_END(PROF_CONSUME);
+			PROF_START(PROF_ADVANCE);
 			for(j = 0; j < nnics; j++)
 				advance(i, j);
+			PROF_END(PROF_ADVANCE);
 #if (PCOUNT!=0)
 		}
 #endif
@@ -272,9 +286,13 @@ void data_movement_indirect(bool_t inject) {
 #if (PCOUNT!=0)
 		if (network[i].pcount){
 #endif
+			PROF_START(PROF_CONSUME);
 			consume(i);
+			PROF_END(PROF_CONSUME);
+			PROF_START(PROF_ADVANCE);
 			for(j=0; j<radix; j++)
 				advance(i, j);
+			PROF_END(PROF_ADVANCE);
 #if (PCOUNT!=0)
 		}
 #endif
@@ -437,7 +455,6 @@ void phit_away(long i, port_type s_p, phit ph) {
 */
 void phit_moved(long i, long n_n, port_type s_p, port_type d_p, phit ph) {
 	queue *n_q;
-	dim j; way k;
 	n_q = &(network[n_n].p[d_p].q);
 
 	if (queue_space(n_q)<1)
@@ -447,71 +464,8 @@ void phit_moved(long i, long n_n, port_type s_p, port_type d_p, phit ph) {
 		panic(message);
 	}
 
-	if ((ph.pclass == RR) || (ph.pclass == RR_TAIL)) {
-		// Congestion with timeouts.
-		if (timeout_upper_limit > 0){
-			if (network[n_n].timeout_packet == NULL_PORT) {
-				network[n_n].timeout_counter = (CLOCK_TYPE) 0L;
-				network[n_n].timeout_packet = ph.packet;
-			}
-			if (network[i].timeout_packet == ph.packet)	{
-				if (network[i].timeout_counter < timeout_lower_limit)
-					network[i].congested=B_FALSE;
-				network[i].timeout_counter = (CLOCK_TYPE) 0L;
-				network[i].timeout_packet = NULL_PACKET;
-			}
-		}
-		// Update routing record only for direct topologies.
-		if (topo<DIRECT){
-			j = port_coord_dim[d_p];
-			k = port_coord_way[d_p];
-
-			if (k == UP)
-				pkt_space[ph.packet].rr.rr[j]--;
-			else
-				pkt_space[ph.packet].rr.rr[j]++;
-		}
-
-		// Update routing record only for direct topologies.
-		if (topo==ICUBE && n_n >= nprocs && i >= nprocs){
-			j = port_coord_dim[d_p];	// Should be checking the destination port in the neighbor node.
-			k = port_coord_way[d_p];	// Should be checking the destination port in the neighbor node.
-
-			if (k == DOWN)	// In indirect cube d_p is the port opposite to the destination port in the neighbor node(d_np).
-				if (pkt_space[ph.packet].rr.rr[j]<0)
-					panic("going through - while rr is positive");
-				else
-				pkt_space[ph.packet].rr.rr[j]--;
-			else
-				if (pkt_space[ph.packet].rr.rr[j]>0)
-					panic("going through + while rr is negative");
-				else
-				pkt_space[ph.packet].rr.rr[j]++;
-		}
-
-		if (s_p >= p_inj_first){
-			CLOCK_TYPE del;
-			injected_count++;
-
-			del = sim_clock - pkt_space[ph.packet].inj_time;
-			acum_inj_delay += del;
-			acum_sq_inj_delay += del*del;
-			if (del > max_inj_delay)
-				max_inj_delay = del;
-#if (BIMODAL_SUPPORT != 0)
-                        if(msglength > 1){
-			msg_injected_count[pkt_space[ph.packet].mtype]++;
-			msg_acum_inj_delay[pkt_space[ph.packet].mtype] += del;
-			msg_acum_sq_inj_delay[pkt_space[ph.packet].mtype] += del*del;
-			if (del > msg_max_inj_delay[pkt_space[ph.packet].mtype])
-				msg_max_inj_delay[pkt_space[ph.packet].mtype] = del;
-                        }
-#endif /* BIMODAL */
-			if (i == monitored)
-				dest_ports[network[i].p[s_p].aop]++;
-		}/* injection */
-		pkt_space[ph.packet].n_hops++;
-	}/* RR */
+	if ((ph.pclass == RR) || (ph.pclass == RR_TAIL))
+		header_moved(i, n_n, s_p, d_p, ph);
 
 	ins_queue(n_q, &ph);
 
@@ -528,3 +482,83 @@ void phit_moved(long i, long n_n, port_type s_p, port_type d_p, phit ph) {
 		port_utilization[network[i].p[s_p].aop]++;
 }
 
+/**
+* The header of a packet moves from a router to one of its neighbors.
+*
+* Updates the congestion timeouts, the routing record and, when the packet leaves
+* its injection queue, the injection statistics. Used by phit_moved() and by the
+* event-driven engine, which moves whole packets.
+*
+* @param i The number of the source node.
+* @param n_n The neighbor node(node to move to).
+* @param s_p Source port (input port of the node).
+* @param d_p Destination port (input port of the neighbor).
+* @param ph The header phit.
+*/
+void header_moved(long i, long n_n, port_type s_p, port_type d_p, phit ph) {
+	dim j; way k;
+
+	// Congestion with timeouts.
+	if (timeout_upper_limit > 0){
+		if (network[n_n].timeout_packet == NULL_PORT) {
+			network[n_n].timeout_counter = (CLOCK_TYPE) 0L;
+			network[n_n].timeout_packet = ph.packet;
+		}
+		if (network[i].timeout_packet == ph.packet)	{
+			if (network[i].timeout_counter < timeout_lower_limit)
+				network[i].congested=B_FALSE;
+			network[i].timeout_counter = (CLOCK_TYPE) 0L;
+			network[i].timeout_packet = NULL_PACKET;
+		}
+	}
+	// Update routing record only for direct topologies.
+	if (topo<DIRECT){
+		j = port_coord_dim[d_p];
+		k = port_coord_way[d_p];
+
+		if (k == UP)
+			pkt_space[ph.packet].rr.rr[j]--;
+		else
+			pkt_space[ph.packet].rr.rr[j]++;
+	}
+
+	// Update routing record only for direct topologies.
+	if (topo==ICUBE && n_n >= nprocs && i >= nprocs){
+		j = port_coord_dim[d_p];	// Should be checking the destination port in the neighbor node.
+		k = port_coord_way[d_p];	// Should be checking the destination port in the neighbor node.
+
+		if (k == DOWN)	// In indirect cube d_p is the port opposite to the destination port in the neighbor node(d_np).
+			if (pkt_space[ph.packet].rr.rr[j]<0)
+				panic("going through - while rr is positive");
+			else
+			pkt_space[ph.packet].rr.rr[j]--;
+		else
+			if (pkt_space[ph.packet].rr.rr[j]>0)
+				panic("going through + while rr is negative");
+			else
+			pkt_space[ph.packet].rr.rr[j]++;
+	}
+
+	if (s_p >= p_inj_first){
+		CLOCK_TYPE del;
+		injected_count++;
+
+		del = sim_clock - pkt_space[ph.packet].inj_time;
+		acum_inj_delay += del;
+		acum_sq_inj_delay += del*del;
+		if (del > max_inj_delay)
+			max_inj_delay = del;
+#if (BIMODAL_SUPPORT != 0)
+                        if(msglength > 1){
+		msg_injected_count[pkt_space[ph.packet].mtype]++;
+		msg_acum_inj_delay[pkt_space[ph.packet].mtype] += del;
+		msg_acum_sq_inj_delay[pkt_space[ph.packet].mtype] += del*del;
+		if (del > msg_max_inj_delay[pkt_space[ph.packet].mtype])
+			msg_max_inj_delay[pkt_space[ph.packet].mtype] = del;
+                        }
+#endif /* BIMODAL */
+		if (i == monitored)
+			dest_ports[network[i].p[s_p].aop]++;
+	}/* injection */
+	pkt_space[ph.packet].n_hops++;
+}
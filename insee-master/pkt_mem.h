@@ -6,6 +6,9 @@
 #ifndef _pkt_mem
 #define _pkt_mem
 
+extern long *f_pkt;
+extern long last;
+
 void pkt_init();
 void free_pkt(unsigned long n);
 unsigned long get_pkt();
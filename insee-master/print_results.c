@@ -145,6 +145,160 @@ void print_partials(void) {
 	fflush(stdout);
 }
 
+/**
+* An array containing the names of the batch results in the results store, in the order of bheader.
+*/
+static char * bname[] =
+{
+	"batch.time", "av.distance", "inj.load", "acc.load", "packets.sent", "packets.rcvd", "packets.drop",
+	"avg.delay", "stdev.delay", "max.delay", "inj.avg.delay", "inj.stdev.delay", "inj.max.delay"
+};
+
+/**
+* Appends the results of the run to the results store.
+*
+* The summary of the run (with the average & standard deviation of every batch result) is stored
+* as a row, the batches as a matrix and, depending on plevel, the maps and histograms that would
+* be written to the .map & .hst files.
+*
+* @see results.c
+*/
+static void store_results(time_t start_time, time_t end_time, char *computer_name, char *topo_s,
+		char *routing_s, char *vc_s, char *pattern_s, CLOCK_TYPE copyclock) {
+	long i, j, c;
+	channel e;
+	double *m, avg, sq;
+	long *v;
+	char started[32], key[64], *search_s;
+
+	results_open();
+	strftime(started, sizeof(started), "%Y.%m.%d.%H.%M.%S", localtime(&start_time));
+	results_add("started.at", "%s", started);
+	results_add("on.machine", "%s", computer_name);
+	results_add("status", "%s", interrupted ? "interrupted" : (aborted ? "aborted" : "completed"));
+	results_add("runtime", "%ld", (long)(end_time - start_time));
+	results_add("sim.clock", "%"PRINT_CLOCK, sim_clock);
+	results_add("r.seed", "%ld", r_seed);
+	results_add("topology", "%s", topo_s);
+	results_add("nodes.x", "%ld", nodes_x);
+	results_add("nodes.y", "%ld", nodes_y);
+	results_add("nodes.z", "%ld", nodes_z);
+	results_add("n.nodes", "%ld", NUMNODES);
+	results_add("n.procs", "%ld", nprocs);
+	results_add("radix", "%ld", radix);
+	results_add("faults", "%ld", faults);
+	results_add("routing", "%s", routing_s);
+	results_add("vc.management", "%s", vc_s);
+	results_add("n.vcs", "%ld", nchan);
+	results_add("buffer.capacity", "%ld", buffer_cap);
+	results_add("packet.length", "%ld", pkt_len);
+	results_add("pattern", "%s", pattern_s);
+	if (load_search != NO_SEARCH) {
+		literal_name(search_l, &search_s, load_search);
+		results_add("load.search", "%s", search_s);
+		results_add("saturation.low", "%f", saturation_low);
+		results_add("saturation.high", "%f", saturation_high);
+	} else
+		results_add("load", "%f", load);
+	results_add("n.samples", "%ld", reseted);
+
+	m = alloc((reseted + 1) * 13 * sizeof(double));
+	for (i = 0; i < reseted; i++) {
+		m[(i * 13) + 0] = batch[i].clock;
+		m[(i * 13) + 1] = batch[i].avDist;
+		m[(i * 13) + 2] = batch[i].inj_load;
+		m[(i * 13) + 3] = batch[i].acc_load;
+		m[(i * 13) + 4] = batch[i].sent_count;
+		m[(i * 13) + 5] = batch[i].rcvd_count;
+		m[(i * 13) + 6] = batch[i].dropped_count;
+		m[(i * 13) + 7] = batch[i].avg_delay;
+		m[(i * 13) + 8] = batch[i].stDev_delay;
+		m[(i * 13) + 9] = batch[i].max_delay;
+		m[(i * 13) + 10] = batch[i].avg_inj_delay;
+		m[(i * 13) + 11] = batch[i].stDev_inj_delay;
+		m[(i * 13) + 12] = batch[i].max_inj_delay;
+	}
+	for (c = 0; c < 13 && reseted > 0; c++) {
+		avg = sq = 0.0;
+		for (i = 0; i < reseted; i++) {
+			avg += m[(i * 13) + c];
+			sq += m[(i * 13) + c] * m[(i * 13) + c];
+		}
+		sprintf(key, "avg.%s", bname[c]);
+		results_add(key, "%f", avg / reseted);
+		if (reseted > 1) {
+			sprintf(key, "std.%s", bname[c]);
+			results_add(key, "%f", sqrt(fabs((sq - (avg * avg) / reseted) / (reseted - 1))));
+		}
+	}
+	results_row("summary");
+	if (reseted > 0)
+		results_real_matrix("batches", m, reseted, 13);
+	free(m);
+
+	if (load_search != NO_SEARCH && n_probes > 0) {
+		m = alloc(n_probes * 5 * sizeof(double));
+		for (i = 0; i < n_probes; i++) {
+			m[(i * 5) + 0] = probes[i].load;
+			m[(i * 5) + 1] = probes[i].b.inj_load;
+			m[(i * 5) + 2] = probes[i].b.acc_load;
+			m[(i * 5) + 3] = probes[i].b.avg_delay;
+			m[(i * 5) + 4] = probes[i].saturated;
+		}
+		results_real_matrix("load.curve", m, n_probes, 5);
+		free(m);
+	}
+
+	if (plevel & 1) {
+		results_matrix_start("sources", nprocs, nprocs);
+		for (i = 0; i < nprocs; i++)
+			results_matrix_row(sources[i]);
+		results_matrix_end();
+		results_matrix_start("destinations", nprocs, nprocs);
+		for (i = 0; i < nprocs; i++)
+			results_matrix_row(destinations[i]);
+		results_matrix_end();
+	}
+
+	j = (NUMNODES == nprocs) ? 0 : nprocs;	// Do not store the NICs.
+	if (plevel & 2) {
+		m = alloc((NUMNODES - j) * p_inj_first * sizeof(double));
+		for (i = j; i < NUMNODES; i++)
+			for (e = 0; e < p_inj_first; e++)
+				m[((i - j) * p_inj_first) + e] = 1.0 * network[i].p[e].utilization / copyclock;
+		results_real_matrix("utilization", m, NUMNODES - j, p_inj_first);
+		free(m);
+	}
+
+	if (plevel & 4) {
+		v = alloc(2 * sizeof(long));
+		results_matrix_start("distance", max_dst, 2);
+		for (i = 0; i < max_dst; i++) {
+			v[0] = inj_dst[i];
+			v[1] = con_dst[i];
+			results_matrix_row(v);
+		}
+		results_matrix_end();
+		free(v);
+	}
+
+	if (plevel & 8) {
+		flush_histograms();
+		v = alloc((buffer_cap + 1) * sizeof(long));
+		results_matrix_start("port.histogram", (NUMNODES - j) * (p_inj_last + 1), buffer_cap + 1);
+		for (i = j; i < NUMNODES; i++)
+			for (e = 0; e <= p_inj_last; e++) {
+				for (c = 0; c <= buffer_cap; c++)
+					v[c] = network[i].p[e].histo[c];
+				results_matrix_row(v);
+			}
+		results_matrix_end();
+		free(v);
+	}
+	results_close();
+	printf("Results stored in:                %s\n", results_file);
+}
+
 /**
 * Prints the final summary & results.
 *
@@ -161,7 +315,7 @@ void print_results(time_t start_time, time_t end_time) {
 	unsigned long cn_size = 1024;
 	char computer_name[1024];
 	char tmp[100];
-	char *topo_s, *vc_s, *routing_s, *pattern_s, *ctype_s, *reqtype_s, *arbtype_s, *inj_s, *placement_s, *cpu_units_s;
+	char *topo_s, *vc_s, *routing_s, *pattern_s, *ctype_s, *reqtype_s, *arbtype_s, *inj_s, *placement_s, *cpu_units_s, *search_s;
         double *avg_util;
         long sw;
 	CLOCK_TYPE copyclock;
@@ -401,6 +555,15 @@ void print_results(time_t start_time, time_t end_time) {
 			printf("Shot mode (numshots x shotsize):  YES (%ld x %ld)\n", samples, shotsize);
 			}
 		else{
+			if (load_search != NO_SEARCH){
+				literal_name(search_l, &search_s, load_search);
+				printf("Traffic pattern:                  %s, packets of %ld phits\n", pattern_s, pkt_len);
+				printf("Load search, step, tolerance:     %s, %1.5f, %1.5f (up to %1.5f)\n", search_s, search_step, search_tol, search_max);
+				if (saturation_high > 0.0)
+					printf("Saturation load between:          %1.5f and %1.5f\n", saturation_low, saturation_high);
+				else
+					printf("Saturation load over:             %1.5f\n", saturation_low);
+			} else
 		    printf("Traffic pattern:                  %s at load %1.5f, packets of %ld phits\n", pattern_s, load, pkt_len);
 			printf("Trigger rate, packets triggered:  %1.5f %5ld", trigger_rate, trigger_min);
 			if (trigger_min!=trigger_max)
@@ -464,6 +627,15 @@ void print_results(time_t start_time, time_t end_time) {
 
 	printf("\n===============================================================================================================================================================\n");
 
+	// Load-latency curve of the search, a probe in every batch
+	if (load_search != NO_SEARCH && reseted>0) {
+		printf("\nLoad-latency curve:\n        load,    injload,    accload,   avgdelay,     cycles, saturated");
+		for (i=0; i<n_probes; i++)
+			printf("\n%12.5f, %10.5f, %10.5f, %10.2f, %10"PRINT_CLOCK", %s", probes[i].load, probes[i].b.inj_load,
+					probes[i].b.acc_load, probes[i].b.avg_delay, probes[i].cycles, probes[i].saturated ? "YES" : "NO");
+		printf("\n");
+	}
+
 	// Batch results
 	if (reseted>0) {
         printf("\n  #");
@@ -548,8 +720,10 @@ void print_results(time_t start_time, time_t end_time) {
 #if (EXECUTION_DRIVEN != 0)
 		copyclock = sim_clock - last_reset_time;
 #endif
+	if (load_search != NO_SEARCH) // maps & histograms cover the whole search
+		copyclock = sim_clock - warmed_up;
 
-	if(pattern!=TRACE && samples>1){ // In trace-driven there's only 1 sample: no AVG nor STD.
+	if(pattern!=TRACE && load_search == NO_SEARCH && samples>1){ // In trace-driven there's only 1 sample: no AVG nor STD.
 		printf("\n\nAVG");
 		if (bheaders & 1)
 			printf(", %10.2f", (res[0]/samples));
@@ -613,6 +787,9 @@ void print_results(time_t start_time, time_t end_time) {
     else if (aborted)
         printf("** Execution aborted **\n");
 
+    if (results_file[0] != '\0')
+        store_results(start_time, end_time, computer_name, topo_s, routing_s, vc_s, pattern_s, copyclock);
+
 	if(plevel & 64) {
 		fprintf(fp, "\n\nSource ports:        ");
 		for(e=0;e<p_inj_first;e++)
@@ -627,7 +804,7 @@ void print_results(time_t start_time, time_t end_time) {
 		fclose(fp);
 	}
 
-	if (plevel & 1 || plevel & 2){
+	if (results_file[0] == '\0' && (plevel & 1 || plevel & 2)){
 // Maps for all the network
 #if (EXECUTION_DRIVEN != 0)
 		sprintf(map, "%s.%ld.map", file, num_executions);
@@ -716,7 +893,7 @@ void print_results(time_t start_time, time_t end_time) {
 		}
 	}
 
-	if(plevel & 4 || plevel & 8){
+	if(results_file[0] == '\0' && (plevel & 4 || plevel & 8)){
 // End of network mapping information
 
 // Histogram for all nodes
@@ -735,6 +912,7 @@ void print_results(time_t start_time, time_t end_time) {
 				fprintf(fp,"\n\n");
 			}
 			if (plevel & 8){
+				flush_histograms();
 				fprintf(fp, "HISTOGRAM OF PORT UTILIZATION\n\n");
 				fprintf(fp, "   Node, Port,  Empty");
 				for (c=1; c<buffer_cap; c++)
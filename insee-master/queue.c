@@ -29,6 +29,93 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 */
 void init_queue (queue *q) {
 	q->head = q->tail = 0;
+	q->histo = NULL;
+}
+
+/**
+* Calculates the occupancy level of a queue, as accounted in the histograms.
+*
+* @param q A queue.
+* @return The number of packets in the queue, counting a partial packet at the head.
+*/
+static long occupancy_level (queue *q) {
+	long ql_p, ql_m;
+	phit *p;
+
+	ql_p = queue_len(q);
+	ql_m = ql_p/pkt_len;
+	if (ql_p) {
+		p = &((q->pos)[(q->head + 1)%tr_ql]);
+		if ((p->pclass != RR) && (p->pclass != RR_TAIL))
+			ql_m++;
+	}
+	if (ql_m > buffer_cap + 1)
+		panic("Too many packets");
+	return ql_m;
+}
+
+/**
+* Updates the occupancy histogram after the contents of a queue have changed.
+*
+* All the samples taken since the last change have seen the previous occupancy level,
+* so they are credited to it at once. Queues whose level does not change cost nothing.
+*
+* @param q A queue.
+*/
+static void occupancy_change (queue *q) {
+	long l;
+
+	if (q->histo == NULL)
+		return;
+	l = occupancy_level(q);
+	if (l != q->level) {
+		q->histo[q->level] += *(q->samples) - q->since;
+		q->since = *(q->samples);
+		q->level = l;
+	}
+}
+
+/**
+* Starts collecting the occupancy histogram of a queue.
+*
+* @param q A queue.
+* @param histo The histogram to fill, with buffer_cap + 1 levels.
+* @param samples The counter of samples of the router owning the queue.
+*/
+void queue_occupancy_init (queue *q, CLOCK_TYPE *histo, CLOCK_TYPE *samples) {
+	q->histo = histo;
+	q->samples = samples;
+	q->since = *samples;
+	q->level = occupancy_level(q);
+}
+
+/**
+* Credits the pending samples of a queue to its histogram.
+*
+* Required before reading the histogram.
+*
+* @param q A queue.
+*/
+void queue_occupancy_flush (queue *q) {
+	if (q->histo == NULL)
+		return;
+	q->histo[q->level] += *(q->samples) - q->since;
+	q->since = *(q->samples);
+}
+
+/**
+* Clears the occupancy histogram of a queue, discarding the pending samples.
+*
+* @param q A queue.
+*/
+void queue_occupancy_reset (queue *q) {
+	long l;
+
+	if (q->histo == NULL)
+		return;
+	for (l=0; l<buffer_cap+1; l++)
+		q->histo[l] = (CLOCK_TYPE) 0L;
+	q->since = *(q->samples);
 }
 
 /**
@@ -97,6 +184,7 @@ void ins_queue (queue *q, phit *i) {
 	else {
 		q->tail = (q->tail + 1)%tr_ql;
 		(q->pos)[q->tail] = *i;
+		occupancy_change(q);
 	}
 }
 
@@ -119,6 +207,7 @@ void ins_mult_queue (queue *q, phit *i, long copies) {
 			q->tail = (q->tail + 1)%tr_ql;
 			(q->pos)[q->tail] = *i;
 		}
+	occupancy_change(q);
 }
 
 /**
@@ -136,6 +225,7 @@ void rem_queue (queue *q, phit *i) {
 	else {
 		q->head = (q->head + 1)%tr_ql;
 		*i = (q->pos)[q->head];
+		occupancy_change(q);
 	}
 }
 
@@ -149,7 +239,50 @@ void rem_queue (queue *q, phit *i) {
 void rem_head_queue (queue *q) {
 	if (queue_len(q) == 0)
 		panic("Removing the head of an empty queue");
-	else
+	else {
 		q->head = (q->head + 1)%tr_ql;
+		occupancy_change(q);
+	}
+}
+
+/**
+* Inserts a whole packet in a queue, in a single step.
+*
+* Only the header is written, at the position of the first phit; the rest of the
+* packet just takes its room. Used by the event-driven engine, whose queues only
+* hold whole packets, so the header is always found at the head of the queue.
+* Requires enough space. Otherwise, panics.
+*
+* @param q A queue.
+* @param i The header of the packet.
+* @param size The number of phits of the packet.
+*/
+void ins_packet_queue (queue *q, phit *i, long size) {
+	if (queue_space(q) < size)
+		panic("Inserting a packet in a full queue");
+	else {
+		(q->pos)[(q->tail + 1)%tr_ql] = *i;
+		q->tail = (q->tail + size)%tr_ql;
+		occupancy_change(q);
+	}
 }
 
+/**
+* Takes the first packet in a queue, in a single step.
+*
+* Complement of ins_packet_queue(): returns the header via "i" and frees the room
+* of the whole packet. Requires a packet in the queue. Otherwise, panics.
+*
+* @param q A queue.
+* @param i The header of the removed packet is returned here.
+* @param size The number of phits of the packet.
+*/
+void rem_packet_queue (queue *q, phit *i, long size) {
+	if (queue_len(q) < size)
+		panic("Removing a packet from an empty queue");
+	else {
+		*i = (q->pos)[(q->head + 1)%tr_ql];
+		q->head = (q->head + size)%tr_ql;
+		occupancy_change(q);
+	}
+}
@@ -15,6 +15,12 @@ typedef struct queue {
     long head;  ///< Points to the item just before the head
     long tail;  ///< Points to the last item inserted
     phit * pos; ///< size = MAX_QUEUE_LEN
+
+    // Occupancy histogram, only when collected (plevel & 8)
+    CLOCK_TYPE * histo;     ///< Histogram of the port owning the queue, NULL if not collected
+    CLOCK_TYPE * samples;   ///< Number of occupancy samples of the router owning the queue
+    CLOCK_TYPE since;       ///< Samples already credited to the histogram
+    long level;             ///< Current occupancy level (in packets)
 } queue;
 
 /**
@@ -35,6 +41,11 @@ void ins_queue (queue *q, phit *i);
 void ins_mult_queue (queue *q, phit *i, long copies);
 void rem_queue (queue *q, phit *i);
 void rem_head_queue (queue *q);
+void ins_packet_queue (queue *q, phit *i, long size);
+void rem_packet_queue (queue *q, phit *i, long size);
+void queue_occupancy_init (queue *q, CLOCK_TYPE *histo, CLOCK_TYPE *samples);
+void queue_occupancy_flush (queue *q);
+void queue_occupancy_reset (queue *q);
 
 // some declarations in queue_inj.c.
 void inj_init_queue (inj_queue *q);
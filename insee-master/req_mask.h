@@ -0,0 +1,128 @@
+/**
+* @file
+* @brief	Bitmasks of the input ports requesting an output port.
+*
+* Every output port keeps one bit per input port (multiword when there are more than 64
+* ports), so the arbiters can find requesters with find-first-set / popcount instead of
+* visiting every input, and all the requests of a router can be cleared word-wide.
+*
+* FSIN Functional Simulator of Interconnection Networks
+* Copyright (2003-2011) J. Miguel-Alonso, A. Gonzalez, J. Navaridas
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef _req_mask
+#define _req_mask
+
+#include <stdint.h>
+
+#define REQ_WORD_BITS 64	///< Bits in every word of a request mask.
+
+/**
+* Number of words needed to store a request mask of n ports.
+*/
+#define req_mask_words(n) (((n) + REQ_WORD_BITS - 1) / REQ_WORD_BITS)
+
+/**
+* Annotates that port p is requesting.
+*/
+static inline void req_mask_set(uint64_t *m, long p) {
+	m[p / REQ_WORD_BITS] |= 1ULL << (p % REQ_WORD_BITS);
+}
+
+/**
+* Annotates that port p is not requesting any more.
+*/
+static inline void req_mask_clear(uint64_t *m, long p) {
+	m[p / REQ_WORD_BITS] &= ~(1ULL << (p % REQ_WORD_BITS));
+}
+
+/**
+* Is port p requesting?
+*/
+static inline int req_mask_test(const uint64_t *m, long p) {
+	return (m[p / REQ_WORD_BITS] >> (p % REQ_WORD_BITS)) & 1;
+}
+
+/**
+* Word w of the mask, keeping only the bits in the range [first, last).
+*/
+static inline uint64_t req_mask_range_word(const uint64_t *m, long w, long first, long last) {
+	uint64_t bits = m[w];
+	long base = w * REQ_WORD_BITS;
+
+	if (first > base)
+		bits &= ~0ULL << (first - base);
+	if (last < base + REQ_WORD_BITS)
+		bits &= ~(~0ULL << (last - base));
+	return bits;
+}
+
+/**
+* First requesting port in the range [first, last).
+*
+* @return The port, or -1 if there are no requests in the range.
+*/
+static inline long req_mask_next(const uint64_t *m, long first, long last) {
+	long w;
+	uint64_t bits;
+
+	if (first >= last)
+		return -1;
+	for (w = first / REQ_WORD_BITS; w * REQ_WORD_BITS < last; w++) {
+		bits = req_mask_range_word(m, w, first, last);
+		if (bits)
+			return (w * REQ_WORD_BITS) + __builtin_ctzll(bits);
+	}
+	return -1;
+}
+
+/**
+* Number of requesting ports in the range [first, last).
+*/
+static inline long req_mask_count(const uint64_t *m, long first, long last) {
+	long w, n = 0;
+
+	if (first >= last)
+		return 0;
+	for (w = first / REQ_WORD_BITS; w * REQ_WORD_BITS < last; w++)
+		n += __builtin_popcountll(req_mask_range_word(m, w, first, last));
+	return n;
+}
+
+/**
+* The k-th (starting at 0) requesting port in the range [first, last).
+*
+* @return The port, or -1 if there are not so many requests in the range.
+*/
+static inline long req_mask_select(const uint64_t *m, long first, long last, long k) {
+	long w, n;
+	uint64_t bits;
+
+	if (first >= last)
+		return -1;
+	for (w = first / REQ_WORD_BITS; w * REQ_WORD_BITS < last; w++) {
+		bits = req_mask_range_word(m, w, first, last);
+		n = __builtin_popcountll(bits);
+		if (k < n) {
+			while (k--)
+				bits &= bits - 1;	// drop the lowest requester
+			return (w * REQ_WORD_BITS) + __builtin_ctzll(bits);
+		}
+		k -= n;
+	}
+	return -1;
+}
+
+#endif /* _req_mask */
@@ -109,7 +109,7 @@ void request_port_double_oblivious(long i, port_type s_p) {
                     return;
                 }
                 else {
-                    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+                    set_request(i, d_p, s_p);
                     return;
                 }
             }
@@ -170,7 +170,7 @@ another_attempt:
                 }
                 else {
                     // Make reservation
-                    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+                    set_request(i, d_p, s_p);
                     return;
                 }
             }
@@ -231,7 +231,7 @@ void request_port_hexa_oblivious(long i, port_type s_p) {
                     return;
                 }
                 else{
-                    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+                    set_request(i, d_p, s_p);
                     return;
                 }
             }
@@ -296,7 +296,7 @@ void request_port_hexa_adaptive(long i, port_type s_p) {
                     if (!check_restrictions(i, s_p, d_p, B_TRUE))
                         d_c = (d_c + 1) % nchan;
                     else{
-                        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+                        set_request(i, d_p, s_p);
                         return;
                     }
                 }
@@ -349,7 +349,7 @@ void request_port_bimodal_random (long i, port_type s_p){
                 extract_packet(i, s_p);
             return;
         }
-        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, d_p, s_p);
     }
     else
         panic("Should not be here in request_port_bimodal_random");
@@ -396,7 +396,7 @@ void request_port_bubble_oblivious (long i, port_type s_p) {
             extract_packet(i, s_p);
         return;
     }
-    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+    set_request(i, d_p, s_p);
 }
 
 /**
@@ -472,7 +472,7 @@ void request_port_bubble_adaptive_smart(long i, port_type s_p) {
             continue;
         }
 
-        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, d_p, s_p);
         if (bt < (ndim-1))
             network[i].p[s_p].bet = bt+1;
         else
@@ -492,7 +492,7 @@ void request_port_bubble_adaptive_smart(long i, port_type s_p) {
                 extract_packet(i, s_p);
             return;
         }
-        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, d_p, s_p);
         // If not successful, next time we will start the round again
         return;
     }
@@ -543,7 +543,7 @@ void request_port_bubble_adaptive_shortest (long i, port_type s_p) {
     }
     if (s_d_p != -1) {
         // Let us make the request
-        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, d_p, s_p);
         return;
     }
 
@@ -556,7 +556,7 @@ void request_port_bubble_adaptive_shortest (long i, port_type s_p) {
             extract_packet(i, s_p);
         return;
     }
-    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+    set_request(i, d_p, s_p);
 }
 
 /**
@@ -606,7 +606,7 @@ void request_port_bubble_adaptive_random (long i, port_type s_p) {
                 extract_packet(i, s_p);
             return;
         }
-        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, d_p, s_p);
         return;
     }
 
@@ -615,7 +615,7 @@ void request_port_bubble_adaptive_random (long i, port_type s_p) {
         if (!candidates[d_p])
             continue;
         if (rp == 0) {
-            network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+            set_request(i, d_p, s_p);
             return;
         }
         else
@@ -686,7 +686,7 @@ void request_port_dally_trc(long i, port_type s_p) {
             extract_packet(i, s_p);
         return;
     }
-    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+    set_request(i, d_p, s_p);
 }
 
 /**
@@ -746,7 +746,7 @@ void request_port_dally_basic (long i, port_type s_p) {
             extract_packet(i, s_p);
         return;
     }
-    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+    set_request(i, d_p, s_p);
 }
 
 /**
@@ -815,7 +815,7 @@ void request_port_dally_improved(long i, port_type s_p) {
             extract_packet(i, s_p);
         return;
     }
-    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+    set_request(i, d_p, s_p);
 }
 
 /**
@@ -870,7 +870,7 @@ void request_port_dally_adaptive (long i, port_type s_p) {
         if (!candidates[d_p])
             continue;
         if (rp == 0) {
-            network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+            set_request(i, d_p, s_p);
             return;
         }
         else
@@ -913,12 +913,12 @@ bool_t preliminary_check(long i, port_type s_p, bool_t fully_check) {
 
     if (fully_check){
         if (check_rr_fully(&pkt_space[ph->packet])) {
-            network[i].p[p_con].req[s_p] = network[i].p[s_p].tor;
+            set_request(i, p_con, s_p);
             return B_FALSE;
         }
     } else
         if (check_rr(&pkt_space[ph->packet], &d_d, &d_w)) {
-            network[i].p[p_con].req[s_p] = network[i].p[s_p].tor;
+            set_request(i, p_con, s_p);
             return B_FALSE;
         }
     return B_TRUE;
@@ -1152,7 +1152,7 @@ bool_t preliminary_check_arbitrary(long i, port_type s_p) {
 
     curr_p=s_p;	//source port :: GLOBAL
     if ( check_rr(&pkt_space[ph->packet], &d_d, &d_w) ){
-        network[i].p[p_con].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, p_con, s_p);
         return B_FALSE;
     }
     return B_TRUE;
@@ -1240,7 +1240,7 @@ void request_port_arbitrary (long i, port_type s_p) {
             extract_packet_arbitrary(i, s_p);
         return;
     }
-    network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+    set_request(i, d_p, s_p);
 }
 
 /**
@@ -1521,7 +1521,7 @@ bool_t preliminary_check_icube(long i, port_type s_p) {
     curr_p=s_p;	//source port.     GLOBAL
 
     if (check_rr(&pkt_space[ph->packet], &d_d, &d_w)) {
-        network[i].p[p_con].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, p_con, s_p);
         return B_FALSE;
     }
     return B_TRUE;
@@ -1757,7 +1757,7 @@ void request_port_icube (long i, port_type s_p) {
     if (!preliminary_check_icube (i, s_p)) return;
     // Won't use array mt -- use d_d and d_w instead
 
-    d_p=d_d;
+    d_p = (d_d == (dim) NULL_PORT) ? NULL_PORT : d_d;	// dim is unsigned
 
     if (d_p == (port_type) NULL_PORT) {
         if (extract && s_p >= p_inj_first)
@@ -1765,7 +1765,7 @@ void request_port_icube (long i, port_type s_p) {
         return;
     }
     else
-        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, d_p, s_p);
 }
 
 /**
@@ -1801,7 +1801,7 @@ bool_t preliminary_check_icube_IB (long i, port_type s_p) {
     curr_p=s_p;	//source port.     GLOBAL
 
     if (check_rr(&pkt_space[ph->packet], &d_d, &d_w)) {
-        network[i].p[p_con].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, p_con, s_p);
         return B_FALSE;
     }
     return B_TRUE;
@@ -1910,7 +1910,7 @@ void request_port_icube_IB (long i, port_type s_p) {
     if (!preliminary_check_icube_IB (i, s_p)) return;
     // Won't use array mt -- use d_d and d_w instead
 
-    d_p=d_d;
+    d_p = (d_d == (dim) NULL_PORT) ? NULL_PORT : d_d;	// dim is unsigned
 
     if (d_p == (port_type) NULL_PORT) {
         if (extract && s_p >= p_inj_first)
@@ -1918,7 +1918,7 @@ void request_port_icube_IB (long i, port_type s_p) {
         return;
     }
     else
-        network[i].p[d_p].req[s_p] = network[i].p[s_p].tor;
+        set_request(i, d_p, s_p);
 }
 
 long get_first_vc(long length){
@@ -0,0 +1,196 @@
+/**
+* @file
+* @brief	Results store writer.
+*
+* When a results store is given (results=<file>), the summary of the run, its batches and its maps
+* and histograms are appended to the store as records (see results.h), instead of being written
+* to a set of text files per run. The store is locked while the run is written, so all the runs of
+* a sweep can share the same store.
+*
+* FSIN Functional Simulator of Interconnection Networks
+* Copyright (2003-2011) J. Miguel-Alonso, A. Gonzalez, J. Navaridas
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <fcntl.h>
+
+#ifndef WIN32
+#include <unistd.h>
+#include <sys/file.h>
+#endif
+
+#include "globals.h"
+#include "results.h"
+
+/**
+* The results store, or an empty string to write the usual output files.
+*/
+char results_file[256];
+
+static FILE *store = NULL;			///< Results store being written.
+static long run;					///< Id of the run being written.
+static long record_start;			///< Offset of the record being written.
+static results_record_t record;		///< Header of the record being written.
+
+static char *row = NULL;			///< Key-value pairs of the row being built.
+static long row_len, row_size, row_cols;
+
+/**
+* Writes an integer as a zigzag variable-length integer.
+*/
+static void put_varint(long x) {
+	unsigned long u = ((unsigned long)x << 1) ^ (unsigned long)(x >> (8 * sizeof(long) - 1));
+
+	while (u >= 0x80) {
+		putc((u & 0x7f) | 0x80, store);
+		u >>= 7;
+	}
+	putc(u, store);
+}
+
+/**
+* Writes the header of a record. The size of the payload is filled in by end_record().
+*/
+static void start_record(results_type_t type, char *name, long rows, long cols) {
+	memset(&record, 0, sizeof(record));
+	memcpy(record.magic, RESULTS_MAGIC, 4);
+	record.type = type;
+	record.run = run;
+	strncpy(record.name, name, RESULTS_NAME_LEN - 1);
+	record.rows = rows;
+	record.cols = cols;
+	record_start = ftell(store);
+	fwrite(&record, sizeof(record), 1, store);
+}
+
+static void end_record(void) {
+	long end = ftell(store);
+
+	record.size = end - record_start - sizeof(record);
+	fseek(store, record_start, SEEK_SET);
+	fwrite(&record, sizeof(record), 1, store);
+	fseek(store, end, SEEK_SET);
+}
+
+/**
+* Opens (or creates) the results store and locks it until results_close().
+*/
+void results_open(void) {
+	int fd;
+
+	if ((fd = open(results_file, O_RDWR | O_CREAT, 0644)) == -1)
+		panic("Unable to open the results store");
+#ifndef WIN32
+	if (flock(fd, LOCK_EX) == -1)
+		panic("Unable to lock the results store");
+#endif
+	store = fdopen(fd, "r+");
+	fseek(store, 0, SEEK_END);
+	run = ftell(store);
+	row_len = row_cols = 0;
+}
+
+/**
+* Adds a key-value pair to the row of the run.
+*/
+void results_add(char *key, char *format, ...) {
+	char value[256];
+	long kl, vl;
+	va_list arg;
+
+	va_start(arg, format);
+	vsnprintf(value, sizeof(value), format, arg);
+	va_end(arg);
+
+	kl = strlen(key) + 1;
+	vl = strlen(value) + 1;
+	if (row_len + kl + vl > row_size) {
+		row_size = 2 * (row_len + kl + vl);
+		row = realloc(row, row_size);
+	}
+	memcpy(row + row_len, key, kl);
+	memcpy(row + row_len + kl, value, vl);
+	row_len += kl + vl;
+	row_cols++;
+}
+
+/**
+* Stores the row of the run, built with results_add().
+*/
+void results_row(char *name) {
+	start_record(RESULTS_ROW, name, row_cols, 0);
+	fwrite(row, 1, row_len, store);
+	end_record();
+	row_len = row_cols = 0;
+}
+
+/**
+* Stores a vector of integers, e.g. a histogram. Trailing zeros are not stored.
+*/
+void results_vector(char *name, long *v, long n) {
+	long i;
+
+	while (n > 0 && v[n - 1] == 0)
+		n--;
+	start_record(RESULTS_VECTOR, name, 1, n);
+	for (i = 0; i < n; i++)
+		put_varint(v[i]);
+	end_record();
+}
+
+/**
+* Starts a matrix of integers, whose rows are given by results_matrix_row().
+*/
+void results_matrix_start(char *name, long rows, long cols) {
+	start_record(RESULTS_MATRIX, name, rows, cols);
+}
+
+/**
+* Stores a row of the current matrix as (repetitions, value) pairs.
+*/
+void results_matrix_row(long *v) {
+	long i = 0, j;
+
+	while (i < record.cols) {
+		for (j = i + 1; j < record.cols && v[j] == v[i]; j++);
+		put_varint(j - i);
+		put_varint(v[i]);
+		i = j;
+	}
+}
+
+void results_matrix_end(void) {
+	end_record();
+}
+
+/**
+* Stores a matrix of doubles, row by row.
+*/
+void results_real_matrix(char *name, double *m, long rows, long cols) {
+	start_record(RESULTS_REAL_MATRIX, name, rows, cols);
+	fwrite(m, sizeof(double), rows * cols, store);
+	end_record();
+}
+
+/**
+* Finishes the run and releases the results store.
+*/
+void results_close(void) {
+	if (fclose(store) != 0)
+		panic("Unable to write the results store");
+	store = NULL;
+}
@@ -0,0 +1,55 @@
+/**
+* @file
+* @brief	Format of the results store.
+*
+* The results store is a single append-only file collecting the results of many runs: a sequence
+* of records, each one a results_record_t header followed by its payload. The records written by a
+* run share the same run id (the offset of its first record). This is the same format written by
+* INRFlow, so the stores of both simulators can be read with inrflow-master/tools/results_dump.c.
+*
+* Integers are written as zigzag variable-length integers (7 bits per byte, lowest first), and
+* every row of a matrix is run-length encoded as (repetitions, value) pairs.
+*
+* FSIN Functional Simulator of Interconnection Networks
+* Copyright (2003-2011) J. Miguel-Alonso, A. Gonzalez, J. Navaridas
+*
+* This program is free software; you can redistribute it and/or
+* modify it under the terms of the GNU General Public License
+* as published by the Free Software Foundation; either version 2
+* of the License, or (at your option) any later version.
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+* You should have received a copy of the GNU General Public License
+* along with this program; if not, write to the Free Software
+* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#ifndef _results
+#define _results
+
+#define RESULTS_MAGIC "RST1"	///< First bytes of every record (also the format version).
+#define RESULTS_NAME_LEN 24
+
+/**
+* Types of record.
+*/
+typedef enum results_type_t {
+	RESULTS_ROW = 1,		///< Key-value pairs of a run: rows columns of "key\0value\0".
+	RESULTS_VECTOR,			///< cols integers (e.g. a histogram), without trailing zeros.
+	RESULTS_MATRIX,			///< rows x cols integers, every row run-length encoded.
+	RESULTS_REAL_MATRIX		///< rows x cols doubles, as stored in memory.
+} results_type_t;
+
+typedef struct results_record_t {
+	char magic[4];
+	int type;		///< results_type_t
+	long run;		///< Offset of the first record of the run.
+	char name[RESULTS_NAME_LEN];
+	long rows;
+	long cols;
+	long size;		///< Bytes of payload following the header.
+} results_record_t;
+
+#endif /* _results */
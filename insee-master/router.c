@@ -56,8 +56,10 @@ void router_init(void) {
 		}
 
 		network[i].p = alloc(sizeof(port) * (n_ports+1));
+		network[i].req_masks = alloc(sizeof(uint64_t) * req_words * (n_ports+1));
 		for(j = 0; j < n_ports+1; ++j) {
 			network[i].p[j].req = alloc(sizeof(CLOCK_TYPE) * n_ports+1);
+			network[i].p[j].req_mask = network[i].req_masks + (j * req_words);
 			network[i].p[j].histo = alloc(sizeof(CLOCK_TYPE) * (buffer_cap + 1));
 			network[i].p[j].faulty = 0;
 		}
@@ -159,6 +161,7 @@ void init_ports(long i){
 	port_type e;
 	long f;
 
+	network[i].samples = (CLOCK_TYPE) 0L;
 	for (e=0; e<p_con; e++) {
 		init_queue(&network[i].p[e].q);
 		network[i].p[e].utilization = (CLOCK_TYPE) 0L;
@@ -169,13 +172,17 @@ void init_ports(long i){
 		network[i].p[e].sip = P_NULL;
 		network[i].p[e].ri = P_NULL;
 
-		if(plevel & 8)
+		if(plevel & 8) {
 			for (f=0; f<buffer_cap+1; f++)
 				network[i].p[e].histo[f] = (CLOCK_TYPE) 0L;
+			queue_occupancy_init(&network[i].p[e].q, network[i].p[e].histo, &network[i].samples);
+		}
 	}
 	/* Init consumption port */
+	init_queue(&network[i].p[p_con].q);
 	network[i].p[p_con].sip = P_NULL;
 	network[i].p[p_con].ri = P_NULL;
+	clear_requests(i);
 	/* Number of pending packets */
 	network[i].pending_packet = 0;
 }
@@ -328,6 +335,7 @@ void router_finish(){
                     free(network[i].p[j].q.pos);
 		}
                 free(network[i].p);
+                free(network[i].req_masks);
 
                 free(network[i].op_i);
                 free(network[i].nbor);
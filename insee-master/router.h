@@ -7,6 +7,9 @@
 
 #include "globals.h"
 #include "cam.h"
+#include "req_mask.h"
+
+#include <string.h>
 
 /**
 * Calculates the port asigned to a direction pair (dimension, way ).
@@ -29,6 +32,22 @@
 */
 #define address(cx,cy,cz) (cx + cy*nodes_x + cz*nodes_x*nodes_y)
 
+/**
+* Input port s_p of node i requests output port d_p. Annotates the time of the request and sets
+* the bit of s_p in the request mask of d_p. As a time of 0 used to mean no request, a request
+* made at cycle 0 is not annotated in the mask (the clock starts at 1 for this reason).
+*/
+#define set_request(i,d_p,s_p) do { \
+	network[i].p[d_p].req[s_p] = network[i].p[s_p].tor; \
+	if (network[i].p[s_p].tor) \
+		req_mask_set(network[i].p[d_p].req_mask, s_p); \
+} while (0)
+
+/**
+* Removes all the requests of node i.
+*/
+#define clear_requests(i) memset(network[i].req_masks, 0, sizeof(uint64_t) * req_words * (n_ports+1))
+
 #define ESCAPE 0	///< The Escape VC is always #0
 #define NULL_PORT -1	///< A way to denote "no port"
 #define NULL_PACKET 0xffffffff	///< A way to denote "no packet"
@@ -99,7 +118,8 @@ typedef struct port {
 	CLOCK_TYPE tor;		///< Time of last request for output
 
 	// Output section
-	CLOCK_TYPE *req;		///< Table of requests
+	CLOCK_TYPE *req;		///< Table of requests (time of request), only valid if the bit in req_mask is set
+	uint64_t *req_mask;		///< Bitmask of the input ports requesting this output port
 	port_type ri;	///< Last request attended
 	port_type sip;	///< Input port using this output port
 
@@ -121,6 +141,8 @@ typedef struct router {
 
 	// Ports
 	port * p;		///< All the node's ports
+	CLOCK_TYPE samples;	///< Number of times the occupancy of the ports has been sampled
+	uint64_t * req_masks;	///< Request masks of all the ports, contiguous so they are cleared at once
 	long * op_i;	///< Indices to assign output port
 
 	// Injection
@@ -6,6 +6,7 @@ spanning_tree_routing_table_t *s_t_routing_table;
 void create_spanning_trees(long n, long nservers){
 
     long i, rnd_node;
+    long n_switches = NUMNODES - nprocs;
 
     s_t_routing_table = alloc(sizeof(spanning_tree_routing_table_t));
     s_t_routing_table->s_t_route = alloc(n * sizeof(s_t_route_t));
@@ -13,12 +14,18 @@ void create_spanning_trees(long n, long nservers){
     s_t_routing_table->l_used = 0;
     s_t_routing_table->n_servers = nservers;
 
+    s_t_routing_table->log_2 = alloc(2 * n_switches * sizeof(long));
+    s_t_routing_table->log_2[1] = 0;
+    for(i = 2; i < 2 * n_switches; i++)
+        s_t_routing_table->log_2[i] = s_t_routing_table->log_2[i / 2] + 1;
+
     for(i = 0; i < n; i++) {
         s_t_routing_table->s_t_route[i].path = alloc((NUMNODES - nprocs) * sizeof(long));
         s_t_routing_table->s_t_route[i].link = alloc((NUMNODES - nprocs) * sizeof(long));
         s_t_routing_table->s_t_route[i].link_r = alloc((NUMNODES - nprocs) * sizeof(long));
         rnd_node = rand() % (NUMNODES - nprocs);
         calc_spanning_tree(rnd_node, i, nservers);
+        calc_spanning_tree_lca(&s_t_routing_table->s_t_route[i]);
     }
 }
 
@@ -32,27 +39,44 @@ void destroy_spanning_trees(){
         free(s_t_routing_table->s_t_route[i].path);
         free(s_t_routing_table->s_t_route[i].link);
         free(s_t_routing_table->s_t_route[i].link_r);
+        free(s_t_routing_table->s_t_route[i].depth);
+        free(s_t_routing_table->s_t_route[i].first);
+        free(s_t_routing_table->s_t_route[i].lca);
     }
+    free(s_t_routing_table->log_2);
     free(s_t_routing_table->s_t_route);
     free(s_t_routing_table);
 }
 
-
+/**
+ * Routing record of a packet through a random spanning tree: the tree, a 0, the ports up to the
+ * lowest common ancestor of both switches and down from it, and the server port at the destination.
+ * The record is as long as the path, which comes from the tree tables without searching it.
+ */
 routing_r spanning_tree_rr(long source, long destination){
 
     long path_length = 0;
-    long start_switch, end_switch;
-    long length = NUMNODES - nprocs;
+    long start_switch, end_switch, tree, lca = 0;
+    s_t_route_t *s_t_route;
     routing_r res;
 
-    res.rr = alloc(length * sizeof(long));
     start_switch = source / s_t_routing_table->n_servers;
     end_switch = destination / s_t_routing_table->n_servers;
 
-    res.rr[0] = rand() % s_t_routing_table->n;
-    if(start_switch != end_switch)
-        path_length = calc_spanning_tree_rr(res.rr, start_switch, end_switch, &s_t_routing_table->s_t_route[res.rr[0]]);
+    tree = rand() % s_t_routing_table->n;
+    s_t_route = &s_t_routing_table->s_t_route[tree];
+    if(s_t_route->depth[start_switch] == -1 || s_t_route->depth[end_switch] == -1)
+        panic("spanning_tree_rr: switch not reached by the spanning tree");
+    if(start_switch != end_switch){
+        lca = spanning_tree_lca(start_switch, end_switch, s_t_route);
+        path_length = s_t_route->depth[start_switch] + s_t_route->depth[end_switch] - 2 * s_t_route->depth[lca];
+    }
+
+    res.rr = alloc((path_length + 3) * sizeof(long));
+    res.rr[0] = tree;
     res.rr[1] = 0;
+    if(path_length > 0)
+        calc_spanning_tree_rr(res.rr, start_switch, end_switch, lca, s_t_route);
     res.rr[path_length + 2] = destination % s_t_routing_table->n_servers;
     res.size = path_length + 3;
 
@@ -110,83 +134,119 @@ void calc_spanning_tree(long switch_src, long s_t_n, long n_servers){
     free(processed);    
 }
 
-long calc_spanning_tree_rr(long *rr, long start, long end, s_t_route_t *s_t_route){     
-
-    long i, j;
-    long length = NUMNODES - nprocs;
-    long done_src = 0;                                                              
-    long done_dst = 0;                                                              
-    long length_src = 1;                                                   
-    long length_dst = 1;                                                   
-    long *src_aux = alloc(length * sizeof(long)); 
-    long *dst_aux = alloc(length * sizeof(long)); 
-    long *src_aux_b = alloc(length * sizeof(long)); 
-    long *dst_aux_b = alloc(length * sizeof(long)); 
-
-
-    for(i = 0; i < length; i++){
-        src_aux[i] = -1;
-        dst_aux[i] = -1;
-        src_aux_b[i] = -1;
-        dst_aux_b[i] = -1;
-    }
+/**
+ * Prepares a spanning tree for path queries: the depth of every switch, an Euler tour of the tree
+ * (every switch, again after each of its subtrees) and a sparse table of the shallowest switch of
+ * every power of two long stretch of the tour, so the lowest common ancestor of any two switches
+ * is the shallowest of two overlapping stretches.
+ */
+void calc_spanning_tree_lca(s_t_route_t *s_t_route){
 
-    src_aux[0] = start;
-    src_aux_b[start] = 0;
-    if(s_t_route->path[start] == -1){
-        done_src = 1;
+    long i, k, v, c, a, b, top, reached, tour, *euler;
+    long n_switches = NUMNODES - nprocs;
+    long *start = alloc((n_switches + 1) * sizeof(long));
+    long *children = alloc(n_switches * sizeof(long));
+    long *next = alloc(n_switches * sizeof(long));
+    long *stack = alloc(n_switches * sizeof(long));
+
+    s_t_route->depth = alloc(n_switches * sizeof(long));
+    s_t_route->first = alloc(n_switches * sizeof(long));
+
+    // Children of every switch, in the order of the switches
+    for(i = 0; i <= n_switches; i++)
+        start[i] = 0;
+    reached = 1;
+    for(v = 0; v < n_switches; v++) {
+        s_t_route->depth[v] = -1;
+        s_t_route->first[v] = -1;
+        if(s_t_route->path[v] != -1) {
+            start[s_t_route->path[v] + 1]++;
+            reached++;
+        }
     }
-    dst_aux[0] = end;
-    dst_aux_b[end] = 0;
-    if(s_t_route->path[end] == -1){
-        done_dst = 1;
+    for(i = 0; i < n_switches; i++)
+        start[i + 1] += start[i];
+    for(v = 0; v < n_switches; v++)
+        next[v] = start[v];
+    for(v = 0; v < n_switches; v++) {
+        if(s_t_route->path[v] != -1)
+            children[next[s_t_route->path[v]]++] = v;
     }
 
+    // Euler tour, from the root, into the first level of the sparse table
+    s_t_route->tour = 2 * reached - 1;
+    tour = s_t_route->tour;
+    s_t_route->lca = alloc((s_t_routing_table->log_2[tour] + 1) * tour * sizeof(long));
+    euler = s_t_route->lca;
+    v = s_t_route->root;
+    s_t_route->depth[v] = 0;
+    s_t_route->first[v] = 0;
+    euler[0] = v;
+    next[v] = start[v];
+    stack[0] = v;
+    top = 0;
     i = 1;
+    while(top >= 0) {
+        v = stack[top];
+        if(next[v] < start[v + 1]) {
+            c = children[next[v]++];
+            s_t_route->depth[c] = s_t_route->depth[v] + 1;
+            s_t_route->first[c] = i;
+            euler[i++] = c;
+            next[c] = start[c];
+            stack[++top] = c;
+        } else if(--top >= 0)
+            euler[i++] = stack[top];
+    }
 
-    while(!done_src || !done_dst){                                                           
-        if(!done_src){
-            src_aux[i] = s_t_route->path[src_aux[i -1]];
-            src_aux_b[src_aux[i]] = i;
-            length_src++;
-            if(s_t_route->path[src_aux[i]] == -1){                                               
-                done_src = 1;                                                       
-            }                                                                   
-        }                 
-        if(!done_dst){
-            dst_aux[i] = s_t_route->path[dst_aux[i -1]];
-            dst_aux_b[dst_aux[i]] = i;
-            length_dst++;
-            if(s_t_route->path[dst_aux[i]] == -1){                                               
-                done_dst = 1;                                                       
-            }                                                                   
-        } 
-        i++;
-    }            
-
-    i = 0;
-    while(i < length_src){
-        if(dst_aux_b[src_aux[i]] != -1){
-            break;
+    // Every level k keeps the shallowest switch of the two halves of every stretch of 2^k
+    for(k = 1; (1 << k) <= tour; k++) {
+        for(i = 0; i + (1 << k) <= tour; i++) {
+            a = s_t_route->lca[(k - 1) * tour + i];
+            b = s_t_route->lca[(k - 1) * tour + i + (1 << (k - 1))];
+            s_t_route->lca[k * tour + i] = (s_t_route->depth[a] <= s_t_route->depth[b]) ? a : b;
         }
-        rr[i + 2] = s_t_route->link_r[src_aux[i]];
-        i++;
     }
 
-    j = dst_aux_b[src_aux[i]] - 1;
+    free(start);
+    free(children);
+    free(next);
+    free(stack);
+}
+
+/**
+ * Lowest common ancestor of the switches a and b in a spanning tree, in constant time.
+ */
+long spanning_tree_lca(long a, long b, s_t_route_t *s_t_route){
 
-    while(j >= 0){
-        rr[i + 2] = s_t_route->link[dst_aux[j]];
-        i++;
-        j--;
+    long i, j, k, x, y;
+
+    i = s_t_route->first[a];
+    j = s_t_route->first[b];
+    if(i > j) {
+        k = i;
+        i = j;
+        j = k;
     }
+    k = s_t_routing_table->log_2[j - i + 1];
+    x = s_t_route->lca[k * s_t_route->tour + i];
+    y = s_t_route->lca[k * s_t_route->tour + j - (1 << k) + 1];
 
-    free(src_aux);
-    free(src_aux_b);
-    free(dst_aux);
-    free(dst_aux_b);
+    return((s_t_route->depth[x] <= s_t_route->depth[y]) ? x : y);
+}
 
-    return(i);
-}  
+/**
+ * Writes, from rr[2], the ports from start up to their lowest common ancestor lca, and from it down
+ * to end. The ports down are written backwards, walking up from end.
+ */
+void calc_spanning_tree_rr(long *rr, long start, long end, long lca, s_t_route_t *s_t_route){
 
+    long i, v;
+    long up = s_t_route->depth[start] - s_t_route->depth[lca];
+    long down = s_t_route->depth[end] - s_t_route->depth[lca];
 
+    for(i = 0, v = start; i < up; i++, v = s_t_route->path[v])
+        rr[i + 2] = s_t_route->link_r[v];
+    for(i = up + down - 1, v = end; i >= up; i--, v = s_t_route->path[v])
+        rr[i + 2] = s_t_route->link[v];
+}
@@ -6,9 +6,13 @@
 typedef struct s_t_route_t{
     
     long root;
-    long *path;
-    long *link;
-    long *link_r;
+    long *path;		///< Parent of every switch in the tree, -1 for the root.
+    long *link;		///< Port of the parent towards every switch.
+    long *link_r;	///< Port of every switch towards its parent.
+    long *depth;	///< Hops from the root to every switch, -1 if the tree does not reach it.
+    long *first;	///< First position of every switch in the Euler tour.
+    long *lca;		///< Sparse table of the Euler tour: level k holds the shallowest switch of every 2^k positions.
+    long tour;		///< Length of the Euler tour.
 
 } s_t_route_t;
 
@@ -17,6 +21,7 @@ typedef struct spanning_tree_routing_table_t{
         long n;
         long n_servers;
         long l_used;
+        long *log_2;		///< Floor of the base 2 logarithm of every Euler tour length.
         s_t_route_t *s_t_route;
 
 } spanning_tree_routing_table_t;
@@ -27,5 +32,9 @@ void destroy_spanning_trees();
 
 void calc_spanning_tree(long switch_src, long s_t_n, long n_servers);
 
-long calc_spanning_tree_rr(long *rr, long start, long end, s_t_route_t *s_t_route); 
+void calc_spanning_tree_lca(s_t_route_t *s_t_route);
+
+long spanning_tree_lca(long a, long b, s_t_route_t *s_t_route);
+
+void calc_spanning_tree_rr(long *rr, long start, long end, long lca, s_t_route_t *s_t_route);
 #endif
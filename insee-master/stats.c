@@ -23,28 +23,27 @@ Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
 /**
 * Collects queue occupancy histogram stats.
 *
+* Only the samples are counted here: every queue credits them to the histogram bucket of its
+* occupancy level when the level changes (see queue.c), so idle queues cost nothing.
+*
 * @param i The node to collect from.
 */
 void stats(long i) {
-	long ql_p, ql_m;
+	network[i].samples++;
+}
+
+/**
+* Brings the queue occupancy histograms up to date.
+*
+* Credits the samples pending in every queue, so the histograms can be read.
+*/
+void flush_histograms(void) {
 	port_type e;
-	port *pt;
-	phit *p;
-
-	for (e=0; e<n_ports; e++) {
-		pt = &(network[i].p[e]);
-		ql_p = queue_len(&(pt->q));
-		ql_m = ql_p/pkt_len;
-
-		if (ql_p) {
-			p = head_queue(&(pt->q));
-			if ((p->pclass != RR) && (p->pclass != RR_TAIL))
-				ql_m++;
-		}
-		if (ql_m > buffer_cap + 1)
-			panic("Too many packets");
-		pt->histo[ql_m]++;
-	}
+	long i;
+
+	for (i=0; i<NUMNODES; i++)
+		for (e=0; e<n_ports; e++)
+			queue_occupancy_flush(&network[i].p[e].q);
 }
 
 /**
@@ -54,7 +53,10 @@ void stats(long i) {
 */
 void reset_stats(void) {
 	port_type e;
-	long i, j;
+	long i;
+#if (EXECUTION_DRIVEN != 0)
+	long j;
+#endif /* EXECUTION_DRIVEN */
 #if (BIMODAL_SUPPORT != 0)
 	message_l k;
 #endif /* BIMODAL */
@@ -90,8 +92,7 @@ void reset_stats(void) {
 
 			if(plevel & 8)
 				for (e=0; e<n_ports; e++)
-					for (j=0; j<buffer_cap+1; j++)
-						network[i].p[e].histo[j] = (CLOCK_TYPE) 0L;
+					queue_occupancy_reset(&network[i].p[e].q);
 		}
 #if (BIMODAL_SUPPORT != 0)
 		for (k=SHORT_MSG; k<=LONG_LAST_MSG; k++){
@@ -126,8 +127,7 @@ void reset_stats(void) {
 			network[i].p[e].utilization = (CLOCK_TYPE) 0L;
 		if(plevel & 8)
 			for (e=0; e<n_ports; e++)
-				for (j=0; j<buffer_cap+1; j++)
-					network[i].p[e].histo[j] = (CLOCK_TYPE) 0L;
+				queue_occupancy_reset(&network[i].p[e].q);
 	}
 #endif
 	reseted++;
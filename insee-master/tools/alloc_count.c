@@ -0,0 +1,49 @@
+/**
+* Allocation counter for the benchmark suite (see tools/bench.sh).
+*
+* Linked into the simulator with -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, so every call to
+* malloc(), calloc() and realloc() made by the simulator is counted. At exit, the number of
+* allocations and the peak resident set size are written to the file given in $BENCH_STATS.
+*
+* Compile: gcc -O2 -c alloc_count.c
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <sys/resource.h>
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+
+static unsigned long allocs = 0;	///< Calls to malloc(), calloc() and realloc().
+
+void *__wrap_malloc(size_t size) {
+	allocs++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+	allocs++;
+	return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+	allocs++;
+	return __real_realloc(p, size);
+}
+
+/**
+* Writes the allocations and the peak RSS (in KB) of the run, also when it ends with exit().
+*/
+__attribute__((destructor)) static void write_stats(void) {
+	struct rusage usage;
+	char *file = getenv("BENCH_STATS");
+	FILE *fd;
+
+	if (file == NULL || (fd = fopen(file, "w")) == NULL)
+		return;
+	getrusage(RUSAGE_SELF, &usage);
+	fprintf(fd, "allocs %lu\nrss.kb %ld\n", allocs, usage.ru_maxrss);
+	fclose(fd);
+}
@@ -0,0 +1,242 @@
+/** @mainpage
+ *  Microbenchmark of the per-cycle work of an INSEE switch: clearing the request table,
+ *  posting the requests and arbitrating every output port. The table of request times
+ *  with the linear round-robin and random selectors is compared with the request
+ *  bitmasks (req_mask.h) used by arbitrate.c. Both versions are run on the same requests
+ *  and random draws, and their selections are checked to be identical. Every output arbitrates
+ *  the whole switch and also ranges not starting at port 0, as the injection ports and the
+ *  in-transit priority restriction do, since round-robin visits those with a stride.
+ *
+ *  Compile: gcc -O2 -o arb_bench arb_bench.c
+ *  Usage:   ./arb_bench [radix] [vcs] [load] [cycles] [seed]   (defaults: 64 4 0.5 20000 1)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../req_mask.h"
+
+#define NULL_PORT -1
+
+long n_ports;	///< Input/output ports of the switch (radix * vcs)
+long words;		///< Words of every request mask
+long cycles;
+long range_first, range_last;	///< Range of input ports arbitrated
+
+long *target;	///< Output requested by every input in every cycle, or NULL_PORT
+double *dice;	///< Random draw of every output in every cycle (random arbitration)
+long *sel_table, *sel_mask;	///< Selections of every output in every cycle
+
+/**
+ * Wall clock in seconds.
+ */
+static double now() {
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/**
+ * Linear round-robin over a table of request times (as done before the request masks).
+ */
+static long rr_table(long long *req, long ri, long first, long last) {
+	long s_p, visited;
+	long dif = last - first;
+
+	s_p = first + ((ri + 1) % dif);
+	if (s_p >= last) s_p = first;
+	for (visited = first; visited < last; visited++) {
+		if (req[s_p])
+			return s_p;
+		s_p = first + ((s_p + 1) % dif);
+		if (s_p >= last) s_p = first;
+	}
+	return NULL_PORT;
+}
+
+/**
+ * Linear random selection over a table of request times (as done before the request masks).
+ */
+static long random_table(long long *req, double u, long first, long last) {
+	long s_p, rp, ncand = 0;
+
+	for (s_p = first; s_p < last; s_p++)
+		if (req[s_p])
+			ncand++;
+	rp = (long)(ncand * u);
+	for (s_p = first; s_p < last; s_p++) {
+		if (!req[s_p]) continue;
+		if (rp-- == 0)
+			return s_p;
+	}
+	return NULL_PORT;
+}
+
+/**
+ * Round-robin using find-first-set over the rotated request mask (as arbitrate.c does).
+ */
+static long rr_mask(uint64_t *m, long ri, long first, long last) {
+	long s_p, start, visited;
+	long dif = last - first;
+
+	start = first + ((ri + 1) % dif);
+	if (start >= last) start = first;
+	if (first % dif == 0) {
+		if ((s_p = req_mask_next(m, start, last)) == -1)
+			s_p = req_mask_next(m, first, start);
+		return s_p;
+	}
+	// Ranges not starting at a multiple of their length are visited with a stride of first+1
+	if (!req_mask_count(m, first, last))
+		return NULL_PORT;
+	s_p = start;
+	for (visited = first; visited < last; visited++) {
+		if (req_mask_test(m, s_p))
+			return s_p;
+		s_p = first + ((s_p + 1) % dif);
+		if (s_p >= last) s_p = first;
+	}
+	return NULL_PORT;
+}
+
+/**
+ * Random selection using popcount and select over the request mask.
+ */
+static long random_mask(uint64_t *m, double u, long first, long last) {
+	return req_mask_select(m, first, last, (long)(req_mask_count(m, first, last) * u));
+}
+
+/**
+ * Runs all the cycles with the table of request times.
+ *
+ * @return The elapsed time in seconds.
+ */
+static double run_table(long random) {
+	long long *req = malloc(sizeof(long long) * n_ports * n_ports);
+	long *ri = malloc(sizeof(long) * n_ports);
+	long c, s, d;
+	double t;
+
+	for (d = 0; d < n_ports; d++)
+		ri[d] = NULL_PORT;
+	t = now();
+	for (c = 0; c < cycles; c++) {
+		for (d = 0; d < n_ports; d++)
+			for (s = 0; s < n_ports; s++)
+				req[(d * n_ports) + s] = 0;
+		for (s = 0; s < n_ports; s++)
+			if (target[(c * n_ports) + s] != NULL_PORT)
+				req[(target[(c * n_ports) + s] * n_ports) + s] = c + 1;
+		for (d = 0; d < n_ports; d++) {
+			if (random)
+				s = random_table(req + (d * n_ports), dice[(c * n_ports) + d], range_first, range_last);
+			else
+				s = rr_table(req + (d * n_ports), ri[d], range_first, range_last);
+			if (s != NULL_PORT)
+				ri[d] = s;
+			sel_table[(c * n_ports) + d] = s;
+		}
+	}
+	t = now() - t;
+	free(req);
+	free(ri);
+	return t;
+}
+
+/**
+ * Runs all the cycles with the request masks.
+ *
+ * @return The elapsed time in seconds.
+ */
+static double run_mask(long random) {
+	uint64_t *masks = malloc(sizeof(uint64_t) * n_ports * words);
+	long *ri = malloc(sizeof(long) * n_ports);
+	long c, s, d;
+	double t;
+
+	for (d = 0; d < n_ports; d++)
+		ri[d] = NULL_PORT;
+	t = now();
+	for (c = 0; c < cycles; c++) {
+		memset(masks, 0, sizeof(uint64_t) * n_ports * words);
+		for (s = 0; s < n_ports; s++)
+			if (target[(c * n_ports) + s] != NULL_PORT)
+				req_mask_set(masks + (target[(c * n_ports) + s] * words), s);
+		for (d = 0; d < n_ports; d++) {
+			if (random)
+				s = random_mask(masks + (d * words), dice[(c * n_ports) + d], range_first, range_last);
+			else
+				s = rr_mask(masks + (d * words), ri[d], range_first, range_last);
+			if (s != NULL_PORT)
+				ri[d] = s;
+			sel_mask[(c * n_ports) + d] = s;
+		}
+	}
+	t = now() - t;
+	free(masks);
+	free(ri);
+	return t;
+}
+
+int main(int argc, char *argv[]) {
+	long radix = 64, vcs = 4, seed = 1, random;
+	double load = 0.5, tt, tm;
+	long i, r, failed = 0;
+	long ranges[4][2];
+
+	cycles = 20000;
+	if (argc > 1) radix = atol(argv[1]);
+	if (argc > 2) vcs = atol(argv[2]);
+	if (argc > 3) load = atof(argv[3]);
+	if (argc > 4) cycles = atol(argv[4]);
+	if (argc > 5) seed = atol(argv[5]);
+	if (radix < 1 || vcs < 1 || cycles < 1) {
+		printf("Usage: %s [radix] [vcs] [load] [cycles] [seed]\n", argv[0]);
+		exit(-1);
+	}
+
+	n_ports = radix * vcs;
+	// The whole switch, a small range as the injection ports, and the ports but the first VC or one
+	ranges[0][0] = 0;		ranges[0][1] = n_ports;
+	ranges[1][0] = 3;		ranges[1][1] = 8;
+	ranges[2][0] = vcs;		ranges[2][1] = n_ports;
+	ranges[3][0] = 1;		ranges[3][1] = n_ports;
+	words = req_mask_words(n_ports);
+	target = malloc(sizeof(long) * cycles * n_ports);
+	dice = malloc(sizeof(double) * cycles * n_ports);
+	sel_table = malloc(sizeof(long) * cycles * n_ports);
+	sel_mask = malloc(sizeof(long) * cycles * n_ports);
+
+	srand(seed);
+	for (i = 0; i < cycles * n_ports; i++) {
+		target[i] = (rand() < load * RAND_MAX) ? (rand() % n_ports) : NULL_PORT;
+		dice[i] = rand() / (RAND_MAX + 1.0);
+	}
+
+	printf("# radix %ld, vcs %ld, ports %ld, load %.2f, cycles %ld\n", radix, vcs, n_ports, load, cycles);
+	printf("# arbiter  range       table_ns/cycle  mask_ns/cycle  speedup  identical\n");
+	for (r = 0; r < 4; r++) {
+		range_first = ranges[r][0] < n_ports ? ranges[r][0] : 0;
+		range_last = ranges[r][1] < n_ports ? ranges[r][1] : n_ports;
+		if (range_first >= range_last)
+			continue;
+		for (random = 0; random < 2; random++) {
+			tt = run_table(random);
+			tm = run_mask(random);
+			if (memcmp(sel_table, sel_mask, sizeof(long) * cycles * n_ports))
+				failed = 1;
+			printf("%-8s  [%3ld,%3ld)  %14.1f  %13.1f  %7.2f  %s\n", random ? "random" : "rr",
+					range_first, range_last, 1e9 * tt / cycles, 1e9 * tm / cycles, tt / tm,
+					memcmp(sel_table, sel_mask, sizeof(long) * cycles * n_ports) ? "NO" : "yes");
+		}
+	}
+
+	free(target);
+	free(dice);
+	free(sel_table);
+	free(sel_mask);
+	return failed;
+}
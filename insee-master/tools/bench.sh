@@ -0,0 +1,154 @@
+#!/bin/bash
+# Benchmark suite of the simulator (make bench).
+#
+# Builds an optimised copy of the simulator (out of the source tree) with an allocation counter
+# (tools/alloc_count.c), and runs a fixed set of cases: batch runs on a torus and a dragonfly at
+# low and high load, and a trace-driven run of a generated trace.
+#
+# For every case it records the best wall time of BENCH_REPEAT runs, the simulated cycles and the
+# cycles per second, the peak RSS and the number of allocations, in a tab-separated file
+# (BENCH_OUT, bench.tsv by default), and compares them with the baseline (tools/bench.baseline).
+# Cases whose time, memory or allocations grow more than BENCH_TOLERANCE (0.15 by default) are
+# regressions, and make the script fail. Wall times are only checked against a baseline recorded
+# on the same kind of machine. A change in the cycles means the simulation itself changed.
+#
+# Usage: tools/bench.sh [--save] [case ...]
+#	--save	record the results as the new baseline (make bench-baseline)
+#	case	run only these cases, e.g. tools/bench.sh batch.torus.low trace.torus.ring
+
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+BASELINE="$SRC_DIR/tools/bench.baseline"
+OUT="${BENCH_OUT:-$PWD/bench.tsv}"
+REPEAT="${BENCH_REPEAT:-3}"
+TOLERANCE="${BENCH_TOLERANCE:-0.15}"
+SEED=13
+BATCH="warm_up_period=1000 nsamples=5 max_conv_time=5000"
+
+SAVE=0
+if [ "$1" = "--save" ]; then
+	SAVE=1
+	shift
+fi
+
+# Name and arguments of every case
+CASES=(
+	"batch.torus.low" "topo=torus_16_16 load=0.1 $BATCH"
+	"batch.torus.high" "topo=torus_16_16 load=0.9 $BATCH"
+	"batch.dragonfly.low" "topo=dragonfly_3_6_3 load=0.1 $BATCH"
+	"batch.dragonfly.high" "topo=dragonfly_3_6_3 load=0.9 $BATCH"
+	"trace.torus.ring" "topo=torus_8_8 tpattern=trace_64_1 tracefile=ring.trc"
+)
+
+WORK_DIR="$(mktemp -d /tmp/bench.XXXXXX)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+cp "$SRC_DIR"/*.c "$SRC_DIR"/*.h "$SRC_DIR/Makefile" "$WORK_DIR/"
+cd "$WORK_DIR" || exit 1
+rm -f *.o insee
+if ! { make -j"$(nproc)" CFLAGS="-O2" insee &&
+       gcc -O2 -c "$SRC_DIR/tools/alloc_count.c" -o alloc_count.o &&
+       gcc -o insee $(ls *.o) -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc -lm; } > build.log 2>&1; then
+	cat build.log
+	echo "Build failed"
+	exit 1
+fi
+
+# Trace of 64 tasks exchanging with their ring and opposite neighbours, in fsin trc format
+awk -v n=64 -v iters=20 'BEGIN {
+	for (i = 0; i < iters; i++) {
+		for (t = 0; t < n; t++)
+			print "c", t, 100
+		for (t = 0; t < n; t++) {
+			print "s", t, (t + 1) % n, i, 4096
+			print "s", t, (t + n / 2) % n, i, 4096
+		}
+		for (t = 0; t < n; t++) {
+			print "r", (t + n - 1) % n, t, i, 4096
+			print "r", (t + n / 2) % n, t, i, 4096
+		}
+	}
+}' > ring.trc
+
+machine="$(uname -sm) $(awk -F': ' '/^model name/ { print $2; exit }' /proc/cpuinfo 2>/dev/null)"
+
+run_case() {
+	# Runs the case $1 (arguments $2) and prints its row
+	local name="$1" best="" start end cycles
+
+	for ((r = 0; r < REPEAT; r++)); do
+		rm -f stats fsin.*
+		start=$(date +%s%N)
+		BENCH_STATS=stats ./insee $2 rseed=$SEED > run.log 2>&1
+		end=$(date +%s%N)
+		[ -s stats ] && grep -q "^Execution completed" run.log || return 1
+		[ -z "$best" ] || [ $((end - start)) -lt "$best" ] && best=$((end - start))
+	done
+	cycles=$(awk '/^Simulation clock/ { print $4 }' run.log)
+	awk -v name="$name" -v ns="$best" -v cycles="$cycles" \
+		-v rss="$(awk '$1 == "rss.kb" { print $2 }' stats)" \
+		-v allocs="$(awk '$1 == "allocs" { print $2 }' stats)" \
+		'BEGIN { printf "%s\t%.3f\t%s\tcycles\t%.1f\t%s\t%s\n", name, ns / 1e9, cycles, cycles / (ns / 1e9), rss, allocs }'
+}
+
+{
+	echo "#machine	$machine"
+	printf "#case\twall.s\twork\twork.unit\twork.per.s\trss.kb\tallocs\n"
+} > "$OUT"
+failed=0
+for ((c = 0; c < ${#CASES[@]}; c += 2)); do
+	name="${CASES[c]}"
+	if [ $# -gt 0 ] && [[ " $* " != *" $name "* ]]; then
+		continue
+	fi
+	if ! run_case "$name" "${CASES[c+1]}" >> "$OUT"; then
+		echo "$name failed, see the output below"
+		tail -20 run.log
+		failed=1
+	fi
+done
+
+if [ $SAVE -eq 1 ]; then
+	cp "$OUT" "$BASELINE"
+	echo "Baseline written to $BASELINE"
+	cat "$BASELINE"
+	exit $failed
+fi
+
+if [ ! -f "$BASELINE" ]; then
+	cat "$OUT"
+	echo "No baseline to compare with, record one with: make bench-baseline"
+	exit $failed
+fi
+
+# Compare with the baseline, case by case
+awk -F'\t' -v tol="$TOLERANCE" -v machine="$machine" '
+	FNR == NR && $1 == "#machine" { same = ($2 == machine); next }
+	FNR == NR && $1 !~ /^#/ { wall[$1] = $2; work[$1] = $3; rss[$1] = $6; allocs[$1] = $7; next }
+	$1 ~ /^#/ { next }
+	{
+		status = "ok"
+		if (!($1 in wall))
+			status = "new"
+		else {
+			if (same && $2 > wall[$1] * (1 + tol)) status = "SLOWER"
+			if ($6 > rss[$1] * (1 + tol)) status = "MORE-MEMORY"
+			if ($7 > allocs[$1] * (1 + tol)) status = "MORE-ALLOCS"
+			if ($3 != work[$1]) status = status " (cycles changed)"
+			if (status ~ /^[A-Z]/) regressions++
+		}
+		if (n++ == 0)
+			printf "%-24s %10s %10s %8s %12s %8s %12s %8s  %s\n", "case", "wall.s", "base.s", "ratio",
+				"cycles.per.s", "rss.kb", "allocs", "ratio", "status"
+		printf "%-24s %10.3f %10.3f %8.2f %12.1f %8d %12d %8.2f  %s\n", $1, $2, wall[$1],
+			($1 in wall) ? $2 / wall[$1] : 0, $5, $6, $7, ($1 in wall) ? $7 / allocs[$1] : 0, status
+	}
+	END {
+		if (!same)
+			print "The baseline was recorded on another machine, wall times are not checked."
+		if (regressions) {
+			printf "%d regression(s) over the baseline (tolerance %.0f%%)\n", regressions, 100 * tol
+			exit 1
+		}
+	}' "$BASELINE" "$OUT" || failed=1
+echo "Results written to $OUT"
+exit $failed
@@ -35,10 +35,6 @@ void generate_rrg(graph_t *rg, long n, long k, long seed);
 
 void generate_df(graph_t *rg, long n, long k);
 
-long is_full_connected(graph_t *rg, long n);
-
-long is_difference(graph_t *rg, long node_ref, long node_ref2, long node, long n);
-
 long are_connected(graph_t *rg, long n1, long n2);
 
 void connect_nodes(graph_t *rg, long n1, long n2);
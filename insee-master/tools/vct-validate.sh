@@ -0,0 +1,85 @@
+#!/bin/bash
+# Validation of the event-driven engine against the cycle engine (make validate-vct).
+#
+# Builds an optimised copy of the simulator (out of the source tree) and runs a fixed set of
+# batch cases with engine=cycle and engine=event: the dragonfly of fsin.conf, a fat tree and a
+# thin tree with the settings of fsin.conf, and a torus with the default settings, at low and
+# moderate loads. The average accepted load and packet delay of every case must agree within
+# VCT_TOLERANCE (0.05 by default); cases where they do not make the script fail. It also prints
+# the wall time of both engines and the speedup of the event engine.
+#
+# Usage: tools/vct-validate.sh [case ...]
+#	case	run only these cases, e.g. tools/vct-validate.sh conf.dragonfly.low
+
+SRC_DIR="$(cd "$(dirname "$0")/.." && pwd)"
+TOLERANCE="${VCT_TOLERANCE:-0.05}"
+SEED=13
+BATCH="warm_up_period=1000 nsamples=5 max_conv_time=5000"
+
+# Name, configuration (conf: fsin.conf, default: no configuration file) and arguments of every case
+CASES=(
+	"conf.dragonfly.low" conf "load=0.05 $BATCH"
+	"conf.dragonfly.mid" conf "load=0.2 $BATCH"
+	"conf.fattree.mid" conf "topo=fattree_4_3 load=0.2 $BATCH"
+	"conf.thintree.mid" conf "topo=thintree_4_2_3 load=0.2 $BATCH"
+	"default.torus.low" default "topo=torus_16_16 load=0.05 $BATCH"
+	"default.torus.mid" default "topo=torus_16_16 load=0.2 $BATCH"
+)
+
+WORK_DIR="$(mktemp -d /tmp/vct.XXXXXX)"
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+cp "$SRC_DIR"/*.c "$SRC_DIR"/*.h "$SRC_DIR/Makefile" "$WORK_DIR/"
+cd "$WORK_DIR" || exit 1
+rm -f *.o insee
+if ! make -j"$(nproc)" CFLAGS="-O2" insee > build.log 2>&1; then
+	cat build.log
+	echo "Build failed"
+	exit 1
+fi
+mkdir conf default
+cp "$SRC_DIR/fsin.conf" conf/
+
+run_engine() {
+	# Runs the case (directory $1, arguments $2) with the engine $3, and prints its
+	# wall time in ns, average accepted load and average delay
+	local start end
+
+	start=$(date +%s%N)
+	(cd "$1" && ../insee $2 engine=$3 rseed=$SEED > run.$3.log 2>&1)
+	end=$(date +%s%N)
+	grep -q "^Execution completed" "$1/run.$3.log" || return 1
+	awk -F', *' -v ns=$((end - start)) '$1 == "AVG" { print ns, $4, $9 }' "$1/run.$3.log"
+}
+
+printf "%-22s %10s %10s %8s %10s %10s %10s %10s  %s\n" "case" "cycle.s" "event.s" "speedup" \
+	"cycle.acc" "event.acc" "cycle.dly" "event.dly" "status"
+failed=0
+for ((c = 0; c < ${#CASES[@]}; c += 3)); do
+	name="${CASES[c]}"
+	if [ $# -gt 0 ] && [[ " $* " != *" $name "* ]]; then
+		continue
+	fi
+	if ! cycle=$(run_engine "${CASES[c+1]}" "${CASES[c+2]}" cycle) ||
+	   ! event=$(run_engine "${CASES[c+1]}" "${CASES[c+2]}" event); then
+		echo "$name failed, see the output below"
+		tail -n 20 "${CASES[c+1]}"/run.*.log
+		failed=1
+		continue
+	fi
+	awk -v name="$name" -v tol="$TOLERANCE" -v cycle="$cycle" -v event="$event" 'BEGIN {
+		split(cycle, c, " ")
+		split(event, e, " ")
+		status = "ok"
+		if (e[2] < c[2] * (1 - tol) || e[2] > c[2] * (1 + tol) ||
+		    e[3] < c[3] * (1 - tol) || e[3] > c[3] * (1 + tol))
+			status = "MISMATCH"
+		printf "%-22s %10.3f %10.3f %8.1f %10.5f %10.5f %10.2f %10.2f  %s\n", name, c[1] / 1e9,
+			e[1] / 1e9, c[1] / e[1], c[2], e[2], c[3], e[3], status
+		exit status != "ok"
+	}' || failed=1
+done
+if [ $failed -ne 0 ]; then
+	echo "The event engine does not match the cycle engine (tolerance $TOLERANCE)"
+fi
+exit $failed
@@ -0,0 +1,697 @@
+/**
+* @file
+* @brief	Event-driven virtual cut-through engine.
+*
+* With engine=event, data_movement() is replaced by data_movement_vct(), which moves whole packets
+* instead of phits and only visits the routers that may have something to do in a cycle. It reuses
+* the topologies, the routing records, the requests & the arbitration policies of the cycle engine.
+*
+* Three kinds of events drive it:
+* - the generation of a packet by a source, whose time is drawn from the geometric distribution of
+*   the cycles between two injections, so the sources cost nothing in the cycles they do not inject;
+* - the tail of a packet leaving through a link, which frees the output port and, at the upstream
+*   router, returns the credits of the whole packet;
+* - the tail of a packet being consumed.
+*
+* When the header of a packet is granted an output port, the whole packet is stored in the input
+* queue of the neighbor (see ins_packet_queue()), where it can be routed in the next cycle, so the
+* header advances one hop per cycle and the tail #pkt_len-1 cycles later, as in the cycle engine.
+* A router is visited in a cycle when a packet arrives to it, when an event of the previous cycle
+* frees some of its resources, or when some of its packets lost an arbitration. A router whose
+* packets have no room to request an output port is parked until one of its ports is freed or a
+* neighbor returns the credits of a packet (see wake()).
+*
+* The buffer room of a packet is taken when its header arrives and freed when its tail leaves,
+* while the cycle engine frees it phit by phit. Otherwise, both engines follow the same rules, so
+* their results are statistically equivalent (see tools/vct-validate.sh), but not the same run.
+*
+* @see data_movement_direct
+* @see data_movement_indirect
+
+FSIN Functional Simulator of Interconnection Networks
+Copyright (2003-2011) J. Miguel-Alonso, A. Gonzalez, J. Navaridas
+
+This program is free software; you can redistribute it and/or
+modify it under the terms of the GNU General Public License
+as published by the Free Software Foundation; either version 2
+of the License, or (at your option) any later version.
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+You should have received a copy of the GNU General Public License
+along with this program; if not, write to the Free Software
+Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+*/
+
+#include <math.h>
+
+#include "globals.h"
+
+/**
+* Types of events. Within a cycle, generations are processed before the routers are visited, and
+* tails after them.
+*
+* Tails always happen #pkt_len-1 cycles after the header moves, so they are stored in order in a
+* FIFO. Only the generations, drawn at random, need a heap.
+*/
+typedef enum vct_event_type_t {
+	VCT_GEN,		///< A source generates a packet.
+	VCT_LINK_TAIL,	///< The tail of a packet leaves through an output port.
+	VCT_CONS_TAIL	///< The tail of a packet is consumed.
+} vct_event_type_t;
+
+/**
+* An event of the event-driven engine.
+*/
+typedef struct vct_event_t {
+	CLOCK_TYPE time;		///< The cycle of the event.
+	vct_event_type_t type;	///< The type of the event.
+	long node;				///< The node of the event.
+	port_type port;			///< Output port of a link tail, input port of a consumption tail, or 1 if a generation is a retry.
+	long stamp;				///< The generation stamp of the source, to discard outdated generations.
+} vct_event_t;
+
+engine_t engine;	///< The simulation engine.
+
+static vct_event_t *heap;	///< Pending generations, a binary heap ordered by time.
+static long heap_len;		///< Number of pending generations.
+static long heap_size;		///< Capacity of the heap.
+
+static vct_event_t *tails;	///< Pending tails, in order of time.
+static long tails_head;		///< Position of the first pending tail.
+static long tails_len;		///< Number of pending tails.
+static long tails_size;		///< Capacity of the FIFO: one per input port.
+
+static long *now;			///< Routers to visit in the current cycle.
+static long n_now;			///< Number of routers to visit in the current cycle.
+static long *next;			///< Routers to visit in the next cycle.
+static long n_next;			///< Number of routers to visit in the next cycle.
+static CLOCK_TYPE *dirty_at;	///< Cycle in which each router is to be visited.
+
+static uint64_t *active;	///< For every router, the mask of its input ports holding packets.
+static bool_t *parked;		///< For every router, whether it has packets waiting for room to request an output port.
+static bool_t *lost;		///< For every router visited, whether some of its requests lost the arbitration.
+static long *upstream;		///< For every input port, the router sending through it, or NULL_PORT.
+static bool_t *started;		///< For every input port, whether the packet at its head is moving.
+static bool_t *busy;		///< For every link, whether a packet is moving through it.
+
+static long *gen_stamp;		///< Generation stamp of every source.
+static bool_t gen_set;		///< Whether the generations have been scheduled.
+static double gen_aload;	///< #aload when the generations were scheduled.
+static double gen_log;		///< Logarithm of the probability of not injecting in a cycle.
+static double gen_p;		///< Probability of injecting in a cycle.
+
+/**
+* Schedules a generation.
+*
+* @param time The cycle of the generation.
+* @param node The source.
+* @param retry 1 if the generation retries the injection of a saved packet, 0 otherwise.
+*/
+static void push_gen(CLOCK_TYPE time, long node, port_type retry) {
+	vct_event_t ev;
+	long c, f;
+
+	if (heap_len == heap_size) {
+		heap_size *= 2;
+		if ((heap = realloc(heap, sizeof(vct_event_t)*heap_size)) == NULL)
+			panic("push_gen: Unable to allocate memory");
+	}
+	ev.time = time;
+	ev.type = VCT_GEN;
+	ev.node = node;
+	ev.port = retry;
+	ev.stamp = gen_stamp[node];
+	for (c = heap_len++; c > 0; c = f) {
+		f = (c-1)/2;
+		if (heap[f].time <= time)
+			break;
+		heap[c] = heap[f];
+	}
+	heap[c] = ev;
+}
+
+/**
+* Removes the first generation of the heap.
+*
+* @return The removed generation.
+*/
+static vct_event_t pop_gen(void) {
+	vct_event_t ev, last;
+	long c, s;
+
+	ev = heap[0];
+	last = heap[--heap_len];
+	for (c = 0; (s = 2*c+1) < heap_len; c = s) {
+		if (s+1 < heap_len && heap[s+1].time < heap[s].time)
+			s++;
+		if (last.time <= heap[s].time)
+			break;
+		heap[c] = heap[s];
+	}
+	heap[c] = last;
+	return ev;
+}
+
+/**
+* Schedules the tail of a packet, #pkt_len-1 cycles after its header moves.
+*
+* @param type The type of the tail.
+* @param node The node.
+* @param port The output port of a link tail, the input port of a consumption tail.
+*/
+static void push_tail(vct_event_type_t type, long node, port_type port) {
+	vct_event_t *ev;
+
+	if (tails_len == tails_size)
+		panic("push_tail: More packets moving than input ports");
+	ev = &tails[(tails_head+tails_len)%tails_size];
+	tails_len++;
+	ev->time = sim_clock+pkt_len-1;
+	ev->type = type;
+	ev->node = node;
+	ev->port = port;
+}
+
+/**
+* Marks a router to be visited in the current or in the next cycle.
+*
+* @param i The router.
+* @param t The cycle, the current one or the next one.
+*/
+static void mark(long i, CLOCK_TYPE t) {
+	if (dirty_at[i] == t)
+		return;
+	dirty_at[i] = t;
+	if (t == sim_clock)
+		now[n_now++] = i;
+	else
+		next[n_next++] = i;
+}
+
+/**
+* Visits a parked router in the next cycle: some resource its packets were waiting for may be free.
+*
+* @param i The router, or NULL_PORT.
+*/
+static void wake(long i) {
+	if (i == NULL_PORT || !parked[i])
+		return;
+	parked[i] = B_FALSE;
+	mark(i, sim_clock+1);
+}
+
+/**
+* The mask of the input ports of a router holding packets.
+*/
+#define active_ports(i) (active + ((i)*req_words))
+
+/**
+* Draws the number of cycles until the next injection of a source.
+*
+* @return The cycles, at least 1.
+*/
+static CLOCK_TYPE gen_gap(void) {
+	double u;
+
+	if (gen_p >= 1.0)
+		return 1;
+	u = (rand()+1.0)/(RAND_MAX+2.0);
+	return 1 + (CLOCK_TYPE)floor(log(u)/gen_log);
+}
+
+/**
+* Schedules the generations of all the sources at the current load.
+*
+* Called at the start and whenever #aload changes. Sources waiting to inject a saved packet retry
+* in this cycle.
+*/
+static void gen_schedule(void) {
+	long i;
+
+	gen_set = B_TRUE;
+	gen_aload = aload;
+	gen_p = (aload < 0) ? 0.0 : (floor(aload)+1.0)/(RAND_MAX+1.0);
+	gen_log = (gen_p < 1.0) ? log(1.0-gen_p) : 0.0;
+	for (i=0; i<nprocs; i++) {
+		gen_stamp[i]++;
+		if (network[i].source != INDEPENDENT_SOURCE)
+			continue;
+		if (!drop_packets && network[i].pending_packet > 0)
+			push_gen(sim_clock, i, 1);
+		else if (gen_p > 0.0)
+			push_gen(sim_clock-1+gen_gap(), i, 0);
+	}
+}
+
+/**
+* A source generates a packet, or retries the injection of a saved one.
+*
+* @param ev The generation event.
+* @param inject If FALSE, no new packets are generated.
+*/
+static void gen_event(vct_event_t *ev, bool_t inject) {
+	long i = ev->node;
+	double aux = 0.0;
+
+	if (ev->stamp != gen_stamp[i])
+		return;	// Outdated by a change of the load
+	if (ev->port) {
+		if (drop_packets || network[i].pending_packet == 0)
+			return;	// Already injected by an earlier retry
+		generate_pkt_now(i, aux);
+	}
+	else if (inject && global_q_u <= congestion_limit) {
+#if (BIMODAL_SUPPORT != 0)
+		aux = floor((floor(aload)+1.0)*rand()/(RAND_MAX+1.0));
+#endif /* BIMODAL */
+		generate_pkt_now(i, aux);
+	}
+	mark(i, sim_clock);
+	// A saved packet waits for room in the injection buffer
+	if (drop_packets || network[i].pending_packet == 0)
+		push_gen(sim_clock+gen_gap(), i, 0);
+}
+
+/**
+* Moves whole packets from the injection buffers to the injection ports of a node.
+*
+* @param i The node.
+*/
+static void inject_packets(long i) {
+	phit ph, body;
+	inj_queue *ib;
+	queue *iq;
+	port_type e;
+	long k;
+	bool_t moved = B_FALSE;
+
+	for (e=0; e<ninj; e++) {
+		ib = &(network[i].qi[e]);
+		iq = &(network[i].p[e+p_inj_first].q);
+		while (inj_queue_len(ib) >= pkt_len && queue_space(iq) >= pkt_len) {
+			inj_rem_queue(ib, &ph);
+			for (k=1; k<pkt_len; k++)
+				inj_rem_queue(ib, &body);
+			ins_packet_queue(iq, &ph, pkt_len);
+			req_mask_set(active_ports(i), e+p_inj_first);
+			moved = B_TRUE;
+		}
+	}
+	if (moved && !drop_packets && network[i].pending_packet > 0)
+		push_gen(sim_clock+1, i, 1);
+}
+
+/**
+* Whether any input port has requested an output port.
+*
+* @param i The router.
+* @param d_p The output port.
+* @return TRUE if there are requests to arbitrate.
+*/
+static bool_t requested(long i, port_type d_p) {
+	long w;
+
+	for (w=0; w<req_words; w++)
+		if (network[i].p[d_p].req_mask[w])
+			return B_TRUE;
+	return B_FALSE;
+}
+
+/**
+* Whether any input port but the one granted an output port has requested it, after the arbitration.
+*
+* @param i The router.
+* @param d_p The output port.
+* @return TRUE if some request lost the arbitration.
+*/
+static bool_t lost_requests(long i, port_type d_p) {
+	port_type s_p = network[i].p[d_p].sip;
+	uint64_t bits;
+	long w;
+
+	for (w=0; w<req_words; w++) {
+		bits = network[i].p[d_p].req_mask[w];
+		if (s_p != P_NULL && s_p/REQ_WORD_BITS == w)
+			bits &= ~(UINT64_C(1) << (s_p%REQ_WORD_BITS));
+		if (bits)
+			return B_TRUE;
+	}
+	return B_FALSE;
+}
+
+/**
+* Visits a router: injection, requests and arbitration, as in data_movement_direct() and
+* data_movement_indirect().
+*
+* Only the input ports holding packets request, in the same order. Ports already granted an
+* output port are skipped: their header stays at the head of the queue until the tail leaves, so
+* the checks of request_port() would find it.
+*
+* @param i The router.
+* @return TRUE if some request lost the arbitration. Adaptive requests may then try another
+* output port in the next cycle.
+*/
+static bool_t visit(long i) {
+	uint64_t *m = active_ports(i);
+	port_type s_p, d_p;
+	bool_t lost = B_FALSE;
+
+	if (i < nprocs)
+		inject_packets(i);
+	clear_requests(i);
+	for (s_p=req_mask_next(m, 0, p_con); s_p!=-1; s_p=req_mask_next(m, s_p+1, p_con))
+		if (network[i].p[s_p].aop == P_NULL && queue_len(&(network[i].p[s_p].q)))
+			request_port(i, s_p);
+	arbitrate_cons(i);
+	for (d_p=0; d_p<p_con; d_p++) {
+		if (!requested(i, d_p))
+			continue;
+		arbitrate(i, d_p);
+		if (!lost)
+			lost = lost_requests(i, d_p);
+	}
+	return lost;
+}
+
+/**
+* Starts the consumption of the packet at the head of an input port.
+*
+* @param i The node.
+* @param s_p The input port.
+*/
+static void start_consumption(long i, port_type s_p) {
+	phit ph;
+
+	started[(i*n_ports)+s_p] = B_TRUE;
+	ph = *head_queue(&(network[i].p[s_p].q));
+	if (pkt_len > 1)
+		phit_away(i, s_p, ph);
+#if (PCOUNT!=0)
+	network[i].pcount -= pkt_len;
+#endif
+	push_tail(VCT_CONS_TAIL, i, s_p);
+}
+
+/**
+* Starts the movement of a packet through a link.
+*
+* The whole packet is stored in the input port of the neighbor, which can route it in the next cycle.
+*
+* @param n The node.
+* @param p The physical port (link).
+* @param l The virtual channel.
+* @param s_p The input port holding the packet.
+*/
+static void start_link(long n, long p, channel l, port_type s_p) {
+	long n_n = network[n].nbor[p];
+	port_type d_p = port_address(p, l), d_np = port_address(network[n].nborp[p], l);
+	phit ph;
+
+	if (network[n].p[s_p].aop != d_p) {
+		char message[100];
+		sprintf(message, "Bad assignment - start link ::: node %ld, port %ld, d_p %ld, s_p %ld", n, p, d_p, s_p);
+		panic(message);
+	}
+	ph = *head_queue(&(network[n].p[s_p].q));
+	network[n].op_i[p] = l;
+	header_moved(n, n_n, s_p, d_np, ph);
+	ins_packet_queue(&(network[n_n].p[d_np].q), &ph, pkt_len);
+	req_mask_set(active_ports(n_n), d_np);
+	if (plevel & 16)
+		printf("T: %"PRINT_CLOCK" - N: %4ld Packet(id %5ld) header departs towards %4ld\n", sim_clock, n, ph.packet, n_n);
+	network[n].p[d_p].utilization += pkt_len;
+	if (n == monitored)
+		port_utilization[d_p] += pkt_len;
+#if (PCOUNT!=0)
+	network[n].pcount -= pkt_len;
+	network[n_n].pcount += pkt_len;
+#endif
+	started[(n*n_ports)+s_p] = B_TRUE;
+	busy[(n*n_ports)+p] = B_TRUE;
+	mark(n_n, sim_clock+1);
+	push_tail(VCT_LINK_TAIL, n, d_p);
+}
+
+/**
+* Starts the packets granted a port at a router: consumptions first, then links, as in consume() and advance().
+*
+* @param i The router.
+*/
+static void start_packets(long i) {
+	uint64_t *m = active_ports(i);
+	long p, links, visited;
+	port_type s_p;
+	channel l;
+
+	if (cons_mode == SINGLE_CONS) {
+		s_p = network[i].p[p_con].sip;
+		if (s_p != P_NULL && !started[(i*n_ports)+s_p])
+			start_consumption(i, s_p);
+	} else {
+		for (s_p=req_mask_next(m, 0, p_inj_first); s_p!=-1; s_p=req_mask_next(m, s_p+1, p_inj_first))
+			if (network[i].p[s_p].aop == p_con && !started[(i*n_ports)+s_p])
+				start_consumption(i, s_p);
+	}
+
+	if (topo < DIRECT || i >= nprocs)
+		links = radix;
+	else
+		links = nnics;
+	for (p=0; p<links; p++) {
+		if (network[i].nbor[p] == NULL_PORT || busy[(i*n_ports)+p])
+			continue;
+		l = network[i].op_i[p];
+		for (visited=0; visited<nchan; visited++) {
+			s_p = network[i].p[port_address(p, l)].sip;
+			if (s_p != P_NULL) {
+				start_link(i, p, l, s_p);
+				break;
+			}
+			l = (l+1)%nchan;
+		}
+	}
+}
+
+/**
+* The tail of a packet has left an input port, freeing its room.
+*
+* The credits of the packet return to the upstream router, and the router has freed an output
+* port, so both are woken if they were parked. Otherwise, the router is visited in the next cycle
+* only if it has something new to do: a packet behind at the same port, packets waiting in the
+* injection buffer, or packets granted the link just freed.
+*
+* @param i The router.
+* @param s_p The input port.
+* @param p The link freed, or NULL_PORT for a consumption.
+*/
+static void port_freed(long i, port_type s_p, long p) {
+	channel l;
+
+	started[(i*n_ports)+s_p] = B_FALSE;
+	wake(upstream[(i*n_ports)+s_p]);
+	wake(i);
+	if (!queue_len(&(network[i].p[s_p].q)))
+		req_mask_clear(active_ports(i), s_p);
+	if (queue_len(&(network[i].p[s_p].q)) ||
+			(s_p >= p_inj_first && inj_queue_len(&(network[i].qi[s_p-p_inj_first])))) {
+		mark(i, sim_clock+1);
+		return;
+	}
+	if (p != NULL_PORT)
+		for (l=0; l<nchan; l++)
+			if (network[i].p[port_address(p, l)].sip != P_NULL) {
+				mark(i, sim_clock+1);
+				return;
+			}
+}
+
+/**
+* The tail of a packet leaves through an output port, which is freed.
+*
+* @param ev The tail event.
+*/
+static void link_tail(vct_event_t *ev) {
+	long n = ev->node;
+	port_type d_p = ev->port, s_p = network[n].p[d_p].sip;
+	phit ph;
+
+	rem_packet_queue(&(network[n].p[s_p].q), &ph, pkt_len);
+	network[n].op_i[d_p/nchan] = ((d_p%nchan)+1)%nchan;	// Next time assign to another virtual channel
+	network[n].p[s_p].aop = P_NULL;		// Free reservations
+	network[n].p[s_p].tor = CLOCK_MAX;
+	network[n].p[d_p].sip = P_NULL;
+	busy[(n*n_ports)+(d_p/nchan)] = B_FALSE;
+	if (plevel & 16)
+		printf("T: %"PRINT_CLOCK" - N: %4ld Packet(id %5ld) leaves node\n", sim_clock, n, ph.packet);
+	port_freed(n, s_p, d_p/nchan);
+}
+
+/**
+* The tail of a packet is consumed.
+*
+* @param ev The tail event.
+*/
+static void consumption_tail(vct_event_t *ev) {
+	long i = ev->node;
+	port_type s_p = ev->port;
+	phit ph;
+
+	rem_packet_queue(&(network[i].p[s_p].q), &ph, pkt_len);
+	if (pkt_len > 1) {
+		rcvd_phit_count += pkt_len-2;	// The body
+		ph.pclass = TAIL;
+	}
+	phit_away(i, s_p, ph);
+	port_freed(i, s_p, NULL_PORT);
+}
+
+/**
+* Whether a router has packets waiting for an output port.
+*
+* If none of them lost an arbitration, they could not request for lack of room, and can only
+* request when the router frees an output port or a neighbor frees room for them. The router is
+* then parked until that happens, instead of requesting again every cycle.
+*
+* @param i The router.
+* @return TRUE if some input port has a packet without an output port.
+*/
+static bool_t waiting(long i) {
+	uint64_t *m = active_ports(i);
+	port_type s_p;
+
+	for (s_p=req_mask_next(m, 0, p_con); s_p!=-1; s_p=req_mask_next(m, s_p+1, p_con)) {
+		if (!queue_len(&(network[i].p[s_p].q)))
+			req_mask_clear(m, s_p);	// Extracted by the requests
+		else if (network[i].p[s_p].aop == P_NULL)
+			return B_TRUE;
+	}
+	return B_FALSE;
+}
+
+/**
+* Initializes the event-driven engine.
+*/
+void vct_init(void) {
+	long i, p;
+	channel l;
+
+	heap_size = nprocs + 16;
+	heap_len = 0;
+	heap = alloc(sizeof(vct_event_t)*heap_size);
+	tails_size = NUMNODES*n_ports;
+	tails_head = tails_len = 0;
+	tails = alloc(sizeof(vct_event_t)*tails_size);
+	now = alloc(sizeof(long)*NUMNODES);
+	next = alloc(sizeof(long)*NUMNODES);
+	n_now = n_next = 0;
+	dirty_at = alloc(sizeof(CLOCK_TYPE)*NUMNODES);
+	for (i=0; i<NUMNODES; i++)
+		dirty_at[i] = (CLOCK_TYPE) -1L;
+	active = alloc(sizeof(uint64_t)*NUMNODES*req_words);
+	for (i=0; i<NUMNODES*req_words; i++)
+		active[i] = 0;
+	parked = alloc(sizeof(bool_t)*NUMNODES);
+	lost = alloc(sizeof(bool_t)*NUMNODES);
+	for (i=0; i<NUMNODES; i++)
+		parked[i] = lost[i] = B_FALSE;
+	started = alloc(sizeof(bool_t)*NUMNODES*n_ports);
+	busy = alloc(sizeof(bool_t)*NUMNODES*n_ports);
+	upstream = alloc(sizeof(long)*NUMNODES*n_ports);
+	for (i=0; i<NUMNODES*n_ports; i++) {
+		started[i] = busy[i] = B_FALSE;
+		upstream[i] = NULL_PORT;
+	}
+	// The input ports of a link, at the node the link leads to, as in start_link()
+	for (i=0; i<NUMNODES; i++)
+		for (p=0; p<((topo < DIRECT || i >= nprocs) ? radix : nnics); p++)
+			if (network[i].nbor[p] != NULL_PORT)
+				for (l=0; l<nchan; l++)
+					upstream[(network[i].nbor[p]*n_ports)+port_address(network[i].nborp[p], l)] = i;
+	gen_stamp = alloc(sizeof(long)*nprocs);
+	for (i=0; i<nprocs; i++)
+		gen_stamp[i] = 0;
+	gen_set = B_FALSE;
+}
+
+/**
+* Frees the structures of the event-driven engine.
+*/
+void vct_finish(void) {
+	free(heap);
+	free(tails);
+	free(now);
+	free(next);
+	free(dirty_at);
+	free(active);
+	free(parked);
+	free(lost);
+	free(started);
+	free(busy);
+	free(upstream);
+	free(gen_stamp);
+}
+
+/**
+* Performs the movement of the data in a cycle, with the event-driven engine.
+*
+* @param inject If TRUE new data generation is performed.
+*
+* @see init_functions
+* @see data_movement
+*/
+void data_movement_vct(bool_t inject) {
+	vct_event_t ev;
+	long *aux, i, k;
+
+	if (plevel & 8)
+		for (i=0; i<NUMNODES; i++)
+			stats(i);
+	if (!gen_set || aload != gen_aload)
+		gen_schedule();
+
+	// The routers marked in the previous cycle are visited in this one
+	aux = now; now = next; next = aux;
+	n_now = n_next;
+	n_next = 0;
+	for (k=0; k<n_now; k++)
+		dirty_at[now[k]] = sim_clock;
+
+	PROF_START(PROF_INJECTION);
+	while (heap_len && heap[0].time <= sim_clock) {
+		ev = pop_gen();
+		gen_event(&ev, inject);
+	}
+	PROF_END(PROF_INJECTION);
+
+	PROF_START(PROF_ARBITRATE);
+	for (k=0; k<n_now; k++)
+		lost[now[k]] = visit(now[k]);
+	PROF_END(PROF_ARBITRATE);
+
+	PROF_START(PROF_ADVANCE);
+	for (k=0; k<n_now; k++)
+		start_packets(now[k]);
+	// Parked before the tails, so the ports they free wake them
+	for (k=0; k<n_now; k++) {
+		i = now[k];
+		parked[i] = B_FALSE;
+		if (!waiting(i))
+			continue;
+		if (lost[i])
+			mark(i, sim_clock+1);	// Request again, as the cycle engine does
+		else
+			parked[i] = B_TRUE;
+	}
+	while (tails_len && tails[tails_head].time <= sim_clock) {
+		ev = tails[tails_head];
+		tails_head = (tails_head+1)%tails_size;
+		tails_len--;
+		if (ev.type == VCT_LINK_TAIL)
+			link_tail(&ev);
+		else
+			consumption_tail(&ev);
+	}
+	PROF_END(PROF_ADVANCE);
+}